@@ -0,0 +1,176 @@
+#include "audio.h"
+#include <stdio.h>
+
+// Sound files in SFX_* order
+const char* SFX_FILES[SFX_COUNT] = {
+    "resources/eat.wav",
+    "resources/die.wav",
+    "resources/pop.wav",
+    "resources/select.wav",
+    "resources/selected.wav",
+    "resources/bonusTime.wav",
+};
+
+// Runs on the audio thread after SDL_mixer mixed the music: start queued effects and mix every active voice
+void mixSfx(void* data, Uint8* stream, int length) {
+    AudioSystem* audio = (AudioSystem*)data;
+    Uint64 now = perfNow();
+    // The buffer being filled is heard after the one the device is playing
+    double bufferMs = AUDIO_BUFFER_SAMPLES * 1000.0 / audio->frequency;
+
+    int read = SDL_AtomicGet(&audio->read);
+    int written = SDL_AtomicGet(&audio->written);
+    SDL_MemoryBarrierAcquire();
+    while (read != written) {
+        SfxEvent* event = &audio->events[read & (SFX_QUEUE_SIZE - 1)];
+
+        // Free voice, or steal the one that has played the longest
+        int voice = 0;
+        for (int i = 0; i < SFX_VOICES; ++i) {
+            if (audio->voices[i].sound < 0) {
+                voice = i;
+                break;
+            }
+            if (audio->voices[i].position > audio->voices[voice].position) {
+                voice = i;
+            }
+        }
+        audio->voices[voice].sound = event->sound;
+        audio->voices[voice].position = 0;
+        recordLatency(&audio->latency, perfMs(event->time, now) + bufferMs);
+        read++;
+    }
+    SDL_MemoryBarrierRelease();
+    SDL_AtomicSet(&audio->read, read);
+
+    for (int i = 0; i < SFX_VOICES; ++i) {
+        SfxVoice* voice = &audio->voices[i];
+        if (voice->sound < 0) {
+            continue;
+        }
+        Mix_Chunk* chunk = audio->chunks[voice->sound];
+        Uint32 remaining = chunk->alen - voice->position;
+        Uint32 bytes = remaining < (Uint32)length ? remaining : (Uint32)length;
+        SDL_MixAudioFormat(stream, chunk->abuf + voice->position, audio->format, bytes, chunk->volume);
+        voice->position += bytes;
+        if (voice->position >= chunk->alen) {
+            voice->sound = -1;
+        }
+    }
+}
+
+// Loader thread: open the audio device with a small buffer and load the effects
+int loadAudio(void* data) {
+    AudioSystem* audio = (AudioSystem*)data;
+    Uint64 start = perfNow();
+
+    if (SDL_InitSubSystem(SDL_INIT_AUDIO) < 0) {
+        printf("Function:loadAudio, SDL audio init failed,Error: %s\n", SDL_GetError());
+        SDL_AtomicSet(&audio->loaded, 1);
+        return 1;
+    }
+    if (Mix_OpenAudio(44100, MIX_DEFAULT_FORMAT, 2, AUDIO_BUFFER_SAMPLES) < 0) {
+        printf("SDL_mixer initialization failed! Error: %s\n", Mix_GetError());
+        SDL_QuitSubSystem(SDL_INIT_AUDIO);
+        SDL_AtomicSet(&audio->loaded, 1);
+        return 1;
+    }
+    Mix_QuerySpec(&audio->frequency, &audio->format, &audio->channels);
+
+    // Mix_LoadWAV converts to the device format, the callback can mix the bytes as they are
+    for (int i = 0; i < SFX_COUNT; ++i) {
+        audio->chunks[i] = Mix_LoadWAV(SFX_FILES[i]);
+        if (audio->chunks[i] == NULL) {
+            printf("Function:loadAudio, Failed to load %s! Error: %s\n", SFX_FILES[i], Mix_GetError());
+            for (int j = 0; j < i; ++j) {
+                Mix_FreeChunk(audio->chunks[j]);
+                audio->chunks[j] = NULL;
+            }
+            Mix_CloseAudio();
+            SDL_QuitSubSystem(SDL_INIT_AUDIO);
+            SDL_AtomicSet(&audio->loaded, 1);
+            return 1;
+        }
+    }
+
+    // Effects don't use SDL_mixer's channels
+    Mix_AllocateChannels(0);
+    Mix_SetPostMix(mixSfx, audio);
+    audio->open = 1;
+    audio->loadMs = perfMs(start, perfNow());
+    SDL_MemoryBarrierRelease();
+    SDL_AtomicSet(&audio->loaded, 1);
+    return 0;
+}
+
+// Start loading audio in the background, returns 0 on success. The game runs without sound if loading fails
+int initAudio(AudioSystem* audio) {
+    audio->open = 0;
+    audio->loadMs = 0;
+    SDL_AtomicSet(&audio->loaded, 0);
+    SDL_AtomicSet(&audio->written, 0);
+    SDL_AtomicSet(&audio->read, 0);
+    resetLatency(&audio->latency);
+    for (int i = 0; i < SFX_VOICES; ++i) {
+        audio->voices[i].sound = -1;
+        audio->voices[i].position = 0;
+    }
+    for (int i = 0; i < SFX_COUNT; ++i) {
+        audio->chunks[i] = NULL;
+    }
+
+    audio->loader = SDL_CreateThread(loadAudio, "audio loader", audio);
+    if (audio->loader == NULL) {
+        printf("Function:initAudio, loader thread creation failed,Error: %s\n", SDL_GetError());
+        SDL_AtomicSet(&audio->loaded, 1);
+        return 1;
+    }
+    return 0;
+}
+
+// 1 once the loader is done, check open afterwards to know if there is sound
+int audioLoaded(AudioSystem* audio) {
+    if (!SDL_AtomicGet(&audio->loaded)) {
+        return 0;
+    }
+    SDL_MemoryBarrierAcquire();
+    return 1;
+}
+
+// Queue an effect, called from the game loop. Dropped if the queue is full (the callback is stalled)
+void playSfx(AudioSystem* audio, int sound) {
+    if (!audioLoaded(audio) || !audio->open) {
+        return;
+    }
+    int written = SDL_AtomicGet(&audio->written);
+    if (written - SDL_AtomicGet(&audio->read) == SFX_QUEUE_SIZE) {
+        return;
+    }
+    SfxEvent* event = &audio->events[written & (SFX_QUEUE_SIZE - 1)];
+    event->sound = sound;
+    event->time = perfNow();
+    SDL_MemoryBarrierRelease();
+    SDL_AtomicSet(&audio->written, written + 1);
+}
+
+void closeAudio(AudioSystem* audio) {
+    if (audio->loader != NULL) {
+        SDL_WaitThread(audio->loader, NULL);
+        audio->loader = NULL;
+    }
+    if (audio->open) {
+        printf("Audio loaded in %.3f ms, off the startup path\n", audio->loadMs);
+        Mix_SetPostMix(NULL, NULL);
+    }
+    for (int i = 0; i < SFX_COUNT; ++i) {
+        if (audio->chunks[i] != NULL) {
+            Mix_FreeChunk(audio->chunks[i]);
+            audio->chunks[i] = NULL;
+        }
+    }
+    if (audio->open) {
+        Mix_CloseAudio();
+        SDL_QuitSubSystem(SDL_INIT_AUDIO);
+        audio->open = 0;
+    }
+}
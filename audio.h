@@ -0,0 +1,70 @@
+// Sound effects: the WAVs are preloaded in the device format and mixed by our own voice pool on top of
+// SDL_mixer's output. The game only pushes events into a lock-free queue, the audio callback starts the voices,
+// so a sound starts in the next audio buffer (512 samples, about 12 ms) after the action.
+// Opening the device and converting the WAVs happens on a loader thread, the menu doesn't wait for it;
+// effects played before it is done are dropped
+
+#ifndef AUDIO_H
+#define AUDIO_H
+
+#include <SDL2/SDL.h>
+#include <SDL2/SDL_mixer.h>
+#include "perf.h"
+
+enum {
+    SFX_EAT,
+    SFX_DIE,
+    SFX_POP,
+    SFX_SELECT,
+    SFX_SELECTED,
+    SFX_BONUS_TIME,
+    SFX_COUNT
+};
+
+// Device buffer in sample frames, small so effects aren't late
+const int AUDIO_BUFFER_SAMPLES = 512;
+
+// Power of two
+const int SFX_QUEUE_SIZE = 64;
+const int SFX_VOICES = 8;
+
+typedef struct {
+    int sound;
+    Uint64 time;  // Performance counter when the event was pushed
+} SfxEvent;
+
+typedef struct {
+    int sound;        // -1 when the voice is free
+    Uint32 position;  // Bytes of the chunk already mixed
+} SfxVoice;
+
+typedef struct {
+    int open;  // Audio is optional, without a device every call does nothing
+    // Decoded PCM in the device format (Mix_QuerySpec), converted once when loaded
+    int frequency;
+    Uint16 format;
+    int channels;
+    Mix_Chunk* chunks[SFX_COUNT];
+
+    // Single producer (game loop) / single consumer (audio callback) ring
+    SfxEvent events[SFX_QUEUE_SIZE];
+    SDL_atomic_t written;
+    SDL_atomic_t read;
+
+    // Only touched by the audio callback
+    SfxVoice voices[SFX_VOICES];
+    LatencyStats latency;  // Event -> audible, written by the audio callback, read after closeAudio
+
+    // Loader thread, open and the spec are only read after loaded is set
+    SDL_Thread* loader;
+    SDL_atomic_t loaded;
+    double loadMs;
+} AudioSystem;
+
+// Audio functions
+int initAudio(AudioSystem* audio);
+int audioLoaded(AudioSystem* audio);
+void playSfx(AudioSystem* audio, int sound);
+void closeAudio(AudioSystem* audio);
+
+#endif
@@ -0,0 +1,276 @@
+#include "autopilot.h"
+#include <string.h>
+
+int insideBoard(int col, int row) {
+    return col >= BOARD_FIRST_COL && col <= BOARD_LAST_COL && row >= BOARD_FIRST_ROW && row <= BOARD_LAST_ROW;
+}
+
+int segmentCell(Snake* snake, int i) {
+    return (snake->segments[i].y / CELL_SIZE) * GRID_COLS + snake->segments[i].x / CELL_SIZE;
+}
+
+// Cells the head eats the food from, same overlap test as checkCollision
+int eatsFood(Food* food, int col, int row) {
+    int x = col * CELL_SIZE;
+    int y = row * CELL_SIZE;
+    return x < food->x + food->rect.w && x + SEGMENT_WIDTH > food->x &&
+           y < food->y + food->rect.h && y + SEGMENT_HEIGHT > food->y;
+}
+
+// A body cell the head can't enter next tick, the tail moves away unless the snake is growing
+int blockedNextTick(Snake* snake, int col, int row) {
+    int idx = snakeSegmentAt(snake, col, row);
+    if (idx < 0) {
+        return 0;
+    }
+    if (idx == snake->length - 1) {
+        SDL_Rect* tail = &snake->segments[snake->length - 1];
+        SDL_Rect* beforeTail = &snake->segments[snake->length - 2];
+        return tail->x == beforeTail->x && tail->y == beforeTail->y;
+    }
+    return 1;
+}
+
+void initAutopilot(Autopilot* bot) {
+    memset(bot->pathOn, 0, sizeof(bot->pathOn));
+    memset(bot->seen, 0, sizeof(bot->seen));
+    memset(bot->body, 0, sizeof(bot->body));
+    bot->pathMark = 0;
+    bot->seenMark = 0;
+    bot->bodyMark = 0;
+    bot->decisions = 0;
+    bot->rebuilds = 0;
+    bot->tailFollows = 0;
+    resetAutopilot(bot);
+}
+
+// Forget the field, call when a new game starts
+void resetAutopilot(Autopilot* bot) {
+    bot->fieldValid = 0;
+    bot->pathSafe = 0;
+    bot->pathLength = 0;
+    bot->pathNext = 0;
+    bot->tailCell = -1;
+}
+
+// Breadth first search from the head of a simulated body (cells marked with bodyMark) to its tail.
+// Returns the distance to the tail or -1, area gets the number of cells the head can reach
+int searchTail(Autopilot* bot, int head, int tail, int* area) {
+    bot->seenMark++;
+    int read = 0;
+    int written = 0;
+    int tailDistance = -1;
+    bot->queue[written++] = head;
+    bot->seen[head] = bot->seenMark;
+    bot->steps[head] = 0;
+    while (read < written) {
+        int cell = bot->queue[read++];
+        if (cell == tail) {
+            tailDistance = bot->steps[cell];
+            continue;
+        }
+        int col = cell % GRID_COLS;
+        int row = cell / GRID_COLS;
+        for (int i = 0; i < 4; ++i) {
+            int nextCol = col + STEP_COLS[i];
+            int nextRow = row + STEP_ROWS[i];
+            int next = nextRow * GRID_COLS + nextCol;
+            if (!insideBoard(nextCol, nextRow) || bot->seen[next] == bot->seenMark ||
+                (bot->body[next] == bot->bodyMark && next != tail)) {
+                continue;
+            }
+            bot->seen[next] = bot->seenMark;
+            bot->steps[next] = bot->steps[cell] + 1;
+            bot->queue[written++] = next;
+        }
+    }
+    *area = written;
+    return tailDistance;
+}
+
+// Would the snake still reach its tail after eating along the path? The body is simulated as it will be
+// when the head reaches the food, one segment longer
+int pathIsSafe(Autopilot* bot, Snake* snake) {
+    int length = snake->length + 1;
+    int count = 0;
+    int tail = -1;
+    bot->bodyMark++;
+    for (int i = bot->pathLength - 1; i >= 0 && count < length; --i, ++count) {
+        tail = bot->pathCells[i];
+        bot->body[tail] = bot->bodyMark;
+    }
+    for (int i = 0; i < snake->length && count < length; ++i, ++count) {
+        tail = segmentCell(snake, i);
+        bot->body[tail] = bot->bodyMark;
+    }
+    // A duplicated tail segment must not hide the tail cell
+    bot->body[tail] = 0;
+
+    int area;
+    int head = bot->pathCells[bot->pathLength - 1];
+    return searchTail(bot, head, tail, &area) > 0;
+}
+
+// Rebuild the distance field from the food and the path from the head down it
+void rebuildField(Autopilot* bot, Snake* snake, Food* food) {
+    bot->rebuilds++;
+    bot->foodX = food->x;
+    bot->foodY = food->y;
+    bot->fieldValid = 1;
+    bot->pathSafe = 0;
+    bot->pathLength = 0;
+    bot->pathNext = 0;
+    bot->pathMark++;
+    for (int i = 0; i < GRID_CELLS; ++i) {
+        bot->distance[i] = -1;
+    }
+
+    // Every free cell the head eats the food from is a source
+    int read = 0;
+    int written = 0;
+    int firstCol = (food->x - SEGMENT_WIDTH) / CELL_SIZE;
+    int firstRow = (food->y - SEGMENT_HEIGHT) / CELL_SIZE;
+    for (int row = firstRow; row <= (food->y + food->rect.h) / CELL_SIZE; ++row) {
+        for (int col = firstCol; col <= (food->x + food->rect.w) / CELL_SIZE; ++col) {
+            if (insideBoard(col, row) && eatsFood(food, col, row) && snakeSegmentAt(snake, col, row) < 0) {
+                bot->distance[row * GRID_COLS + col] = 0;
+                bot->queue[written++] = row * GRID_COLS + col;
+            }
+        }
+    }
+    while (read < written) {
+        int cell = bot->queue[read++];
+        int col = cell % GRID_COLS;
+        int row = cell / GRID_COLS;
+        for (int i = 0; i < 4; ++i) {
+            int nextCol = col + STEP_COLS[i];
+            int nextRow = row + STEP_ROWS[i];
+            int next = nextRow * GRID_COLS + nextCol;
+            if (!insideBoard(nextCol, nextRow) || bot->distance[next] >= 0 || snakeSegmentAt(snake, nextCol, nextRow) >= 0) {
+                continue;
+            }
+            bot->distance[next] = bot->distance[cell] + 1;
+            bot->queue[written++] = next;
+        }
+    }
+
+    // Walk downhill from the head, the head's own cell is body so start from its best neighbour.
+    // Path cells were free when the field was built and only the head enters cells, so the path stays valid
+    int col = snake->segments[0].x / CELL_SIZE;
+    int row = snake->segments[0].y / CELL_SIZE;
+    while (1) {
+        int best = -1;
+        for (int i = 0; i < 4; ++i) {
+            int nextCol = col + STEP_COLS[i];
+            int nextRow = row + STEP_ROWS[i];
+            if (!insideBoard(nextCol, nextRow)) {
+                continue;
+            }
+            int next = nextRow * GRID_COLS + nextCol;
+            if (bot->distance[next] >= 0 && (best < 0 || bot->distance[next] < bot->distance[best])) {
+                best = next;
+            }
+        }
+        if (best < 0 || (bot->pathLength > 0 && bot->distance[best] >= bot->distance[bot->pathCells[bot->pathLength - 1]])) {
+            break;
+        }
+        bot->pathCells[bot->pathLength++] = best;
+        bot->pathOn[best] = bot->pathMark;
+        col = best % GRID_COLS;
+        row = best / GRID_COLS;
+        if (bot->distance[best] == 0) {
+            break;
+        }
+    }
+    if (bot->pathLength == 0 || bot->distance[bot->pathCells[bot->pathLength - 1]] != 0) {
+        bot->pathLength = 0;
+        return;
+    }
+    bot->pathSafe = pathIsSafe(bot, snake);
+}
+
+// No safe path to the food: take the move that keeps the tail reachable and stays away from it longest,
+// or failing that the move with the most room
+int followTail(Autopilot* bot, Snake* snake, Food* food) {
+    int headCol = snake->segments[0].x / CELL_SIZE;
+    int headRow = snake->segments[0].y / CELL_SIZE;
+    int best = -1;
+    int bestScore = -1;
+    for (int i = 0; i < 4; ++i) {
+        int col = headCol + STEP_COLS[i];
+        int row = headRow + STEP_ROWS[i];
+        if (STEP_COLS[i] * CELL_SIZE == -snake->dx && STEP_ROWS[i] * CELL_SIZE == -snake->dy) {
+            continue;
+        }
+        if (!insideBoard(col, row) || blockedNextTick(snake, col, row)) {
+            continue;
+        }
+
+        // Body after this move: the new head, then every segment but the last unless the move eats
+        int length = snake->length + eatsFood(food, col, row);
+        int cell = row * GRID_COLS + col;
+        bot->bodyMark++;
+        bot->body[cell] = bot->bodyMark;
+        int tail = cell;
+        for (int s = 0; s < length - 1; ++s) {
+            tail = segmentCell(snake, s);
+            bot->body[tail] = bot->bodyMark;
+        }
+        bot->body[tail] = 0;
+
+        int area;
+        int tailDistance = searchTail(bot, cell, tail, &area);
+        int score = tailDistance >= 0 ? GRID_CELLS + tailDistance : area;
+        if (score > bestScore) {
+            bestScore = score;
+            best = i;
+        }
+    }
+    return best;
+}
+
+// Pick this tick's move and queue it, returns 0 when every move is fatal
+int autopilotTurn(Autopilot* bot, Snake* snake, Food* food, InputQueue* input) {
+    bot->decisions++;
+
+    // The cell the tail just left only matters if it opens a shortcut next to the path
+    int tail = segmentCell(snake, snake->length - 1);
+    if (bot->fieldValid && bot->tailCell >= 0 && tail != bot->tailCell) {
+        int col = bot->tailCell % GRID_COLS;
+        int row = bot->tailCell / GRID_COLS;
+        for (int i = 0; i < 4; ++i) {
+            int next = (row + STEP_ROWS[i]) * GRID_COLS + col + STEP_COLS[i];
+            if (insideBoard(col + STEP_COLS[i], row + STEP_ROWS[i]) && bot->pathOn[next] == bot->pathMark) {
+                bot->fieldValid = 0;
+                break;
+            }
+        }
+    }
+    bot->tailCell = tail;
+
+    if (!bot->fieldValid || !bot->pathSafe || bot->pathNext == bot->pathLength || food->x != bot->foodX || food->y != bot->foodY) {
+        rebuildField(bot, snake, food);
+    }
+
+    int headCol = snake->segments[0].x / CELL_SIZE;
+    int headRow = snake->segments[0].y / CELL_SIZE;
+    int move = -1;
+    if (bot->pathSafe && bot->pathNext < bot->pathLength) {
+        int next = bot->pathCells[bot->pathNext++];
+        for (int i = 0; i < 4; ++i) {
+            if ((headRow + STEP_ROWS[i]) * GRID_COLS + headCol + STEP_COLS[i] == next) {
+                move = i;
+            }
+        }
+    }
+    if (move < 0) {
+        bot->tailFollows++;
+        bot->fieldValid = 0;
+        move = followTail(bot, snake, food);
+        if (move < 0) {
+            return 0;
+        }
+    }
+    queueTurn(input, STEP_COLS[move] * CELL_SIZE, STEP_ROWS[move] * CELL_SIZE, 0);
+    return 1;
+}
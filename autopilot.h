@@ -0,0 +1,55 @@
+// Autopilot: a pathfinding bot that plays the game on the cell grid.
+// It keeps a distance field from the food (breadth first search, the body counts as walls) and follows it
+// downhill. The field is only rebuilt when the food moved, the cell the tail left opens a shortcut next to
+// the path, or the bot had to leave the path. Before committing to a path it checks that the snake would
+// still reach its own tail after eating, otherwise it follows its tail until the food is safe to take
+
+#ifndef AUTOPILOT_H
+#define AUTOPILOT_H
+
+#include "snake.h"
+#include "input.h"
+
+typedef struct {
+    // Distance field from the food, -1 for walls and cells that can't reach it
+    int distance[GRID_CELLS];
+    int foodX, foodY;      // Food the field was built for
+    int fieldValid;        // 0 forces a rebuild on the next tick
+    int pathSafe;          // The tail is still reachable after eating along the field
+
+    // Cells of the path from the head to the food, marked with pathMark
+    int pathCells[GRID_CELLS];
+    int pathLength;
+    int pathNext;          // Index of the next step
+    int pathOn[GRID_CELLS];
+    int pathMark;
+    int tailCell;          // Tail cell on the previous tick
+
+    // Scratch space for the searches
+    int queue[GRID_CELLS];
+    int steps[GRID_CELLS];
+    int seen[GRID_CELLS];
+    int seenMark;
+    int body[GRID_CELLS];  // Simulated body for the safety check, marked with bodyMark
+    int bodyMark;
+
+    // Counters for benchmarks
+    int decisions;
+    int rebuilds;
+    int tailFollows;
+} Autopilot;
+
+// Grid helpers, shared with the other bots. Neighbour offsets in cells: right, left, down, up
+const int STEP_COLS[4] = {1, -1, 0, 0};
+const int STEP_ROWS[4] = {0, 0, 1, -1};
+int insideBoard(int col, int row);
+int segmentCell(Snake* snake, int i);
+int eatsFood(Food* food, int col, int row);
+int blockedNextTick(Snake* snake, int col, int row);
+
+// Autopilot functions
+void initAutopilot(Autopilot* bot);
+void resetAutopilot(Autopilot* bot);
+int autopilotTurn(Autopilot* bot, Snake* snake, Food* food, InputQueue* input);
+
+#endif
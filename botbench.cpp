@@ -0,0 +1,173 @@
+// Bot benchmark: plays headless games with a bot, no window, as fast as the simulation runs
+// Usage: botbench [--bot cycle|path|mcts] [--games N] [--max-ticks N] [--seed N] [--threads N] [--budget-ms N]
+// Prints CSV on stdout: bot,board,games,deaths,filled,ticks_per_food,fill_ticks,fill_ms,ns_per_tick,bot_ns_per_tick
+//   a game ends when the snake dies, fills every cell the bot can use, or runs max-ticks ticks
+//   fill_ticks and fill_ms are means over the games that filled the board
+//   the board size is fixed at build time like microbench (-DSNAKE_SCREEN_WIDTH=...)
+//   mcts searches for budget-ms per tick on threads threads (default one per core) and also prints
+//   simulations and simulated moves per second, the numbers to compare across thread counts
+
+#include <SDL2/SDL.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "perf.h"
+#include "snake.h"
+#include "input.h"
+#include "autopilot.h"
+#include "hamilton.h"
+#include "mcts.h"
+
+const int BOT_PATH = 0;
+const int BOT_CYCLE = 1;
+const int BOT_MCTS = 2;
+
+typedef struct {
+    Snake snake;
+    Food food;
+    InputQueue input;
+    Autopilot path;
+    HamiltonBot cycle;
+    Mcts mcts;
+} BotGame;
+
+typedef struct {
+    int games;
+    int deaths;
+    int filled;
+    long long ticks;
+    long long foods;
+    long long fillTicks;
+    double fillMs;
+    double ms;
+    double botMs;  // Inside the bot's turn function
+} BotResults;
+
+// One game with the same order of steps as the game loop in main.cpp
+void playBotGame(BotGame* game, int bot, int maxTicks, int fullLength, BotResults* results) {
+    Snake* snake = &game->snake;
+    initSnake(snake);
+    resetInputQueue(&game->input, snake);
+    game->food.rect.w = 15;
+    game->food.rect.h = 15;
+    game->food.random = 0;
+    generateFood(&game->food);
+    if (bot == BOT_CYCLE) {
+        resetHamiltonBot(&game->cycle, snake);
+    } else if (bot == BOT_PATH) {
+        resetAutopilot(&game->path);
+    }
+
+    Uint64 start = perfNow();
+    Uint64 botCounter = 0;
+    int died = 0;
+    while (snake->tick < maxTicks && snake->length < fullLength) {
+        if (checkCollision(snake, &game->food)) {
+            growSnake(snake, 2);
+            snake->score += 1;
+            generateFood(&game->food);
+        }
+        Uint64 botStart = perfNow();
+        if (bot == BOT_CYCLE) {
+            hamiltonTurn(&game->cycle, snake, &game->food, &game->input);
+        } else if (bot == BOT_MCTS) {
+            mctsTurn(&game->mcts, snake, &game->food, &game->input);
+        } else {
+            autopilotTurn(&game->path, snake, &game->food, &game->input);
+        }
+        botCounter += perfNow() - botStart;
+        Uint64 turnTime;
+        applyNextTurn(&game->input, snake, &turnTime);
+        updateSnake(snake, &game->food);
+        if (isGameOver(snake)) {
+            died = 1;
+            break;
+        }
+    }
+    double ms = perfMs(start, perfNow());
+
+    results->games++;
+    results->ticks += snake->tick;
+    results->foods += snake->score;
+    results->ms += ms;
+    results->botMs += perfMs(0, botCounter);
+    if (died) {
+        results->deaths++;
+    } else if (snake->length >= fullLength) {
+        results->filled++;
+        results->fillTicks += snake->tick;
+        results->fillMs += ms;
+    }
+}
+
+int main(int argc, char* args[]) {
+    int bot = BOT_CYCLE;
+    int games = 10;
+    int maxTicks = 10000000;
+    unsigned int seed = 1;
+    int threads = 0;
+    double budgetMs = 5;
+    for (int i = 1; i < argc; ++i) {
+        if (strcmp(args[i], "--bot") == 0 && i + 1 < argc) {
+            ++i;
+            bot = strcmp(args[i], "path") == 0 ? BOT_PATH : strcmp(args[i], "mcts") == 0 ? BOT_MCTS : BOT_CYCLE;
+        } else if (strcmp(args[i], "--games") == 0 && i + 1 < argc) {
+            games = atoi(args[++i]);
+        } else if (strcmp(args[i], "--max-ticks") == 0 && i + 1 < argc) {
+            maxTicks = atoi(args[++i]);
+        } else if (strcmp(args[i], "--seed") == 0 && i + 1 < argc) {
+            seed = (unsigned int)atoi(args[++i]);
+        } else if (strcmp(args[i], "--threads") == 0 && i + 1 < argc) {
+            threads = atoi(args[++i]);
+        } else if (strcmp(args[i], "--budget-ms") == 0 && i + 1 < argc) {
+            budgetMs = atof(args[++i]);
+        } else {
+            printf("Usage: botbench [--bot cycle|path|mcts] [--games N] [--max-ticks N] [--seed N] [--threads N] [--budget-ms N]\n");
+            return 1;
+        }
+    }
+
+    BotGame* game = (BotGame*)malloc(sizeof(BotGame));
+    if (game == NULL) {
+        printf("Function:main, allocation failed\n");
+        return 1;
+    }
+    initAutopilot(&game->path);
+    initHamiltonBot(&game->cycle);
+    if (bot == BOT_MCTS && startMcts(&game->mcts, threads, budgetMs) != 0) {
+        free(game);
+        return 1;
+    }
+
+    // The cycle bot can fill every cycle cell, the other one is measured against the whole board
+    const HamiltonCycle* cycle = boardCycle();
+    int fullLength = cycle->length;
+    if (fullLength > SNAKE_MAX_LENGTH) {
+        fullLength = SNAKE_MAX_LENGTH;
+    }
+
+    srand(seed);
+    BotResults results;
+    memset(&results, 0, sizeof(results));
+    for (int i = 0; i < games; ++i) {
+        playBotGame(game, bot, maxTicks, fullLength, &results);
+    }
+
+    printf("bot,board,games,deaths,filled,ticks_per_food,fill_ticks,fill_ms,ns_per_tick,bot_ns_per_tick\n");
+    printf("%s,%dx%d,%d,%d,%d,%.1f,%.0f,%.1f,%.1f,%.1f\n", bot == BOT_CYCLE ? "cycle" : bot == BOT_MCTS ? "mcts" : "path", BOARD_COLS, BOARD_ROWS,
+           results.games, results.deaths, results.filled,
+           results.foods > 0 ? (double)results.ticks / results.foods : 0.0,
+           results.filled > 0 ? (double)results.fillTicks / results.filled : 0.0,
+           results.filled > 0 ? results.fillMs / results.filled : 0.0,
+           results.ticks > 0 ? results.ms * 1000000.0 / results.ticks : 0.0,
+           results.ticks > 0 ? results.botMs * 1000000.0 / results.ticks : 0.0);
+    if (bot == BOT_MCTS) {
+        double seconds = game->mcts.searchMs / 1000.0;
+        printf("MCTS: %d threads, %.1f ms per tick, %.0f simulations/s, %.0f simulated moves/s, %.0f simulations per tick\n",
+               game->mcts.threads, budgetMs, game->mcts.simulations / seconds, game->mcts.steps / seconds,
+               (double)game->mcts.simulations / game->mcts.decisions);
+        stopMcts(&game->mcts);
+    }
+    free(game);
+    return 0;
+}
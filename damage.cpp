@@ -0,0 +1,67 @@
+#include "damage.h"
+#include <stdio.h>
+
+void damageReset(DamageTracker* damage) {
+    damage->count = 0;
+    damage->full = 0;
+}
+
+// Add a changed rect, overlapping rects are merged so every pixel is uploaded once
+void damageAdd(DamageTracker* damage, SDL_Rect rect) {
+    if (damage->full || rect.w <= 0 || rect.h <= 0) {
+        return;
+    }
+
+    // Merging can make the rect overlap ones that were checked before, so start over after each merge
+    int merged = 1;
+    while (merged) {
+        merged = 0;
+        for (int i = 0; i < damage->count; ++i) {
+            if (SDL_HasIntersection(&damage->rects[i], &rect)) {
+                SDL_UnionRect(&damage->rects[i], &rect, &rect);
+                damage->rects[i] = damage->rects[--damage->count];
+                merged = 1;
+                break;
+            }
+        }
+    }
+
+    if (damage->count == DAMAGE_MAX_RECTS) {
+        damageAddFull(damage);
+        return;
+    }
+    damage->rects[damage->count++] = rect;
+}
+
+void damageAddFull(DamageTracker* damage) {
+    damage->full = 1;
+    damage->count = 0;
+}
+
+// Damage the old and new area of something that moved, appeared or disappeared (w = 0 means hidden)
+void damageTrackRect(DamageTracker* damage, SDL_Rect* last, SDL_Rect now) {
+    if (last->x == now.x && last->y == now.y && last->w == now.w && last->h == now.h) {
+        return;
+    }
+    damageAdd(damage, *last);
+    damageAdd(damage, now);
+    *last = now;
+}
+
+// Present the frame, the software path uploads only the damaged rects of the window surface
+void presentFrame(SDL_Window* window, SDL_Renderer* renderer, DamageTracker* damage, int softwarePresent) {
+    if (!softwarePresent) {
+        SDL_RenderPresent(renderer);
+        return;
+    }
+
+    int result = 0;
+    if (damage->full) {
+        result = SDL_UpdateWindowSurface(window);
+    } else if (damage->count > 0) {
+        result = SDL_UpdateWindowSurfaceRects(window, damage->rects, damage->count);
+    }
+    if (result != 0) {
+        printf("Function:presentFrame, window surface update failed, Error: %s\n", SDL_GetError());
+    }
+}
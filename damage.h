@@ -0,0 +1,24 @@
+// Damage tracking: the screen rects that changed this frame, so the software path only uploads those
+
+#ifndef DAMAGE_H
+#define DAMAGE_H
+
+#include <SDL2/SDL.h>
+
+// More rects than this and the whole screen is presented
+const int DAMAGE_MAX_RECTS = 32;
+
+typedef struct {
+    SDL_Rect rects[DAMAGE_MAX_RECTS];
+    int count;
+    int full;  // Whole screen changed (screen switch, menu animation)
+} DamageTracker;
+
+// Damage functions
+void damageReset(DamageTracker* damage);
+void damageAdd(DamageTracker* damage, SDL_Rect rect);
+void damageAddFull(DamageTracker* damage);
+void damageTrackRect(DamageTracker* damage, SDL_Rect* last, SDL_Rect now);
+void presentFrame(SDL_Window* window, SDL_Renderer* renderer, DamageTracker* damage, int softwarePresent);
+
+#endif
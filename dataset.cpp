@@ -0,0 +1,591 @@
+#include "dataset.h"
+#include <string.h>
+
+#ifdef _WIN32
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+const int DATASET_HEADER_BYTES = 20;
+const int DATASET_CHUNK_HEADER_BYTES = 16;
+
+void writeDatasetInt(Uint8* out, Uint32 value) {
+    out[0] = (Uint8)value;
+    out[1] = (Uint8)(value >> 8);
+    out[2] = (Uint8)(value >> 16);
+    out[3] = (Uint8)(value >> 24);
+}
+
+Uint32 readDatasetInt(const Uint8* in) {
+    return in[0] | (Uint32)in[1] << 8 | (Uint32)in[2] << 16 | (Uint32)in[3] << 24;
+}
+
+void writeDatasetHeader(Uint8* out) {
+    memcpy(out, "SNKD", 4);
+    writeDatasetInt(out + 4, 1);
+    writeDatasetInt(out + 8, OBS_ROWS);
+    writeDatasetInt(out + 12, OBS_COLS);
+    writeDatasetInt(out + 16, OBS_CHANNELS);
+}
+
+Uint32 datasetChecksum(const Uint8* data, int size) {
+    Uint32 hash = 2166136261u;
+    for (int i = 0; i < size; ++i) {
+        hash = (hash ^ data[i]) * 16777619u;
+    }
+    return hash;
+}
+
+int putVarint(Uint8* out, Uint32 value) {
+    int count = 0;
+    while (value >= 0x80) {
+        out[count++] = (Uint8)(value | 0x80);
+        value >>= 7;
+    }
+    out[count++] = (Uint8)value;
+    return count;
+}
+
+// Returns 0 past the end or on an overlong value
+int getVarint(const Uint8** in, const Uint8* end, Uint32* value) {
+    *value = 0;
+    for (int shift = 0; shift < 32; shift += 7) {
+        if (*in >= end) {
+            return 0;
+        }
+        Uint8 byte = *(*in)++;
+        *value |= (Uint32)(byte & 0x7f) << shift;
+        if (byte < 0x80) {
+            return 1;
+        }
+    }
+    return 0;
+}
+
+// observation XOR previous as zero runs and literals, a literal ends at two equal bytes in a row.
+// Writes at most 2 * OBS_BYTES_SIZE + 16 bytes
+int encodeDelta(const Uint8* observation, const Uint8* previous, Uint8* out) {
+    int size = 0;
+    int i = 0;
+    while (i < OBS_BYTES_SIZE) {
+        int start = i;
+        while (i + 8 <= OBS_BYTES_SIZE && memcmp(observation + i, previous + i, 8) == 0) {
+            i += 8;
+        }
+        while (i < OBS_BYTES_SIZE && observation[i] == previous[i]) {
+            ++i;
+        }
+        int literal = i;
+        while (i < OBS_BYTES_SIZE && (observation[i] != previous[i] || (i + 1 < OBS_BYTES_SIZE && observation[i + 1] != previous[i + 1]))) {
+            ++i;
+        }
+        size += putVarint(out + size, literal - start);
+        size += putVarint(out + size, i - literal);
+        for (int j = literal; j < i; ++j) {
+            out[size++] = observation[j] ^ previous[j];
+        }
+    }
+    return size;
+}
+
+// XOR one encoded observation into out, returns 0 on a malformed tick
+int decodeDelta(const Uint8** in, const Uint8* end, Uint8* out) {
+    Uint32 i = 0;
+    while (i < (Uint32)OBS_BYTES_SIZE) {
+        Uint32 zeros, literal;
+        if (!getVarint(in, end, &zeros) || !getVarint(in, end, &literal)) {
+            return 0;
+        }
+        if (zeros > OBS_BYTES_SIZE - i || literal > OBS_BYTES_SIZE - i - zeros || literal > (Uint32)(end - *in)) {
+            return 0;
+        }
+        i += zeros;
+        for (Uint32 j = 0; j < literal; ++j) {
+            out[i++] ^= *(*in)++;
+        }
+    }
+    return 1;
+}
+
+// Encode and append one staged chunk, on the writer thread. Returns 0 on success
+int writeChunk(DatasetRecorder* recorder, DatasetStage* stage) {
+    Snake* snake = recorder->snake;
+    Uint8* previous = recorder->observation[0];
+    Uint8* observation = recorder->observation[1];
+    memset(previous, 0, OBS_BYTES_SIZE);
+    int size = DATASET_CHUNK_HEADER_BYTES;
+    int offset = 0;
+    for (int t = 0; t < stage->ticks; ++t) {
+        DatasetTick* tick = (DatasetTick*)(stage->data + offset);
+        Uint32* cells = (Uint32*)(tick + 1);
+        offset += sizeof(DatasetTick) + tick->length * sizeof(Uint32);
+
+        snake->length = tick->length;
+        for (Uint32 i = 0; i < tick->length; ++i) {
+            snake->segments[i].x = cells[i] % GRID_COLS * CELL_SIZE;
+            snake->segments[i].y = cells[i] / GRID_COLS * CELL_SIZE;
+        }
+        Food food;
+        food.x = tick->food % GRID_COLS * CELL_SIZE;
+        food.y = tick->food / GRID_COLS * CELL_SIZE;
+        bonusFood bonus;
+        bonus.x = tick->bonus % GRID_COLS * CELL_SIZE;
+        bonus.y = tick->bonus / GRID_COLS * CELL_SIZE;
+        encodeObservation(snake, &food, &bonus, tick->bonus >= 0, observation);
+
+        // Room for the worst case tick, the buffer grows to the largest chunk written so far
+        int needed = size + 2 * OBS_BYTES_SIZE + 18;
+        if (recorder->payloadCapacity < needed) {
+            int capacity = needed > 2 * recorder->payloadCapacity ? needed : 2 * recorder->payloadCapacity;
+            Uint8* payload = (Uint8*)SDL_realloc(recorder->payload, capacity);
+            if (payload == NULL) {
+                printf("Function:writeChunk, allocation failed\n");
+                return 1;
+            }
+            recorder->payload = payload;
+            recorder->payloadCapacity = capacity;
+        }
+        Uint8* out = recorder->payload + size;
+        out[0] = tick->action;
+        out[1] = (Uint8)tick->reward;
+        size += 2 + encodeDelta(observation, previous, out + 2);
+        Uint8* swap = previous;
+        previous = observation;
+        observation = swap;
+    }
+
+    Uint8* header = recorder->payload;
+    int bytes = size - DATASET_CHUNK_HEADER_BYTES;
+    memcpy(header, "SNKC", 4);
+    writeDatasetInt(header + 4, stage->ticks);
+    writeDatasetInt(header + 8, bytes);
+    writeDatasetInt(header + 12, datasetChecksum(header + DATASET_CHUNK_HEADER_BYTES, bytes));
+    if (fwrite(recorder->payload, 1, size, recorder->file) != (size_t)size || fflush(recorder->file) != 0) {
+        printf("Function:writeChunk, Writing %d ticks failed\n", stage->ticks);
+        return 1;
+    }
+    recorder->written += stage->ticks;
+    recorder->bytes += size;
+    return 0;
+}
+
+// Writer thread: take the oldest full stage, write it without holding the lock, hand it back empty
+int recorderMain(void* data) {
+    DatasetRecorder* recorder = (DatasetRecorder*)data;
+    SDL_LockMutex(recorder->lock);
+    while (1) {
+        while (recorder->full == 0 && !recorder->quit) {
+            SDL_CondWait(recorder->changed, recorder->lock);
+        }
+        if (recorder->full == 0) {
+            break;
+        }
+        DatasetStage* stage = &recorder->stages[recorder->first];
+        SDL_UnlockMutex(recorder->lock);
+
+        if (writeChunk(recorder, stage) != 0) {
+            recorder->failed++;
+        }
+
+        SDL_LockMutex(recorder->lock);
+        stage->used = 0;
+        stage->ticks = 0;
+        recorder->first = (recorder->first + 1) % DATASET_STAGING_CHUNKS;
+        recorder->full--;
+    }
+    SDL_UnlockMutex(recorder->lock);
+    return 0;
+}
+
+// Returns 0 when recording. Appends to an existing file of the same observation size
+int startRecorder(DatasetRecorder* recorder, const char* path) {
+    memset(recorder, 0, sizeof(DatasetRecorder));
+    recorder->open = 0;
+
+    Uint8 header[DATASET_HEADER_BYTES];
+    Uint8 existing[DATASET_HEADER_BYTES];
+    writeDatasetHeader(header);
+    int fresh = 1;
+    FILE* file = fopen(path, "rb");
+    if (file != NULL) {
+        size_t read = fread(existing, 1, sizeof(existing), file);
+        fclose(file);
+        if (read > 0 && (read != sizeof(existing) || memcmp(existing, header, sizeof(header)) != 0)) {
+            printf("Function:startRecorder, %s is not a dataset of this board size\n", path);
+            return 1;
+        }
+        fresh = read == 0;
+    }
+    recorder->file = fopen(path, "ab");
+    if (recorder->file == NULL) {
+        printf("Function:startRecorder, Unable to open %s\n", path);
+        return 1;
+    }
+    if (fresh && (fwrite(header, 1, sizeof(header), recorder->file) != sizeof(header) || fflush(recorder->file) != 0)) {
+        printf("Function:startRecorder, Writing %s failed\n", path);
+        stopRecorder(recorder, NULL);
+        return 1;
+    }
+
+    int allocated = 1;
+    for (int i = 0; i < DATASET_STAGING_CHUNKS; ++i) {
+        recorder->stages[i].data = (Uint8*)SDL_malloc(DATASET_STAGING_BYTES);
+        allocated = allocated && recorder->stages[i].data != NULL;
+    }
+    recorder->snake = (Snake*)SDL_malloc(sizeof(Snake));
+    recorder->observation[0] = (Uint8*)SDL_malloc(OBS_BYTES_SIZE);
+    recorder->observation[1] = (Uint8*)SDL_malloc(OBS_BYTES_SIZE);
+    if (!allocated || recorder->snake == NULL || recorder->observation[0] == NULL || recorder->observation[1] == NULL) {
+        printf("Function:startRecorder, allocation failed\n");
+        stopRecorder(recorder, NULL);
+        return 1;
+    }
+
+    // Builds the observation base before the writer thread encodes
+    Food food;
+    food.x = BOARD_LEFT;
+    food.y = BOARD_TOP;
+    initSnake(recorder->snake);
+    encodeObservation(recorder->snake, &food, NULL, 0, recorder->observation[0]);
+
+    // Without the thread there is no recording, writing on the game thread would cost frames
+    recorder->lock = SDL_CreateMutex();
+    recorder->changed = SDL_CreateCond();
+    recorder->thread = SDL_CreateThread(recorderMain, "dataset writer", recorder);
+    if (recorder->thread == NULL) {
+        printf("Function:startRecorder, thread creation failed, Error: %s\n", SDL_GetError());
+        stopRecorder(recorder, NULL);
+        return 1;
+    }
+    return 0;
+}
+
+// Hand the open stage to the writer and open the next one if there is one free
+void submitStage(DatasetRecorder* recorder) {
+    SDL_LockMutex(recorder->lock);
+    if (recorder->open >= 0) {
+        recorder->full++;
+        SDL_CondSignal(recorder->changed);
+    }
+    recorder->open = recorder->full < DATASET_STAGING_CHUNKS ? (recorder->first + recorder->full) % DATASET_STAGING_CHUNKS : -1;
+    SDL_UnlockMutex(recorder->lock);
+}
+
+// Close the open reward with the score gained since its tick was staged. Only when the snake made exactly that
+// move since, after a new game or unrecorded ticks the score change belongs to something else
+void settleReward(DatasetRecorder* recorder, Snake* snake, int died) {
+    if (recorder->last != NULL && snake != NULL && snake->tick == recorder->lastTick + 1) {
+        int reward = snake->score - recorder->lastScore - died;
+        recorder->last->reward = (Sint8)(reward < -128 ? -128 : reward > 127 ? 127 : reward);
+    }
+    recorder->last = NULL;
+}
+
+// Stage the state and the move the snake is about to make, dropped when the writer is too far behind.
+// The previous tick's reward is settled first, while it is still in the open stage
+void recordTick(DatasetRecorder* recorder, Snake* snake, Food* food, bonusFood* bonus, int bonusActive) {
+    settleReward(recorder, snake, 0);
+    if (recorder->thread == NULL) {
+        return;
+    }
+    int size = sizeof(DatasetTick) + snake->length * sizeof(Uint32);
+    if (recorder->open >= 0) {
+        DatasetStage* stage = &recorder->stages[recorder->open];
+        if (stage->ticks == DATASET_CHUNK_TICKS || stage->used + size > DATASET_STAGING_BYTES) {
+            submitStage(recorder);
+        }
+    } else {
+        submitStage(recorder);
+    }
+    if (recorder->open < 0 || size > DATASET_STAGING_BYTES) {
+        recorder->dropped++;
+        return;
+    }
+
+    DatasetStage* stage = &recorder->stages[recorder->open];
+    DatasetTick* tick = (DatasetTick*)(stage->data + stage->used);
+    tick->length = snake->length;
+    tick->food = (food->y / CELL_SIZE) * GRID_COLS + food->x / CELL_SIZE;
+    tick->bonus = bonusActive ? (bonus->y / CELL_SIZE) * GRID_COLS + bonus->x / CELL_SIZE : -1;
+    tick->action = snake->dx > 0 ? 0 : snake->dx < 0 ? 1 : snake->dy > 0 ? 2 : 3;
+    tick->reward = 0;
+    Uint32* cells = (Uint32*)(tick + 1);
+    SDL_Rect* segments = snake->segments;
+    for (int i = 0; i < snake->length; ++i) {
+        cells[i] = (segments[i].y / CELL_SIZE) * GRID_COLS + segments[i].x / CELL_SIZE;
+    }
+    stage->used += size;
+    stage->ticks++;
+    recorder->last = tick;
+    recorder->lastScore = snake->score;
+    recorder->lastTick = snake->tick;
+    recorder->recorded++;
+}
+
+// The last move died: its reward is what it scored minus 1
+void recordGameOver(DatasetRecorder* recorder, Snake* snake) {
+    settleReward(recorder, snake, 1);
+}
+
+void recordQuit(DatasetRecorder* recorder, Snake* snake) {
+    settleReward(recorder, snake, 0);
+}
+
+// Settle the last tick against the game still being played (NULL for none), write what is staged and stop the thread
+void stopRecorder(DatasetRecorder* recorder, Snake* snake) {
+    settleReward(recorder, snake, 0);
+    if (recorder->thread != NULL) {
+        if (recorder->open >= 0 && recorder->stages[recorder->open].ticks > 0) {
+            submitStage(recorder);
+        }
+        SDL_LockMutex(recorder->lock);
+        recorder->quit = 1;
+        SDL_CondSignal(recorder->changed);
+        SDL_UnlockMutex(recorder->lock);
+        SDL_WaitThread(recorder->thread, NULL);
+        recorder->thread = NULL;
+        printf("Recorder: %lld ticks written in %lld bytes, %lld dropped, %d chunks failed\n", recorder->written,
+               recorder->bytes, recorder->dropped, recorder->failed);
+    }
+    if (recorder->file != NULL) {
+        fclose(recorder->file);
+        recorder->file = NULL;
+    }
+    SDL_DestroyCond(recorder->changed);
+    SDL_DestroyMutex(recorder->lock);
+    recorder->changed = NULL;
+    recorder->lock = NULL;
+    for (int i = 0; i < DATASET_STAGING_CHUNKS; ++i) {
+        SDL_free(recorder->stages[i].data);
+        recorder->stages[i].data = NULL;
+    }
+    SDL_free(recorder->snake);
+    SDL_free(recorder->observation[0]);
+    SDL_free(recorder->observation[1]);
+    SDL_free(recorder->payload);
+    recorder->snake = NULL;
+    recorder->observation[0] = NULL;
+    recorder->observation[1] = NULL;
+    recorder->payload = NULL;
+    recorder->payloadCapacity = 0;
+}
+
+// Map the whole file read only, the recorder may still be appending to it
+const Uint8* mapDatasetFile(const char* path, size_t* size) {
+#ifdef _WIN32
+    HANDLE file = CreateFileA(path, GENERIC_READ, FILE_SHARE_READ | FILE_SHARE_WRITE, NULL, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, NULL);
+    if (file == INVALID_HANDLE_VALUE) {
+        return NULL;
+    }
+    LARGE_INTEGER length;
+    void* view = NULL;
+    if (GetFileSizeEx(file, &length) && length.QuadPart >= DATASET_HEADER_BYTES) {
+        HANDLE mapping = CreateFileMappingA(file, NULL, PAGE_READONLY, 0, 0, NULL);
+        if (mapping != NULL) {
+            view = MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0);
+            CloseHandle(mapping);
+        }
+        *size = (size_t)length.QuadPart;
+    }
+    CloseHandle(file);
+    return (const Uint8*)view;
+#else
+    int file = open(path, O_RDONLY);
+    if (file < 0) {
+        return NULL;
+    }
+    struct stat info;
+    void* view = NULL;
+    if (fstat(file, &info) == 0 && info.st_size >= DATASET_HEADER_BYTES) {
+        view = mmap(NULL, info.st_size, PROT_READ, MAP_PRIVATE, file, 0);
+        view = view == MAP_FAILED ? NULL : view;
+        *size = info.st_size;
+    }
+    close(file);
+    return (const Uint8*)view;
+#endif
+}
+
+void unmapDatasetFile(const Uint8* data, size_t size) {
+#ifdef _WIN32
+    (void)size;
+    UnmapViewOfFile(data);
+#else
+    munmap((void*)data, size);
+#endif
+}
+
+// Good chunks into the index, a bad one is skipped by looking for the next magic after its start
+int indexDataset(DatasetReader* reader) {
+    int capacity = 0;
+    int maxTicks = 1;
+    size_t pos = DATASET_HEADER_BYTES;
+    while (pos + DATASET_CHUNK_HEADER_BYTES <= reader->size) {
+        const Uint8* header = reader->data + pos;
+        if (memcmp(header, "SNKC", 4) != 0) {
+            pos++;
+            continue;
+        }
+        Uint32 ticks = readDatasetInt(header + 4);
+        Uint32 bytes = readDatasetInt(header + 8);
+        size_t payload = pos + DATASET_CHUNK_HEADER_BYTES;
+        if (ticks == 0 || ticks > (Uint32)DATASET_CHUNK_TICKS || bytes > reader->size - payload ||
+            datasetChecksum(reader->data + payload, bytes) != readDatasetInt(header + 12)) {
+            reader->badChunks++;
+            pos++;
+            continue;
+        }
+        if (reader->chunkCount == capacity) {
+            capacity = capacity > 0 ? capacity * 2 : 256;
+            size_t* offsets = (size_t*)SDL_realloc(reader->chunkOffsets, capacity * sizeof(size_t));
+            int* chunkTicks = (int*)SDL_realloc(reader->chunkTicks, capacity * sizeof(int));
+            int* chunkBytes = (int*)SDL_realloc(reader->chunkBytes, capacity * sizeof(int));
+            reader->chunkOffsets = offsets != NULL ? offsets : reader->chunkOffsets;
+            reader->chunkTicks = chunkTicks != NULL ? chunkTicks : reader->chunkTicks;
+            reader->chunkBytes = chunkBytes != NULL ? chunkBytes : reader->chunkBytes;
+            if (offsets == NULL || chunkTicks == NULL || chunkBytes == NULL) {
+                return 0;
+            }
+        }
+        reader->chunkOffsets[reader->chunkCount] = payload;
+        reader->chunkTicks[reader->chunkCount] = ticks;
+        reader->chunkBytes[reader->chunkCount] = bytes;
+        reader->chunkCount++;
+        reader->ticks += ticks;
+        maxTicks = (int)ticks > maxTicks ? ticks : maxTicks;
+        pos = payload + bytes;
+    }
+    return maxTicks;
+}
+
+// Returns 0 on success
+int openDataset(DatasetReader* reader, const char* path, Uint32 seed) {
+    memset(reader, 0, sizeof(DatasetReader));
+    reader->random = seed != 0 ? seed : 1;
+    reader->data = mapDatasetFile(path, &reader->size);
+    if (reader->data == NULL) {
+        printf("Function:openDataset, Unable to map %s\n", path);
+        return 1;
+    }
+    Uint8 header[DATASET_HEADER_BYTES];
+    writeDatasetHeader(header);
+    if (memcmp(reader->data, header, sizeof(header)) != 0) {
+        printf("Function:openDataset, %s is not a dataset of this board size\n", path);
+        closeDataset(reader);
+        return 1;
+    }
+
+    int maxTicks = indexDataset(reader);
+    int capacity = DATASET_POOL_BYTES / OBS_BYTES_SIZE;
+    capacity = capacity < 2 * maxTicks ? 2 * maxTicks : capacity;
+    reader->poolCapacity = reader->ticks < capacity ? (int)reader->ticks : capacity;
+    reader->poolCapacity = reader->poolCapacity < maxTicks ? maxTicks : reader->poolCapacity;
+    reader->order = (int*)SDL_malloc((reader->chunkCount + 1) * sizeof(int));
+    reader->poolObservations = (Uint8*)SDL_malloc((size_t)reader->poolCapacity * OBS_BYTES_SIZE);
+    reader->poolActions = (Uint8*)SDL_malloc(reader->poolCapacity);
+    reader->poolRewards = (Sint8*)SDL_malloc(reader->poolCapacity);
+    reader->decoded = (Uint8*)SDL_malloc(OBS_BYTES_SIZE);
+    if (maxTicks == 0 || reader->order == NULL || reader->poolObservations == NULL || reader->poolActions == NULL ||
+        reader->poolRewards == NULL || reader->decoded == NULL) {
+        printf("Function:openDataset, allocation failed\n");
+        closeDataset(reader);
+        return 1;
+    }
+    for (int i = 0; i < reader->chunkCount; ++i) {
+        reader->order[i] = i;
+    }
+    shuffleDataset(reader);
+    return 0;
+}
+
+// Start an epoch: every good tick once, in a new order
+void shuffleDataset(DatasetReader* reader) {
+    for (int i = reader->chunkCount - 1; i > 0; --i) {
+        int j = nextRandom(&reader->random) % (i + 1);
+        int swap = reader->order[i];
+        reader->order[i] = reader->order[j];
+        reader->order[j] = swap;
+    }
+    reader->nextChunk = 0;
+    reader->poolCount = 0;
+}
+
+// Decode a chunk behind the pool's ticks, returns 0 if it turns out malformed
+int decodeChunk(DatasetReader* reader, int chunk) {
+    const Uint8* in = reader->data + reader->chunkOffsets[chunk];
+    const Uint8* end = in + reader->chunkBytes[chunk];
+    Uint8* decoded = reader->decoded;
+    memset(decoded, 0, OBS_BYTES_SIZE);
+    int first = reader->poolCount;
+    for (int t = 0; t < reader->chunkTicks[chunk]; ++t) {
+        if (end - in < 2) {
+            return 0;
+        }
+        reader->poolActions[first + t] = in[0];
+        reader->poolRewards[first + t] = (Sint8)in[1];
+        in += 2;
+        if (!decodeDelta(&in, end, decoded)) {
+            return 0;
+        }
+        memcpy(reader->poolObservations + (size_t)(first + t) * OBS_BYTES_SIZE, decoded, OBS_BYTES_SIZE);
+    }
+    reader->poolCount += reader->chunkTicks[chunk];
+    return 1;
+}
+
+// Up to count random ticks into the caller's buffers (count * OBS_BYTES_SIZE observation bytes, count actions and
+// rewards). Returns how many, fewer only at the end of the epoch and 0 once it is over
+int nextBatch(DatasetReader* reader, int count, Uint8* observations, Uint8* actions, Sint8* rewards) {
+    for (int k = 0; k < count; ++k) {
+        while (reader->nextChunk < reader->chunkCount &&
+               reader->poolCount + reader->chunkTicks[reader->order[reader->nextChunk]] <= reader->poolCapacity) {
+            if (!decodeChunk(reader, reader->order[reader->nextChunk])) {
+                reader->badChunks++;
+            }
+            reader->nextChunk++;
+        }
+        if (reader->poolCount == 0) {
+            return k;
+        }
+        int i = nextRandom(&reader->random) % reader->poolCount;
+        int last = --reader->poolCount;
+        Uint8* slot = reader->poolObservations + (size_t)i * OBS_BYTES_SIZE;
+        memcpy(observations + (size_t)k * OBS_BYTES_SIZE, slot, OBS_BYTES_SIZE);
+        actions[k] = reader->poolActions[i];
+        rewards[k] = reader->poolRewards[i];
+        if (i != last) {
+            memcpy(slot, reader->poolObservations + (size_t)last * OBS_BYTES_SIZE, OBS_BYTES_SIZE);
+            reader->poolActions[i] = reader->poolActions[last];
+            reader->poolRewards[i] = reader->poolRewards[last];
+        }
+    }
+    return count;
+}
+
+void closeDataset(DatasetReader* reader) {
+    if (reader->data != NULL) {
+        unmapDatasetFile(reader->data, reader->size);
+        reader->data = NULL;
+    }
+    SDL_free(reader->chunkOffsets);
+    SDL_free(reader->chunkTicks);
+    SDL_free(reader->chunkBytes);
+    SDL_free(reader->order);
+    SDL_free(reader->poolObservations);
+    SDL_free(reader->poolActions);
+    SDL_free(reader->poolRewards);
+    SDL_free(reader->decoded);
+    reader->chunkOffsets = NULL;
+    reader->chunkTicks = NULL;
+    reader->chunkBytes = NULL;
+    reader->order = NULL;
+    reader->poolObservations = NULL;
+    reader->poolActions = NULL;
+    reader->poolRewards = NULL;
+    reader->decoded = NULL;
+    reader->chunkCount = 0;
+}
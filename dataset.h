@@ -0,0 +1,116 @@
+// Gameplay dataset for imitation learning: every tick of a human game as (observation, action, reward).
+// The recorder copies the snake's cells into a staged chunk and returns, a writer thread turns them into byte
+// observations (observation.h), compresses them and appends the chunk to the file. Staging is a fixed ring of
+// DATASET_STAGING_CHUNKS buffers, when the disk falls behind and all are full ticks are dropped and counted,
+// the game thread never waits for the writer.
+// File, little endian, append only:
+//   header  "SNKD", Uint32 version 1, Uint32 rows, cols, channels (the observation grid)
+//   chunk   "SNKC", Uint32 ticks, Uint32 payload bytes, Uint32 FNV-1a of the payload, then the payload
+//   tick    Uint8 action (right, left, down, up as snakeenv.h), Sint8 reward (the score gained from this move to
+//           the next one, food and bonus food alike, minus 1 if the move died), then the observation XOR the
+//           chunk's previous one (zeros for the first) as pairs of varint zero run, varint literal count and the
+//           literal bytes, until the observation is covered
+// Each chunk decodes on its own. A crash can leave a torn chunk at the end and the next run appends after it,
+// the reader skips chunks whose checksum fails and looks for the next chunk magic.
+// The reader maps the file, indexes the chunks and hands out minibatches in shuffled order: chunks in random
+// order decode into a pool of about DATASET_POOL_BYTES, batches draw random ticks from the pool
+
+#ifndef DATASET_H
+#define DATASET_H
+
+#include <SDL2/SDL.h>
+#include <stdio.h>
+#include "snake.h"
+#include "observation.h"
+
+// Ticks per chunk, fewer on big boards so a decoded chunk stays around 8 MB
+const int DATASET_CHUNK_TICKS = 8 * 1024 * 1024 / OBS_BYTES_SIZE > 256  ? 256
+                                : 8 * 1024 * 1024 / OBS_BYTES_SIZE < 16 ? 16
+                                                                        : 8 * 1024 * 1024 / OBS_BYTES_SIZE;
+const int DATASET_STAGING_CHUNKS = 4;
+const int DATASET_STAGING_BYTES = 1024 * 1024;  // Room for DATASET_CHUNK_TICKS ticks of a long snake
+const int DATASET_POOL_BYTES = 64 * 1024 * 1024;
+
+// Staged tick: the state before the move, the observation is encoded on the writer thread
+typedef struct {
+    Uint32 length;
+    Sint32 food;   // Grid cells (autopilot.h segmentCell), -1 for no bonus food
+    Sint32 bonus;
+    Uint8 action;
+    Sint8 reward;
+    Uint8 padding[2];
+} DatasetTick;  // Followed by Uint32 cells[length], head first
+
+typedef struct {
+    Uint8* data;
+    int used;
+    int ticks;
+} DatasetStage;
+
+typedef struct {
+    SDL_Thread* thread;
+    SDL_mutex* lock;
+    SDL_cond* changed;
+    FILE* file;
+    int quit;
+
+    // Stages waiting for the writer are first, first + 1 ... first + full - 1 (mod DATASET_STAGING_CHUNKS),
+    // first and full change under lock. The game thread fills open, -1 while all are full
+    DatasetStage stages[DATASET_STAGING_CHUNKS];
+    int first;
+    int full;
+    int open;
+    DatasetTick* last;  // Staged tick whose reward is still open, NULL if it was dropped or settled
+    int lastScore;      // Snake score and tick when last was staged
+    int lastTick;
+
+    // Writer scratch
+    Snake* snake;
+    Uint8* observation[2];
+    Uint8* payload;
+    int payloadCapacity;
+
+    long long recorded;  // Game thread
+    long long dropped;
+    long long written;   // Writer thread, read after stopRecorder
+    long long bytes;
+    int failed;
+} DatasetRecorder;
+
+typedef struct {
+    const Uint8* data;  // The mapped file
+    size_t size;
+    size_t* chunkOffsets;  // Payload offsets of the good chunks
+    int* chunkTicks;
+    int* chunkBytes;
+    int chunkCount;
+    int badChunks;
+    long long ticks;
+
+    // Current epoch: chunks in order[nextChunk..] are still to decode, the pool holds decoded ticks not yet drawn
+    Uint32 random;
+    int* order;
+    int nextChunk;
+    int poolCapacity;
+    int poolCount;
+    Uint8* poolObservations;
+    Uint8* poolActions;
+    Sint8* poolRewards;
+    Uint8* decoded;
+} DatasetReader;
+
+// Recorder functions, recordTick goes after the tick's turn is applied and before updateSnake, recordGameOver
+// once the game is lost and recordQuit when the player leaves a game that is still running
+int startRecorder(DatasetRecorder* recorder, const char* path);
+void recordTick(DatasetRecorder* recorder, Snake* snake, Food* food, bonusFood* bonus, int bonusActive);
+void recordGameOver(DatasetRecorder* recorder, Snake* snake);
+void recordQuit(DatasetRecorder* recorder, Snake* snake);
+void stopRecorder(DatasetRecorder* recorder, Snake* snake);
+
+// Reader functions
+int openDataset(DatasetReader* reader, const char* path, Uint32 seed);
+void shuffleDataset(DatasetReader* reader);
+int nextBatch(DatasetReader* reader, int count, Uint8* observations, Uint8* actions, Sint8* rewards);
+void closeDataset(DatasetReader* reader);
+
+#endif
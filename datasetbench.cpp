@@ -0,0 +1,247 @@
+// Dataset benchmark: records headless bot games through the dataset recorder as if a person played them, then
+// reads the file back in shuffled minibatches
+// Usage: datasetbench [--write FILE] [--read FILE] [--ticks N] [--batch N] [--epochs N] [--seed N]
+// Prints CSV on stdout:
+//   write: ticks,recorded,dropped,bonus_pickups,file_bytes,bytes_per_tick,us_per_tick,max_us_per_tick
+//     us_per_tick is what recordTick costs the game thread, the writer thread's work is not in it
+//   read:  ticks,chunks,bad_chunks,epochs,batch,batches,us_per_batch,ticks_per_s,check
+//     check is PASS when the same file was written in this run and every epoch returned each recorded tick once
+//     (a sum over the ticks, independent of order), "-" for a file from elsewhere
+//   the board size is fixed at build time like microbench (-DSNAKE_SCREEN_WIDTH=...)
+
+#include <SDL2/SDL.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "perf.h"
+#include "snake.h"
+#include "input.h"
+#include "autopilot.h"
+#include "observation.h"
+#include "dataset.h"
+
+// Order independent sum of the ticks, for comparing what was written with what an epoch returns
+Uint64 tickChecksum(const Uint8* observation, Uint8 action, Sint8 reward) {
+    Uint64 hash = 14695981039346656037ull;
+    for (int i = 0; i < OBS_BYTES_SIZE; ++i) {
+        hash = (hash ^ observation[i]) * 1099511628211ull;
+    }
+    return hash ^ ((Uint64)action << 56) ^ ((Uint64)(Uint8)reward << 48);
+}
+
+void startBenchGame(Snake* snake, Food* food, InputQueue* input, Autopilot* bot, Uint32 seed) {
+    initSnake(snake);
+    resetInputQueue(input, snake);
+    resetAutopilot(bot);
+    food->rect.w = 15;
+    food->rect.h = 15;
+    seedFood(food, seed);
+    generateFood(food);
+}
+
+// Returns 0 on success, the checksum of everything recorded goes to sum
+int writeBench(const char* path, int ticks, Uint64* sum) {
+    Snake* snake = (Snake*)malloc(sizeof(Snake));
+    Autopilot* bot = (Autopilot*)malloc(sizeof(Autopilot));
+    Uint8* observation = (Uint8*)malloc(OBS_BYTES_SIZE);
+    DatasetRecorder* recorder = (DatasetRecorder*)malloc(sizeof(DatasetRecorder));
+    if (snake == NULL || bot == NULL || observation == NULL || recorder == NULL) {
+        printf("Function:writeBench, allocation failed\n");
+        return 1;
+    }
+    remove(path);
+    if (startRecorder(recorder, path) != 0) {
+        return 1;
+    }
+    Food food;
+    InputQueue input;
+    bonusFood bonus;
+    bonus.rect.w = 15;
+    bonus.rect.h = 15;
+    Uint32 seed = 1;
+    initAutopilot(bot);
+    startBenchGame(snake, &food, &input, bot, seed++);
+
+    // Checksum of the staged tick whose reward is still open, it counts once the next tick or the game over
+    // settles the reward the same way the recorder does
+    int pending = 0;
+    Uint64 pendingCheck = 0;
+    int pendingScore = 0;
+    int bonusActive = 0;
+    int bonusScores = 0;
+    double recordMs = 0;
+    double maxMs = 0;
+    int lastFood = 0;
+    *sum = 0;
+    for (int tick = 0; tick < ticks; ++tick) {
+        if (checkCollision(snake, &food)) {
+            growSnake(snake, 2);
+            snake->score += 1;
+            generateFood(&food);
+        }
+        // Bonus food shows now and then and scores 3 like in the game, so its plane and reward are in the data too.
+        // It goes on the food, where the bot picks it up
+        if (tick % 200 == 0) {
+            bonus.x = food.x;
+            bonus.y = food.y;
+            bonusActive = 1;
+        }
+        if (tick % 200 == 50) {
+            bonusActive = 0;
+        }
+        if (bonusActive && checkBonusFoodCollision(snake, &bonus)) {
+            snake->score += 3;
+            bonusActive = 0;
+            bonusScores++;
+        }
+        if (pending) {
+            *sum += pendingCheck ^ ((Uint64)(Uint8)(snake->score - pendingScore) << 48);
+            pending = 0;
+        }
+        autopilotTurn(bot, snake, &food, &input);
+        Uint64 turnTime;
+        applyNextTurn(&input, snake, &turnTime);
+
+        Uint64 start = perfNow();
+        recordTick(recorder, snake, &food, &bonus, bonusActive);
+        double ms = perfMs(start, perfNow());
+        recordMs += ms;
+        maxMs = ms > maxMs ? ms : maxMs;
+        if (recorder->last != NULL) {
+            encodeObservation(snake, &food, &bonus, bonusActive, observation);
+            pending = 1;
+            pendingCheck = tickChecksum(observation, recorder->last->action, 0);
+            pendingScore = snake->score;
+        }
+
+        int score = snake->score;
+        updateSnake(snake, &food);
+        int died = isGameOver(snake);
+        if (died) {
+            recordGameOver(recorder, snake);
+            if (pending) {
+                *sum += pendingCheck ^ ((Uint64)(Uint8)(snake->score - pendingScore - 1) << 48);
+                pending = 0;
+            }
+        }
+        if (snake->score != score) {
+            lastFood = snake->tick;
+        }
+        if (died || snake->length >= SNAKE_MAX_LENGTH || snake->tick - lastFood > 2 * GRID_CELLS) {
+            // A game given up on is left like a player quitting it, its last tick keeps what that move scored
+            if (!died) {
+                recordQuit(recorder, snake);
+            }
+            if (pending) {
+                *sum += pendingCheck ^ ((Uint64)(Uint8)(snake->score - pendingScore) << 48);
+                pending = 0;
+            }
+            startBenchGame(snake, &food, &input, bot, seed++);
+            lastFood = 0;
+        }
+    }
+    if (pending) {
+        *sum += pendingCheck ^ ((Uint64)(Uint8)(snake->score - pendingScore) << 48);
+    }
+    long long recorded = recorder->recorded;
+    long long dropped = recorder->dropped;
+    stopRecorder(recorder, snake);
+    long long bytes = recorder->bytes;
+    int failed = recorder->failed;
+
+    printf("ticks,recorded,dropped,bonus_pickups,file_bytes,bytes_per_tick,us_per_tick,max_us_per_tick\n");
+    printf("%d,%lld,%lld,%d,%lld,%.1f,%.3f,%.1f\n", ticks, recorded, dropped, bonusScores, bytes, recorded > 0 ? (double)bytes / recorded : 0.0,
+           recordMs * 1000.0 / ticks, maxMs * 1000.0);
+    free(snake);
+    free(bot);
+    free(observation);
+    free(recorder);
+    return failed > 0;
+}
+
+int readBench(const char* path, int batch, int epochs, Uint32 seed, int check, Uint64 sum) {
+    DatasetReader reader;
+    if (openDataset(&reader, path, seed) != 0) {
+        return 1;
+    }
+    Uint8* observations = (Uint8*)malloc((size_t)batch * OBS_BYTES_SIZE);
+    Uint8* actions = (Uint8*)malloc(batch);
+    Sint8* rewards = (Sint8*)malloc(batch);
+    if (observations == NULL || actions == NULL || rewards == NULL) {
+        printf("Function:readBench, allocation failed\n");
+        return 1;
+    }
+    int batches = 0;
+    long long ticks = 0;
+    int pass = 1;
+    Uint64 start = perfNow();
+    for (int epoch = 0; epoch < epochs; ++epoch) {
+        if (epoch > 0) {
+            shuffleDataset(&reader);
+        }
+        Uint64 epochSum = 0;
+        int count;
+        while ((count = nextBatch(&reader, batch, observations, actions, rewards)) > 0) {
+            batches++;
+            ticks += count;
+            if (check) {
+                for (int i = 0; i < count; ++i) {
+                    epochSum += tickChecksum(observations + (size_t)i * OBS_BYTES_SIZE, actions[i], rewards[i]);
+                }
+            }
+        }
+        pass = pass && epochSum == sum;
+    }
+    double ms = perfMs(start, perfNow());
+
+    printf("ticks,chunks,bad_chunks,epochs,batch,batches,us_per_batch,ticks_per_s,check\n");
+    printf("%lld,%d,%d,%d,%d,%d,%.1f,%.0f,%s\n", reader.ticks, reader.chunkCount, reader.badChunks, epochs, batch, batches,
+           batches > 0 ? ms * 1000.0 / batches : 0.0, ms > 0 ? ticks * 1000.0 / ms : 0.0, !check ? "-" : pass ? "PASS" : "FAIL");
+    closeDataset(&reader);
+    free(observations);
+    free(actions);
+    free(rewards);
+    return check && !pass;
+}
+
+int main(int argc, char* args[]) {
+    const char* writePath = NULL;
+    const char* readPath = NULL;
+    int ticks = 20000;
+    int batch = 64;
+    int epochs = 2;
+    Uint32 seed = 1;
+    for (int i = 1; i < argc; ++i) {
+        if (strcmp(args[i], "--write") == 0 && i + 1 < argc) {
+            writePath = args[++i];
+        } else if (strcmp(args[i], "--read") == 0 && i + 1 < argc) {
+            readPath = args[++i];
+        } else if (strcmp(args[i], "--ticks") == 0 && i + 1 < argc) {
+            ticks = atoi(args[++i]);
+        } else if (strcmp(args[i], "--batch") == 0 && i + 1 < argc) {
+            batch = atoi(args[++i]);
+        } else if (strcmp(args[i], "--epochs") == 0 && i + 1 < argc) {
+            epochs = atoi(args[++i]);
+        } else if (strcmp(args[i], "--seed") == 0 && i + 1 < argc) {
+            seed = (Uint32)strtoul(args[++i], NULL, 10);
+        } else {
+            printf("Usage: datasetbench [--write FILE] [--read FILE] [--ticks N] [--batch N] [--epochs N] [--seed N]\n");
+            return 1;
+        }
+    }
+    if (writePath == NULL && readPath == NULL) {
+        writePath = "dataset_bench.bin";
+        readPath = writePath;
+    }
+
+    int result = 0;
+    Uint64 sum = 0;
+    if (writePath != NULL) {
+        result = writeBench(writePath, ticks, &sum);
+    }
+    if (readPath != NULL && result == 0) {
+        int check = writePath != NULL && strcmp(writePath, readPath) == 0;
+        result = readBench(readPath, batch, epochs, seed, check, sum);
+    }
+    return result;
+}
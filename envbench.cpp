@@ -0,0 +1,98 @@
+// Batch environment benchmark: steps N games with random actions for a while, prints env steps per second
+// Usage: envbench [--games N] [--min-ms N]
+// Prints CSV on stdout: games,board,observe,steps,episodes,ns_per_step,steps_per_s
+//   observe=1 also writes every game's observation each step, like a training loop would
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "perf.h"
+#include "snake.h"
+#include "snakeenv.h"
+
+void benchEnv(int games, int observe, double minMs) {
+    SnakeEnv* env = snakeEnvCreate(games);
+    if (env == NULL) {
+        printf("Function:benchEnv, snakeEnvCreate failed\n");
+        return;
+    }
+    int cols, rows;
+    snakeEnvBoard(env, &cols, &rows);
+    uint8_t* actions = (uint8_t*)malloc(games);
+    float* rewards = (float*)malloc(games * sizeof(float));
+    uint8_t* dones = (uint8_t*)malloc(games);
+    uint8_t* observations = observe ? (uint8_t*)malloc((size_t)games * cols * rows) : NULL;
+    uint32_t* seeds = (uint32_t*)malloc(games * sizeof(uint32_t));
+    if (actions == NULL || rewards == NULL || dones == NULL || seeds == NULL || (observe && observations == NULL)) {
+        printf("Function:benchEnv, allocation failed\n");
+        snakeEnvDestroy(env);
+        free(actions);
+        free(rewards);
+        free(dones);
+        free(observations);
+        free(seeds);
+        return;
+    }
+    for (int i = 0; i < games; ++i) {
+        seeds[i] = i + 1;
+    }
+    snakeEnvReset(env, seeds, observations);
+
+    // Mostly straight ahead (255 is not a move), so games last long enough to grow
+    Uint32 random = 1;
+    long long steps = 0;
+    long long episodes = 0;
+    Uint64 start = perfNow();
+    double ms = 0;
+    while (ms < minMs) {
+        for (int batch = 0; batch < 64; ++batch) {
+            for (int i = 0; i < games; ++i) {
+                Uint32 r = nextRandom(&random);
+                actions[i] = (r & 7) == 0 ? (r >> 8) & 3 : 255;
+            }
+            snakeEnvStep(env, actions, rewards, dones, observations);
+            for (int i = 0; i < games; ++i) {
+                episodes += dones[i] != 0;
+            }
+            steps += games;
+        }
+        ms = perfMs(start, perfNow());
+    }
+
+    printf("%d,%dx%d,%d,%lld,%lld,%.2f,%.0f\n", games, cols, rows, observe, steps, episodes, ms * 1000000.0 / steps,
+           steps / (ms / 1000.0));
+    snakeEnvDestroy(env);
+    free(actions);
+    free(rewards);
+    free(dones);
+    free(observations);
+    free(seeds);
+}
+
+int main(int argc, char* args[]) {
+    int games = 0;
+    double minMs = 1000;
+    for (int i = 1; i < argc; ++i) {
+        if (strcmp(args[i], "--games") == 0 && i + 1 < argc) {
+            games = atoi(args[++i]);
+        } else if (strcmp(args[i], "--min-ms") == 0 && i + 1 < argc) {
+            minMs = atof(args[++i]);
+        } else {
+            printf("Usage: envbench [--games N] [--min-ms N]\n");
+            return 1;
+        }
+    }
+
+    printf("games,board,observe,steps,episodes,ns_per_step,steps_per_s\n");
+    // Small batches show the per-step overhead, large ones the per-game cost once it runs from memory
+    const int GAME_COUNTS[] = {16, 256, 4096};
+    for (int c = 0; c < 3; ++c) {
+        int count = games > 0 ? games : GAME_COUNTS[c];
+        benchEnv(count, 0, minMs);
+        benchEnv(count, 1, minMs);
+        if (games > 0) {
+            break;
+        }
+    }
+    return 0;
+}
@@ -0,0 +1,207 @@
+#include "hamilton.h"
+#include "autopilot.h"
+
+// The board size is fixed at build time, so is the cycle
+HamiltonCycle boardCycleCache;
+int boardCycleBuilt = 0;
+
+void addCycleCell(HamiltonCycle* cycle, int transpose, int c, int r) {
+    int col = transpose ? r : c;
+    int row = transpose ? c : r;
+    int cell = (BOARD_FIRST_ROW + row) * GRID_COLS + BOARD_FIRST_COL + col;
+    cycle->order[cell] = cycle->length;
+    cycle->cells[cycle->length++] = cell;
+}
+
+// Along row 0, back and forth over columns 1.. on the other rows, then up column 0.
+// With an odd number of rows the cycle is built on its side, and when both sides are odd the last two rows
+// are zigzagged together leaving out their last corner (no cycle covers an odd number of grid cells)
+void buildCycle(HamiltonCycle* cycle) {
+    cycle->length = 0;
+    for (int i = 0; i < GRID_CELLS; ++i) {
+        cycle->order[i] = -1;
+    }
+
+    int width = BOARD_COLS;
+    int height = BOARD_ROWS;
+    int transpose = height % 2 == 1 && width % 2 == 0;
+    if (transpose) {
+        width = BOARD_ROWS;
+        height = BOARD_COLS;
+    }
+    if (width < 3 || height < 3) {
+        return;
+    }
+    int bothOdd = height % 2 == 1;
+
+    for (int c = 0; c < width; ++c) {
+        addCycleCell(cycle, transpose, c, 0);
+    }
+    int lastRow = bothOdd ? height - 3 : height - 1;
+    for (int r = 1; r <= lastRow; ++r) {
+        for (int i = 1; i < width; ++i) {
+            addCycleCell(cycle, transpose, r % 2 == 1 ? width - i : i, r);
+        }
+    }
+    if (bothOdd) {
+        addCycleCell(cycle, transpose, width - 1, height - 2);
+        for (int c = width - 2; c >= 2; c -= 2) {
+            addCycleCell(cycle, transpose, c, height - 2);
+            addCycleCell(cycle, transpose, c, height - 1);
+            addCycleCell(cycle, transpose, c - 1, height - 1);
+            addCycleCell(cycle, transpose, c - 1, height - 2);
+        }
+        addCycleCell(cycle, transpose, 1, height - 2);
+        addCycleCell(cycle, transpose, 1, height - 1);
+        addCycleCell(cycle, transpose, 0, height - 1);
+    }
+    for (int r = bothOdd ? height - 2 : height - 1; r >= 1; --r) {
+        addCycleCell(cycle, transpose, 0, r);
+    }
+}
+
+// Built on the first call, call once before starting threads that use it
+const HamiltonCycle* boardCycle(void) {
+    if (!boardCycleBuilt) {
+        buildCycle(&boardCycleCache);
+        boardCycleBuilt = 1;
+    }
+    return &boardCycleCache;
+}
+
+// Position of a cell along the bot's direction of travel, -1 off the cycle
+int cyclePosition(HamiltonBot* bot, int cell) {
+    int order = bot->cycle->order[cell];
+    if (order < 0 || bot->direction > 0) {
+        return order;
+    }
+    return (bot->cycle->length - order) % bot->cycle->length;
+}
+
+int cycleCellAt(HamiltonBot* bot, int position) {
+    int length = bot->cycle->length;
+    position %= length;
+    return bot->cycle->cells[bot->direction > 0 ? position : (length - position) % length];
+}
+
+// Cycle steps from one cell forward to another
+int cycleAhead(HamiltonBot* bot, int from, int to) {
+    int length = bot->cycle->length;
+    return (cyclePosition(bot, to) - cyclePosition(bot, from) + length) % length;
+}
+
+// Does the body lie on consecutive cycle cells behind the head? Repeated tail segments count once
+int bodyOnCycle(HamiltonBot* bot, Snake* snake) {
+    int length = bot->cycle->length;
+    int expected = cyclePosition(bot, segmentCell(snake, 0));
+    if (expected < 0) {
+        return 0;
+    }
+    for (int i = 1; i < snake->length; ++i) {
+        int cell = segmentCell(snake, i);
+        if (cell == segmentCell(snake, i - 1)) {
+            continue;
+        }
+        expected = (expected - 1 + length) % length;
+        if (cyclePosition(bot, cell) != expected) {
+            return 0;
+        }
+    }
+    return 1;
+}
+
+void initHamiltonBot(HamiltonBot* bot) {
+    bot->cycle = boardCycle();
+    bot->direction = 1;
+    bot->aligned = 0;
+    bot->decisions = 0;
+    bot->skips = 0;
+}
+
+// Pick the direction the new snake already runs in, call when a game starts
+void resetHamiltonBot(HamiltonBot* bot, Snake* snake) {
+    bot->direction = 1;
+    bot->aligned = bodyOnCycle(bot, snake);
+    if (!bot->aligned) {
+        bot->direction = -1;
+        bot->aligned = bodyOnCycle(bot, snake);
+    }
+    if (!bot->aligned) {
+        bot->direction = 1;
+    }
+}
+
+// Queue this tick's move, returns 0 when the snake is stuck
+int hamiltonTurn(HamiltonBot* bot, Snake* snake, Food* food, InputQueue* input) {
+    bot->decisions++;
+    const HamiltonCycle* cycle = bot->cycle;
+    if (cycle->length == 0) {
+        return 0;
+    }
+    int head = segmentCell(snake, 0);
+    int headCol = head % GRID_COLS;
+    int headRow = head / GRID_COLS;
+    if (!bot->aligned) {
+        bot->aligned = bodyOnCycle(bot, snake);
+    }
+
+    int target = -1;
+    if (cycle->order[head] >= 0) {
+        target = cycleCellAt(bot, cyclePosition(bot, head) + 1);
+    }
+
+    // Skip ahead while the snake is short: not past the food, and leaving room before the tail
+    if (bot->aligned && target >= 0 && snake->length < cycle->length / 2) {
+        int tailAhead = cycleAhead(bot, head, segmentCell(snake, snake->length - 1));
+        int foodAhead = cycle->length;
+        for (int row = (food->y - SEGMENT_HEIGHT) / CELL_SIZE; row <= (food->y + food->rect.h) / CELL_SIZE; ++row) {
+            for (int col = (food->x - SEGMENT_WIDTH) / CELL_SIZE; col <= (food->x + food->rect.w) / CELL_SIZE; ++col) {
+                int cell = row * GRID_COLS + col;
+                if (row < 0 || row >= GRID_ROWS || col < 0 || col >= GRID_COLS || cycle->order[cell] < 0 ||
+                    !eatsFood(food, col, row)) {
+                    continue;
+                }
+                int ahead = cycleAhead(bot, head, cell);
+                if (ahead > 0 && ahead < foodAhead) {
+                    foodAhead = ahead;
+                }
+            }
+        }
+        int best = 1;
+        for (int i = 0; i < 4; ++i) {
+            int col = headCol + STEP_COLS[i];
+            int row = headRow + STEP_ROWS[i];
+            int cell = row * GRID_COLS + col;
+            if (!insideBoard(col, row) || cycle->order[cell] < 0) {
+                continue;
+            }
+            int ahead = cycleAhead(bot, head, cell);
+            if (ahead > best && ahead <= foodAhead && ahead < tailAhead - HAMILTON_SKIP_MARGIN &&
+                !blockedNextTick(snake, col, row)) {
+                best = ahead;
+                target = cell;
+            }
+        }
+        if (best > 1) {
+            bot->skips++;
+        }
+    }
+
+    // Off the cycle or blocked before the body lines up: any free neighbour on the cycle
+    if (target < 0 || blockedNextTick(snake, target % GRID_COLS, target / GRID_COLS)) {
+        target = -1;
+        for (int i = 0; i < 4 && target < 0; ++i) {
+            int col = headCol + STEP_COLS[i];
+            int row = headRow + STEP_ROWS[i];
+            if (insideBoard(col, row) && cycle->order[row * GRID_COLS + col] >= 0 &&
+                !blockedNextTick(snake, col, row)) {
+                target = row * GRID_COLS + col;
+            }
+        }
+        if (target < 0) {
+            return 0;
+        }
+    }
+    queueTurn(input, (target % GRID_COLS - headCol) * CELL_SIZE, (target / GRID_COLS - headRow) * CELL_SIZE, 0);
+    return 1;
+}
@@ -0,0 +1,36 @@
+// Hamiltonian cycle bot: the snake follows a fixed cycle through every board cell, so it can't run into
+// itself until the board is full. The cycle is built once per board size. While the snake is short it may
+// skip ahead along the cycle through a neighbouring cell, as long as it lands before the food and well
+// before its tail in cycle order, so the body always stays on the part of the cycle behind the head.
+// A move costs a handful of array lookups
+
+#ifndef HAMILTON_H
+#define HAMILTON_H
+
+#include "snake.h"
+#include "input.h"
+
+// Free cells kept between the head and the tail when skipping ahead, covers food eaten right after a skip
+const int HAMILTON_SKIP_MARGIN = 10;
+
+typedef struct {
+    int length;              // Cells on the cycle, one short of the board when both sides are odd
+    int cells[GRID_CELLS];   // Cell at each cycle position
+    int order[GRID_CELLS];   // Cycle position of each cell, -1 off the cycle
+} HamiltonCycle;
+
+typedef struct {
+    const HamiltonCycle* cycle;
+    int direction;  // 1 or -1, whichever way the starting body already runs along the cycle
+    int aligned;    // Body on consecutive cycle cells, until then the bot only follows the cycle
+    int decisions;
+    int skips;      // Moves that skipped ahead
+} HamiltonBot;
+
+// Hamiltonian cycle functions
+const HamiltonCycle* boardCycle(void);
+void initHamiltonBot(HamiltonBot* bot);
+void resetHamiltonBot(HamiltonBot* bot, Snake* snake);
+int hamiltonTurn(HamiltonBot* bot, Snake* snake, Food* food, InputQueue* input);
+
+#endif
@@ -0,0 +1,128 @@
+#include "heuristic.h"
+#include "autopilot.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+void initHeuristicBot(HeuristicBot* bot, const double* weights) {
+    for (int i = 0; i < HEURISTIC_FEATURES; ++i) {
+        bot->weights[i] = weights[i];
+    }
+    for (int i = 0; i < GRID_CELLS; ++i) {
+        bot->seen[i] = 0;
+    }
+    bot->seenMark = 0;
+    bot->decisions = 0;
+}
+
+// Best weights of a trainer checkpoint, the line "best FITNESS W0 W1 W2 W3" with the values as the hex bits of
+// the doubles. Returns 0 on success, weights are untouched otherwise
+int loadHeuristicWeights(const char* path, double* weights) {
+    FILE* file = fopen(path, "r");
+    if (file == NULL) {
+        return 1;
+    }
+    char line[512];
+    int found = 0;
+    while (!found && fgets(line, sizeof(line), file) != NULL) {
+        unsigned long long bits[HEURISTIC_FEATURES + 1];
+        if (strncmp(line, "best ", 5) == 0 &&
+            sscanf(line + 5, "%llx %llx %llx %llx %llx", &bits[0], &bits[1], &bits[2], &bits[3], &bits[4]) == 5) {
+            for (int i = 0; i < HEURISTIC_FEATURES; ++i) {
+                memcpy(&weights[i], &bits[i + 1], sizeof(double));
+            }
+            found = 1;
+        }
+    }
+    fclose(file);
+    if (!found) {
+        printf("Function:loadHeuristicWeights, no best weights in %s\n", path);
+        return 1;
+    }
+    return 0;
+}
+
+// Features of the cell a move enters, the cell itself must be free
+void heuristicFeatures(HeuristicBot* bot, Snake* snake, Food* food, int col, int row, double* features) {
+    int foodDistance = abs(food->x / CELL_SIZE - col) + abs(food->y / CELL_SIZE - row);
+    features[FEATURE_FOOD] = 1.0 - (double)foodDistance / (BOARD_COLS + BOARD_ROWS);
+
+    int edge = col - BOARD_FIRST_COL;
+    edge = BOARD_LAST_COL - col < edge ? BOARD_LAST_COL - col : edge;
+    edge = row - BOARD_FIRST_ROW < edge ? row - BOARD_FIRST_ROW : edge;
+    edge = BOARD_LAST_ROW - row < edge ? BOARD_LAST_ROW - row : edge;
+    int half = (BOARD_COLS < BOARD_ROWS ? BOARD_COLS : BOARD_ROWS) / 2;
+    features[FEATURE_WALL] = half > 0 ? (double)edge / half : 0.0;
+
+    // Flood fill from the cell, the head's cell and every segment but the tail are walls
+    int tail = segmentCell(snake, snake->length - 1);
+    int cap = snake->length + HEURISTIC_SPACE_MARGIN;
+    int tailSteps = -1;
+    bot->seenMark++;
+    bot->seen[segmentCell(snake, 0)] = bot->seenMark;
+    int start = row * GRID_COLS + col;
+    bot->seen[start] = bot->seenMark;
+    bot->queue[0] = start;
+    bot->steps[start] = 0;
+    int head = 0;
+    int count = 1;
+    while (head < count && (count < cap || tailSteps < 0)) {
+        int cell = bot->queue[head++];
+        if (cell == tail) {
+            tailSteps = bot->steps[cell];
+            continue;
+        }
+        int cellCol = cell % GRID_COLS;
+        int cellRow = cell / GRID_COLS;
+        for (int i = 0; i < 4; ++i) {
+            int nextCol = cellCol + STEP_COLS[i];
+            int nextRow = cellRow + STEP_ROWS[i];
+            int next = nextRow * GRID_COLS + nextCol;
+            if (!insideBoard(nextCol, nextRow) || bot->seen[next] == bot->seenMark) {
+                continue;
+            }
+            int segment = snakeSegmentAt(snake, nextCol, nextRow);
+            if (segment >= 0 && next != tail) {
+                continue;
+            }
+            bot->seen[next] = bot->seenMark;
+            bot->steps[next] = bot->steps[cell] + 1;
+            bot->queue[count++] = next;
+        }
+    }
+    features[FEATURE_SPACE] = count < cap ? (double)count / cap : 1.0;
+    features[FEATURE_TAIL] = tailSteps >= 0 ? 1.0 - (double)tailSteps / (BOARD_COLS * BOARD_ROWS) : 0.0;
+}
+
+int heuristicTurn(HeuristicBot* bot, Snake* snake, Food* food, InputQueue* input) {
+    bot->decisions++;
+    int head = segmentCell(snake, 0);
+    int headCol = head % GRID_COLS;
+    int headRow = head / GRID_COLS;
+
+    int best = -1;
+    double bestScore = 0;
+    for (int i = 0; i < 4; ++i) {
+        int col = headCol + STEP_COLS[i];
+        int row = headRow + STEP_ROWS[i];
+        // The reverse move is the neck, which is blocked like any other segment
+        if (!insideBoard(col, row) || blockedNextTick(snake, col, row)) {
+            continue;
+        }
+        double features[HEURISTIC_FEATURES];
+        heuristicFeatures(bot, snake, food, col, row, features);
+        double score = 0;
+        for (int f = 0; f < HEURISTIC_FEATURES; ++f) {
+            score += bot->weights[f] * features[f];
+        }
+        if (best < 0 || score > bestScore) {
+            best = i;
+            bestScore = score;
+        }
+    }
+    if (best < 0) {
+        return 0;
+    }
+    queueTurn(input, STEP_COLS[best] * CELL_SIZE, STEP_ROWS[best] * CELL_SIZE, 0);
+    return 1;
+}
@@ -0,0 +1,50 @@
+// Heuristic bot: every tick it scores the three moves that don't reverse with a weighted sum of features of
+// the cell the move enters, and takes the best one. The weights are tuned offline by the trainer tool.
+// Features, each scaled to about 0..1:
+//   food   1 - Manhattan distance to the food over the board's half perimeter
+//   space  cells reachable from the cell (flood fill, the body counts as walls), capped just above the length
+//   tail   1 - flood fill distance to the tail over the board size, 0 when the tail can't be reached
+//   wall   distance to the nearest edge of the board over half the shorter side
+// Moves into a wall or the body are never taken while another move exists
+
+#ifndef HEURISTIC_H
+#define HEURISTIC_H
+
+#include "snake.h"
+#include "input.h"
+
+// Feature order in weight vectors
+const int FEATURE_FOOD = 0;
+const int FEATURE_SPACE = 1;
+const int FEATURE_TAIL = 2;
+const int FEATURE_WALL = 3;
+const int HEURISTIC_FEATURES = 4;
+
+// The flood fill stops once it counted this many cells more than the snake is long
+const int HEURISTIC_SPACE_MARGIN = 40;
+
+// Hand picked, used until trained weights are loaded
+const double HEURISTIC_DEFAULT_WEIGHTS[HEURISTIC_FEATURES] = {1.0, 2.0, 0.5, 0.1};
+
+// Checkpoint the trainer writes, its best weights are what the game and the tournament load
+const char* const TRAINER_CHECKPOINT = "trainer.txt";
+
+typedef struct {
+    double weights[HEURISTIC_FEATURES];
+
+    // Flood fill scratch space
+    int queue[GRID_CELLS];
+    int steps[GRID_CELLS];
+    int seen[GRID_CELLS];
+    int seenMark;
+
+    int decisions;
+} HeuristicBot;
+
+// Heuristic bot functions
+void initHeuristicBot(HeuristicBot* bot, const double* weights);
+int loadHeuristicWeights(const char* path, double* weights);
+void heuristicFeatures(HeuristicBot* bot, Snake* snake, Food* food, int col, int row, double* features);
+int heuristicTurn(HeuristicBot* bot, Snake* snake, Food* food, InputQueue* input);
+
+#endif
@@ -0,0 +1,135 @@
+#include "hud.h"
+#include "perf.h"
+#include "snake.h"
+#include <stdio.h>
+
+// Graph area inside HUD_RECT, bars are scaled so the top is HUD_GRAPH_MAX_MS
+const int HUD_GRAPH_HEIGHT = 50;
+const int HUD_BAR_WIDTH = 3;
+const float HUD_GRAPH_MAX_MS = 100.0f;
+
+// Frames slower than one tick are drawn red
+const float HUD_BUDGET_MS = 1000.0f / SCREEN_FPS;
+
+const Uint32 HUD_UPDATE_MS = 500;
+
+void initPerfHud(PerfHud* hud) {
+    hud->tickMs = 0;
+    hud->renderMs = 0;
+    hud->presentMs = 0;
+    hud->drawCalls = 0;
+    for (int i = 0; i < HUD_HISTORY; ++i) {
+        hud->frameMs[i] = 0;
+    }
+    hud->next = 0;
+    hud->lastPresent = 0;
+    hud->frames = 0;
+    hud->intervalStart = perfNow();
+    memStatsSnapshot(&hud->intervalMem);
+    for (int i = 0; i < HUD_LINES; ++i) {
+        hud->text[i][0] = '\0';
+    }
+
+    // Two triangles per bar, the indices never change
+    for (int i = 0; i < HUD_HISTORY; ++i) {
+        int* index = &hud->indices[i * 6];
+        int first = i * 4;
+        index[0] = first;
+        index[1] = first + 1;
+        index[2] = first + 2;
+        index[3] = first + 2;
+        index[4] = first + 1;
+        index[5] = first + 3;
+    }
+}
+
+// Record a presented frame, the overlay always shows the previous frame because present time isn't known before presenting
+void hudFrame(PerfHud* hud, double tickMs, double renderMs, double presentMs, int drawCalls, Uint64 presentTime) {
+    hud->tickMs = tickMs;
+    hud->renderMs = renderMs;
+    hud->presentMs = presentMs;
+    hud->drawCalls = drawCalls;
+
+    if (hud->lastPresent != 0) {
+        hud->frameMs[hud->next] = (float)perfMs(hud->lastPresent, presentTime);
+        hud->next = (hud->next + 1) % HUD_HISTORY;
+    }
+    hud->lastPresent = presentTime;
+
+    hud->frames++;
+    double intervalMs = perfMs(hud->intervalStart, presentTime);
+    if (intervalMs < HUD_UPDATE_MS) {
+        return;
+    }
+    double fps = hud->frames * 1000.0 / intervalMs;
+    float lastFrameMs = hud->frameMs[(hud->next + HUD_HISTORY - 1) % HUD_HISTORY];
+    snprintf(hud->text[0], sizeof(hud->text[0]), "FPS %.1f  frame %.1f ms", fps, lastFrameMs);
+    snprintf(hud->text[1], sizeof(hud->text[1]), "tick %.2f  render %.2f  present %.2f", tickMs, renderMs, presentMs);
+    snprintf(hud->text[2], sizeof(hud->text[2]), "draw calls %d  textures %d", drawCalls, liveTextureCount());
+
+    MemStats now;
+    MemStats delta;
+    memStatsSnapshot(&now);
+    memStatsDelta(&hud->intervalMem, &now, &delta);
+    snprintf(hud->text[3], sizeof(hud->text[3]), "allocs/frame %.1f  textures +%d -%d", (double)delta.allocs / hud->frames, delta.texturesCreated, delta.texturesDestroyed);
+    hud->intervalMem = now;
+    hud->frames = 0;
+    hud->intervalStart = presentTime;
+}
+
+// Draw the overlay on top of the current frame
+void renderPerfHud(PerfHud* hud, SDL_Renderer* renderer, GlyphCache* glyphs) {
+    SDL_RenderSetClipRect(renderer, NULL);
+
+    // Dark translucent panel
+    SDL_SetRenderDrawBlendMode(renderer, SDL_BLENDMODE_BLEND);
+    SDL_SetRenderDrawColor(renderer, 0, 0, 0, 170);
+    SDL_RenderFillRect(renderer, &HUD_RECT);
+
+    // Drawn from the glyph atlas, the numbers change every update and must not allocate
+    SDL_Color white = {255, 255, 255, 255};
+    for (int i = 0; i < HUD_LINES; ++i) {
+        drawGlyphText(glyphs, renderer, hud->text[i], HUD_RECT.x + 6, HUD_RECT.y + 2 + i * 26, white);
+    }
+
+    // Frame time graph, oldest frame on the left
+    float left = (float)(HUD_RECT.x + (HUD_RECT.w - HUD_HISTORY * HUD_BAR_WIDTH) / 2);
+    float bottom = (float)(HUD_RECT.y + HUD_RECT.h - 6);
+    for (int i = 0; i < HUD_HISTORY; ++i) {
+        float ms = hud->frameMs[(hud->next + i) % HUD_HISTORY];
+        float height = ms / HUD_GRAPH_MAX_MS * HUD_GRAPH_HEIGHT;
+        if (height > HUD_GRAPH_HEIGHT) {
+            height = HUD_GRAPH_HEIGHT;
+        }
+        SDL_Color color = {90, 220, 90, 255};
+        if (ms > HUD_BUDGET_MS) {
+            color.r = 230;
+            color.g = 60;
+            color.b = 60;
+        }
+        float x = left + i * HUD_BAR_WIDTH;
+        SDL_Vertex* vertex = &hud->vertices[i * 4];
+        for (int j = 0; j < 4; ++j) {
+            vertex[j].color = color;
+            vertex[j].tex_coord.x = 0;
+            vertex[j].tex_coord.y = 0;
+        }
+        vertex[0].position.x = x;
+        vertex[0].position.y = bottom - height;
+        vertex[1].position.x = x + HUD_BAR_WIDTH - 1;
+        vertex[1].position.y = bottom - height;
+        vertex[2].position.x = x;
+        vertex[2].position.y = bottom;
+        vertex[3].position.x = x + HUD_BAR_WIDTH - 1;
+        vertex[3].position.y = bottom;
+    }
+    SDL_RenderGeometry(renderer, NULL, hud->vertices, HUD_HISTORY * 4, hud->indices, HUD_HISTORY * 6);
+
+    // Budget line
+    int budgetY = (int)(bottom - HUD_BUDGET_MS / HUD_GRAPH_MAX_MS * HUD_GRAPH_HEIGHT);
+    SDL_SetRenderDrawColor(renderer, 255, 255, 255, 120);
+    SDL_RenderDrawLine(renderer, (int)left, budgetY, (int)left + HUD_HISTORY * HUD_BAR_WIDTH, budgetY);
+
+    SDL_SetRenderDrawBlendMode(renderer, SDL_BLENDMODE_NONE);
+    SDL_SetRenderDrawColor(renderer, 0, 0, 0, 255);
+}
@@ -0,0 +1,46 @@
+// Performance overlay: FPS, tick/render/present times, draw calls, allocations, textures and a frame time graph
+// Owned and drawn by the render thread, toggled from the game loop with F3
+
+#ifndef HUD_H
+#define HUD_H
+
+#include <SDL2/SDL.h>
+#include "texture.h"
+#include "memstats.h"
+
+// Screen area covered by the overlay, the game damages it every frame while the overlay is shown
+const SDL_Rect HUD_RECT = {10, 10, 420, 176};
+
+// Frames in the graph, one bar each
+const int HUD_HISTORY = 110;
+const int HUD_LINES = 4;
+
+typedef struct {
+    // Last frame
+    double tickMs;
+    double renderMs;
+    double presentMs;
+    int drawCalls;
+
+    // Frame time (present to present) history, ring buffer
+    float frameMs[HUD_HISTORY];
+    int next;
+    Uint64 lastPresent;
+
+    // FPS, allocations and the text are averaged over half a second so the numbers stay readable
+    int frames;
+    Uint64 intervalStart;
+    MemStats intervalMem;
+    char text[HUD_LINES][64];
+
+    // Preallocated graph geometry, 4 vertices and 6 indices per bar
+    SDL_Vertex vertices[HUD_HISTORY * 4];
+    int indices[HUD_HISTORY * 6];
+} PerfHud;
+
+// HUD functions, call them on the render thread
+void initPerfHud(PerfHud* hud);
+void hudFrame(PerfHud* hud, double tickMs, double renderMs, double presentMs, int drawCalls, Uint64 presentTime);
+void renderPerfHud(PerfHud* hud, SDL_Renderer* renderer, GlyphCache* glyphs);
+
+#endif
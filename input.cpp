@@ -0,0 +1,50 @@
+#include "input.h"
+#include "perf.h"
+
+// Start from the snake's current direction with nothing queued
+void resetInputQueue(InputQueue* input, Snake* snake) {
+    input->head = 0;
+    input->tail = 0;
+    input->lastDx = snake->dx;
+    input->lastDy = snake->dy;
+}
+
+// Queue a turn, returns 0 if it was dropped (reversal, same direction or queue full)
+int queueTurn(InputQueue* input, int dx, int dy, Uint64 time) {
+    // Turning back into the body or repeating the direction does nothing
+    if ((dx != 0 && input->lastDx != 0) || (dy != 0 && input->lastDy != 0)) {
+        return 0;
+    }
+    if (input->tail - input->head == INPUT_QUEUE_SIZE) {
+        return 0;
+    }
+    TurnInput* turn = &input->turns[input->tail & (INPUT_QUEUE_SIZE - 1)];
+    turn->dx = dx;
+    turn->dy = dy;
+    turn->time = time;
+    input->tail++;
+    input->lastDx = dx;
+    input->lastDy = dy;
+    return 1;
+}
+
+// Apply at most one queued turn, call once per tick before updateSnake. Returns 1 and the key time if a turn was applied
+int applyNextTurn(InputQueue* input, Snake* snake, Uint64* time) {
+    if (input->head == input->tail) {
+        return 0;
+    }
+    TurnInput* turn = &input->turns[input->head & (INPUT_QUEUE_SIZE - 1)];
+    input->head++;
+    snake->dx = turn->dx;
+    snake->dy = turn->dy;
+    *time = turn->time;
+    return 1;
+}
+
+// Performance counter time of an SDL event, events can wait in SDL's queue for a while before being polled
+Uint64 eventTime(Uint32 eventTimestamp) {
+    Uint64 now = perfNow();
+    Uint32 waitedMs = SDL_GetTicks() - eventTimestamp;
+    Uint64 waited = (Uint64)waitedMs * SDL_GetPerformanceFrequency() / 1000;
+    return waited < now ? now - waited : now;
+}
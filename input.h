@@ -0,0 +1,31 @@
+// Per-tick input queue: turns are queued as they arrive and applied one per simulation tick,
+// so two quick presses within one tick are both kept and can't reverse the snake into itself
+
+#ifndef INPUT_H
+#define INPUT_H
+
+#include <SDL2/SDL.h>
+#include "snake.h"
+
+// Power of two, turns beyond this many ticks ahead are dropped
+const int INPUT_QUEUE_SIZE = 16;
+
+typedef struct {
+    int dx, dy;
+    Uint64 time;  // Performance counter when the key was pressed
+} TurnInput;
+
+typedef struct {
+    TurnInput turns[INPUT_QUEUE_SIZE];
+    int head;            // Next turn to apply
+    int tail;            // Next free slot
+    int lastDx, lastDy;  // Direction after every queued turn, new turns are checked against it
+} InputQueue;
+
+// Input queue functions
+void resetInputQueue(InputQueue* input, Snake* snake);
+int queueTurn(InputQueue* input, int dx, int dy, Uint64 time);
+int applyNextTurn(InputQueue* input, Snake* snake, Uint64* time);
+Uint64 eventTime(Uint32 eventTimestamp);
+
+#endif
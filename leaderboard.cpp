@@ -0,0 +1,197 @@
+#include "leaderboard.h"
+#include <stddef.h>
+#include <stdio.h>
+#include <string.h>
+
+#ifdef _WIN32
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+// saveLeaderboard queues header and entries as one block
+static_assert(offsetof(Leaderboard, entries) == offsetof(Leaderboard, header) + sizeof(LeaderboardHeader),
+              "Leaderboard entries must follow the header without padding");
+
+Uint32 leaderboardChecksum(const LeaderboardEntry* entries, int count) {
+    const Uint8* bytes = (const Uint8*)entries;
+    Uint32 hash = 2166136261u;
+    for (size_t i = 0; i < count * sizeof(LeaderboardEntry); ++i) {
+        hash = (hash ^ bytes[i]) * 16777619u;
+    }
+    return hash;
+}
+
+// Table order: board and level ascending
+int compareTable(const LeaderboardEntry* a, int cols, int rows, int level) {
+    if (a->cols != cols) {
+        return a->cols < cols ? -1 : 1;
+    }
+    if (a->rows != rows) {
+        return a->rows < rows ? -1 : 1;
+    }
+    if (a->level != level) {
+        return a->level < level ? -1 : 1;
+    }
+    return 0;
+}
+
+// Within a table best score first, on a tie the older entry keeps the better rank
+int compareEntries(const LeaderboardEntry* a, const LeaderboardEntry* b) {
+    int table = compareTable(a, b->cols, b->rows, b->level);
+    if (table != 0) {
+        return table;
+    }
+    if (a->score != b->score) {
+        return a->score > b->score ? -1 : 1;
+    }
+    if (a->date != b->date) {
+        return a->date < b->date ? -1 : 1;
+    }
+    return 0;
+}
+
+// First entry of the table, or of the table after it when after is set
+int findTable(Leaderboard* board, int cols, int rows, int level, int after) {
+    int low = 0;
+    int high = board->count;
+    while (low < high) {
+        int middle = (low + high) / 2;
+        int order = compareTable(&board->entries[middle], cols, rows, level);
+        if (order < 0 || (after && order == 0)) {
+            low = middle + 1;
+        } else {
+            high = middle;
+        }
+    }
+    return low;
+}
+
+// Map the file and copy it in if the header and checksum are good. Returns 0 on success,
+// the leaderboard starts empty otherwise
+int loadLeaderboard(Leaderboard* board, const char* path) {
+    board->count = 0;
+    snprintf(board->path, sizeof(board->path), "%s", path);
+
+    const Uint8* data = NULL;
+    size_t size = 0;
+#ifdef _WIN32
+    HANDLE file = CreateFileA(path, GENERIC_READ, FILE_SHARE_READ, NULL, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, NULL);
+    if (file == INVALID_HANDLE_VALUE) {
+        return 1;
+    }
+    LARGE_INTEGER fileSize;
+    HANDLE mapping = NULL;
+    if (GetFileSizeEx(file, &fileSize) && fileSize.QuadPart > 0) {
+        mapping = CreateFileMappingA(file, NULL, PAGE_READONLY, 0, 0, NULL);
+    }
+    if (mapping != NULL) {
+        data = (const Uint8*)MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0);
+        size = (size_t)fileSize.QuadPart;
+    }
+#else
+    int file = open(path, O_RDONLY);
+    if (file < 0) {
+        return 1;
+    }
+    struct stat info;
+    if (fstat(file, &info) == 0 && info.st_size > 0) {
+        void* view = mmap(NULL, info.st_size, PROT_READ, MAP_PRIVATE, file, 0);
+        if (view != MAP_FAILED) {
+            data = (const Uint8*)view;
+            size = (size_t)info.st_size;
+        }
+    }
+#endif
+
+    int result = 1;
+    const LeaderboardHeader* header = (const LeaderboardHeader*)data;
+    if (data == NULL || size < sizeof(LeaderboardHeader)) {
+        printf("Function:loadLeaderboard, Unable to map %s\n", path);
+    } else if (header->magic != LEADERBOARD_MAGIC || header->version != LEADERBOARD_VERSION ||
+               header->count > (Uint32)LEADERBOARD_MAX_ENTRIES ||
+               size != sizeof(LeaderboardHeader) + header->count * sizeof(LeaderboardEntry)) {
+        printf("Function:loadLeaderboard, %s is not a leaderboard file\n", path);
+    } else {
+        const LeaderboardEntry* entries = (const LeaderboardEntry*)(data + sizeof(LeaderboardHeader));
+        if (leaderboardChecksum(entries, header->count) != header->checksum) {
+            printf("Function:loadLeaderboard, %s failed its checksum\n", path);
+        } else {
+            memcpy(board->entries, entries, header->count * sizeof(LeaderboardEntry));
+            board->count = header->count;
+            result = 0;
+        }
+    }
+
+#ifdef _WIN32
+    if (data != NULL) {
+        UnmapViewOfFile(data);
+    }
+    if (mapping != NULL) {
+        CloseHandle(mapping);
+    }
+    CloseHandle(file);
+#else
+    if (data != NULL) {
+        munmap((void*)data, size);
+    }
+    close(file);
+#endif
+    return result;
+}
+
+// Insert a finished game, returns its rank in its table (0 is best) or -1 if it didn't make the table
+int leaderboardInsert(Leaderboard* board, const LeaderboardEntry* entry) {
+    int start = findTable(board, entry->cols, entry->rows, entry->level, 0);
+    int end = findTable(board, entry->cols, entry->rows, entry->level, 1);
+
+    // Upper bound inside the table, equal entries stay ahead
+    int low = start;
+    int high = end;
+    while (low < high) {
+        int middle = (low + high) / 2;
+        if (compareEntries(&board->entries[middle], entry) <= 0) {
+            low = middle + 1;
+        } else {
+            high = middle;
+        }
+    }
+    int position = low;
+    int rank = position - start;
+    if (rank >= LEADERBOARD_TOP_N) {
+        return -1;
+    }
+
+    // A full table or file drops the worst entry of this table
+    if (end - start == LEADERBOARD_TOP_N || board->count == LEADERBOARD_MAX_ENTRIES) {
+        if (position == end) {
+            return -1;
+        }
+        memmove(&board->entries[end - 1], &board->entries[end], (board->count - end) * sizeof(LeaderboardEntry));
+        board->count--;
+    }
+    memmove(&board->entries[position + 1], &board->entries[position], (board->count - position) * sizeof(LeaderboardEntry));
+    board->entries[position] = *entry;
+    board->count++;
+    return rank;
+}
+
+// Entries of one board and level, best first
+int leaderboardTable(Leaderboard* board, int cols, int rows, int level, const LeaderboardEntry** first) {
+    int start = findTable(board, cols, rows, level, 0);
+    int end = findTable(board, cols, rows, level, 1);
+    *first = &board->entries[start];
+    return end - start;
+}
+
+// Queue the file image on the save writer
+void saveLeaderboard(Leaderboard* board, SaveWriter* writer) {
+    board->header.magic = LEADERBOARD_MAGIC;
+    board->header.version = LEADERBOARD_VERSION;
+    board->header.count = board->count;
+    board->header.checksum = leaderboardChecksum(board->entries, board->count);
+    queueSave(writer, board->path, &board->header, sizeof(LeaderboardHeader) + board->count * sizeof(LeaderboardEntry));
+}
@@ -0,0 +1,52 @@
+// Top scores per board size and level, kept in one fixed-record binary file:
+// a header with a checksum followed by the entries, sorted by board, level, then score from best to worst.
+// The file is memory mapped to load it, scores are inserted with a binary search and the whole file is saved
+// through the save writer (temp file + rename)
+
+#ifndef LEADERBOARD_H
+#define LEADERBOARD_H
+
+#include <SDL2/SDL.h>
+#include "savefile.h"
+
+const Uint32 LEADERBOARD_MAGIC = 0x4c4b4e53;  // "SNKL"
+const Uint32 LEADERBOARD_VERSION = 1;
+
+// Entries kept per board and level, and across the whole file
+const int LEADERBOARD_TOP_N = 1000;
+const int LEADERBOARD_MAX_ENTRIES = 8192;
+
+// 32 bytes, written as is (little endian)
+typedef struct {
+    Uint16 cols, rows;  // Board size in cells
+    Uint16 level;
+    Uint16 flags;
+    Sint32 score;
+    Sint32 length;
+    Uint32 durationMs;  // Game time
+    Uint32 replay;      // Recording id, 0 when the game wasn't recorded
+    Sint64 date;        // Unix time
+} LeaderboardEntry;
+
+typedef struct {
+    Uint32 magic;
+    Uint32 version;
+    Uint32 count;
+    Uint32 checksum;  // FNV-1a of the entries
+} LeaderboardHeader;
+
+// header and entries are the file image, they must stay next to each other
+typedef struct {
+    LeaderboardHeader header;
+    LeaderboardEntry entries[LEADERBOARD_MAX_ENTRIES];
+    int count;
+    char path[256];
+} Leaderboard;
+
+// Leaderboard functions
+int loadLeaderboard(Leaderboard* board, const char* path);
+int leaderboardInsert(Leaderboard* board, const LeaderboardEntry* entry);
+int leaderboardTable(Leaderboard* board, int cols, int rows, int level, const LeaderboardEntry** first);
+void saveLeaderboard(Leaderboard* board, SaveWriter* writer);
+
+#endif
@@ -10,180 +10,186 @@
 #include <SDL2/SDL_ttf.h>
 #include <SDL2/SDL_mixer.h>
 #include <stdio.h>
-
-// Screen dimension constants
-const int SCREEN_WIDTH = 960;
-const int SCREEN_HEIGHT = 600;
-
-// Game loading speed FPS
-const int SCREEN_FPS = 15;
-const int SCREEN_TICK_PER_FRAME = 1000 / SCREEN_FPS;
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include "perf.h"
+#include "snake.h"
+#include "input.h"
+#include "playfield.h"
+#include "render.h"
+#include "trace.h"
+#include "memstats.h"
+#include "audio.h"
+#include "music.h"
+#include "savefile.h"
+#include "leaderboard.h"
+#include "autopilot.h"
+#include "hamilton.h"
+#include "mcts.h"
+#include "heuristic.h"
+#include "policy.h"
+#include "dataset.h"
+
+// --autopilot: demo games end after this many ticks, the bot rarely dies on its own
+const int AUTOPILOT_GAME_TICKS = 20000;
+
+// --bot: which bot plays the autopilot games
+const int BOT_PATH = 0;
+const int BOT_CYCLE = 1;
+const int BOT_MCTS = 2;
+const int BOT_HEURISTIC = 3;  // Weights from the trainer's checkpoint when there is one
+const int BOT_POLICY = 4;     // Network from POLICY_FILE
+const char* const POLICY_FILE = "policy.bin";
+
+// --bot mcts: search time per tick, the game thread waits for it
+const double MCTS_TICK_BUDGET_MS = 5;
+
+// --alloc-gate: ticks played before measuring, then ticks that must not allocate
+const int GATE_WARMUP_TICKS = 60;
+const int GATE_TICKS = 300;
+
+// --soak: samples taken before this are warmup, growth is measured from the sample at this second
+const int SOAK_WARMUP_SECONDS = 10;
 
 int bonusTimer=0;
 Uint32 bonusStart=0;
 Uint32 bonusDuration=3000;
 
 void capFrameRate(Uint32 startTicks) {
+    TRACE_SCOPE("capFrameRate");
     Uint32 frameTicks = SDL_GetTicks() - startTicks;
     if (frameTicks < SCREEN_TICK_PER_FRAME) {
         SDL_Delay(SCREEN_TICK_PER_FRAME - frameTicks);
     }
 }
 
-// Snake game constants(resources like background, snake texture, homepage images, high scores images)
-const char* BACKGROUND_GAME = "resources/bgS.png";
-const char* HEAD_UP = "resources/headUp.png";
-const char* HEAD_DOWN = "resources/headDown.png";
-const char* HEAD_LEFT = "resources/headLeft.png";
-const char* HEAD_RIGHT = "resources/headRight.png";
-const char* BODY_HORIZONTAL = "resources/bodyHorr.png";
-const char* BODY_VERTICAL = "resources/bodyVert.png";
-const char* TAIL_UP = "resources/tailUp.png";
-const char* TAIL_DOWN = "resources/tailDown.png";
-const char* TAIL_LEFT = "resources/tailLeft.png";
-const char* TAIL_RIGHT = "resources/tailRight.png";
-const char* LEFT_DOWN = "resources/leftDown.png";
-const char* RIGHT_DOWN = "resources/rightDown.png";
-const char* RIGHT_UP = "resources/rightUp.png";
-const char* LEFT_UP = "resources/leftUp.png";
-const char* BACKGROUND_HIGHSCORE = "resources/highBG.png";
-
-// Rendering functions for initialize texture, font, game and load scores from txt file
-int initSDL(SDL_Window **window, SDL_Renderer **renderer);
-SDL_Texture* loadTexture(SDL_Renderer *renderer, const char *filePath);
-SDL_Texture* renderText(SDL_Renderer *renderer, TTF_Font *font, const char *text, SDL_Color color, SDL_Rect *rect);
-void renderInstructions(SDL_Renderer *renderer, SDL_Texture *helpTexture);
+// HUD areas at the bottom, damaged when the numbers change
+const SDL_Rect SCORE_HUD_RECT = {10, 565, 200, 35};
+const SDL_Rect HIGHSCORE_HUD_RECT = {800, 565, 160, 35};
+
+// Rows of the leaderboard on the highscore screen
+const int LEADERBOARD_SHOWN = 10;
+
+// Rendering functions for initialize window, game and load scores from txt file
+int initSDL(SDL_Window **window);
+void renderInstructions(RenderList *list);
 //void runSnakeGame(SDL_Renderer *renderer);
 //void displayHighscore(SDL_Renderer *renderer, TTF_Font *font);
 void loadHighScore(const char *filePath);
-void saveHighScore(const char *filePath);
-
-// Snake game structures
-typedef struct {
-    int x, y;
-    SDL_Texture* texture;
-    SDL_Rect rect;
-} Food;
-
-typedef struct {
-    int x, y;
-    SDL_Texture* texture;
-    SDL_Rect rect;
-} bonusFood;
-
-typedef struct {
-    int x, y;
-    int dx, dy;
-    SDL_Texture* headTexture;
-    SDL_Texture* bodyTexture;
-    SDL_Texture* tailTexture;
-    SDL_Rect segments[100];
-    int directions[100];
-    int length;
-    int score;
-} Snake;
+void loadScores(void);
+void recordScore(Snake* snake, SaveWriter* writer);
+void renderLeaderboard(RenderList* list, SDL_Color color);
 
 // Home page items
-int highScore = 0;
-int selectedMenuItem = 0;  // 0 for START, 1 for INSTRUCTIONS, 2 for HIGH SCORE, 3 for EXIT (START Selected default)
-
-// Function to initialize the snake game
-void initSnake(Snake* snake, SDL_Renderer* renderer);
-void updateSnake(Snake* snake, Food* food);
-void renderSnake(Snake* snake, SDL_Renderer* renderer);
-void handleSnakeEvents(SDL_Event* e, Snake* snake, SDL_Renderer* renderer);
-int isGameOver(Snake* snake);
-void generateFood(Food* food);
-void generateBonusFood(bonusFood* bonus);
-int checkCollision(Snake* snake, Food* food);
-int checkBonusFoodCollision(Snake* snake, bonusFood* bonus);
-void renderFood(Food* food, SDL_Renderer* renderer);
-void renderBonusFood(bonusFood* bonus, SDL_Renderer* renderer) ;
+int highScore = 0;  // Best score on this board size
+Leaderboard leaderboard;
+Autopilot bot;
+HamiltonBot cycleBot;
+Mcts mctsBot;
+HeuristicBot heuristicBot;
+Policy policyBot;
+const int MENU_ITEMS = 5;
+int selectedMenuItem = 0;  // 0 for START, 1 for AUTOPILOT, 2 for INSTRUCTIONS, 3 for HIGH SCORE, 4 for EXIT (START Selected default)
+
+// Snake game events and rendering
+void handleSnakeEvents(SDL_Event* e, InputQueue* input);
+void queueScriptTurn(InputQueue* input, int tick);
+void restartGame(Snake* snake, InputQueue* input, Playfield* playfield, Food* food, RenderList* list);
+void renderFood(Food* food, RenderList* list);
+void renderBonusFood(bonusFood* bonus, RenderList* list) ;
+void renderGameScene(RenderList* list, Playfield* playfield, Snake* snake, Food* food, bonusFood* bonus, int bonusActive, const char* scoreText, const char* highscoreText);
 
 // Game main function
 int main(int argc, char* args[]) {
+    // Start timing before anything else is touched
+    startupBegin();
+
+    // Count allocations and textures, must come before any other SDL call
+    installMemoryCounters();
+
+    // Command line options
+    int startupExit = 0;  // --startup-exit: quit right after the first presented menu frame (used by startup_bench)
+    int software = 0;     // --software: software rendering with partial presentation of the damaged rects
+    int threaded = 1;     // --no-render-thread: replay the render commands on the game thread
+    int allocGate = 0;    // --alloc-gate: headless scripted game, exits with 1 if steady gameplay allocates
+    double soakMinutes = 0;                   // --soak MINUTES: headless scripted games for this long, exits with 1 on memory growth
+    const char* soakFile = "soak.csv";        // --soak-csv FILE: one sample per second
+    int soakMaxGrowthKb = 2048;               // --soak-max-growth-kb N: allowed RSS growth after warmup
+    int autopilotGames = 0;                   // --autopilot GAMES: headless bot games as fast as possible, then a summary
+    int botType = BOT_PATH;                   // --bot path|cycle|mcts|heuristic|policy: which bot plays, path is the default
+    const char* recordFile = NULL;            // --record FILE: append every tick of human games to a training dataset
+    traceThreadName("main");
+    for (int i = 1; i < argc; ++i) {
+        if (strcmp(args[i], "--startup-exit") == 0) {
+            startupExit = 1;
+        } else if (strcmp(args[i], "--software") == 0) {
+            software = 1;
+        } else if (strcmp(args[i], "--no-render-thread") == 0) {
+            threaded = 0;
+        } else if (strcmp(args[i], "--alloc-gate") == 0) {
+            allocGate = 1;
+            software = 1;
+            SDL_setenv("SDL_VIDEODRIVER", "dummy", 0);
+            SDL_setenv("SDL_AUDIODRIVER", "dummy", 0);
+        } else if (strcmp(args[i], "--soak") == 0 && i + 1 < argc) {
+            soakMinutes = atof(args[++i]);
+            software = 1;
+            SDL_setenv("SDL_VIDEODRIVER", "dummy", 0);
+            SDL_setenv("SDL_AUDIODRIVER", "dummy", 0);
+        } else if (strcmp(args[i], "--autopilot") == 0 && i + 1 < argc) {
+            autopilotGames = atoi(args[++i]);
+            software = 1;
+            SDL_setenv("SDL_VIDEODRIVER", "dummy", 0);
+            SDL_setenv("SDL_AUDIODRIVER", "dummy", 0);
+        } else if (strcmp(args[i], "--bot") == 0 && i + 1 < argc) {
+            ++i;
+            botType = strcmp(args[i], "cycle") == 0       ? BOT_CYCLE
+                      : strcmp(args[i], "mcts") == 0      ? BOT_MCTS
+                      : strcmp(args[i], "heuristic") == 0 ? BOT_HEURISTIC
+                      : strcmp(args[i], "policy") == 0    ? BOT_POLICY
+                                                          : BOT_PATH;
+        } else if (strcmp(args[i], "--record") == 0 && i + 1 < argc) {
+            recordFile = args[++i];
+        } else if (strcmp(args[i], "--soak-csv") == 0 && i + 1 < argc) {
+            soakFile = args[++i];
+        } else if (strcmp(args[i], "--soak-max-growth-kb") == 0 && i + 1 < argc) {
+            soakMaxGrowthKb = atoi(args[++i]);
+        } else if (strcmp(args[i], "--trace") == 0) {
+            // --trace [file]: record trace markers, written on exit or with F4
+            const char* traceFile = NULL;
+            if (i + 1 < argc && args[i + 1][0] != '-') {
+                traceFile = args[++i];
+            }
+            traceEnable(traceFile);
+        }
+    }
+
     Uint32 startTicks;
     SDL_Window* window = NULL;
-    SDL_Renderer* renderer = NULL;
-    SDL_Texture* backgroundTexture = NULL;
-    SDL_Texture* gameOverTexture = NULL;
-    SDL_Texture* snakeBigTexture = NULL;
-    SDL_Texture* snakeTreeTexture = NULL;
-    SDL_Texture* startTexture = NULL;
-    SDL_Texture* instructionsTexture = NULL;
-    SDL_Texture* highscoreTexture = NULL;
-    SDL_Texture* exitTexture = NULL;
-    SDL_Texture* helpTexture = NULL;
-    TTF_Font* font = NULL;
-    TTF_Font* gothicFont = NULL;
-    TTF_Font* gothicFontLarge = NULL;
-    TTF_Font* largeFont = NULL;
-
-
-    // ** Music for intro and game(not working due to memory allocation)
-    // // Mix_Music pointers
-    // Mix_Music *menuMusic = NULL;
-    // Mix_Music *gameMusic = NULL;
-
-    // // Initializing SDL_mixer
-    // if (Mix_OpenAudio(44100, MIX_DEFAULT_FORMAT, 2, 2048) < 0){
-    //     printf("SDL_mixer initialization failed! Error: %s\n", Mix_GetError());
-    //     return -1;
-    // }
-
-    // // Load music
-    // menuMusic = Mix_LoadMUS("resources/intro.mp3");
-    // if (!menuMusic){
-    //     printf("Failed to load menu music! Error: %s\n", Mix_GetError());
-    // }
-
-    // gameMusic = Mix_LoadMUS("resources/game.mp3");
-    // if (!gameMusic){
-    //     printf("Failed to load game music! Error: %s\n", Mix_GetError());
-    // }
-
-    // // music by default
-    // if (Mix_PlayMusic(menuMusic, -1) == -1){
-    //     printf("Mix_PlayMusic failed: %s\n", Mix_GetError());
-    // }
+    RenderContext render;
+    AudioSystem audio;
+    MusicPlayer music;
+    SaveWriter saveWriter;
 
 
     // Initializing SDL
-    if (initSDL(&window, &renderer) != 0) {
+    if (initSDL(&window) != 0) {
         return 1;
     }
+    startupMark("initSDL", NULL);
 
-    // Load the high score txt file
-    loadHighScore("resources/highscore.txt");
-
-    // Load textures gameover and front page
-    gameOverTexture = IMG_LoadTexture(renderer, "resources/overBG.png");
-    backgroundTexture = loadTexture(renderer, "resources/bg.png");
-    snakeBigTexture = loadTexture(renderer, "resources/snakeBig1.png");
-    snakeTreeTexture = loadTexture(renderer, "resources/snakeTree.png");
-    helpTexture = loadTexture(renderer, "resources/help.png");
-    if (backgroundTexture == NULL || snakeBigTexture == NULL || snakeTreeTexture == NULL || helpTexture == NULL || gameOverTexture == NULL) {
-        printf("Failed to load texture: %s\n", SDL_GetError());
-        SDL_DestroyRenderer(renderer);
-        SDL_DestroyWindow(window);
-        TTF_Quit();
-        IMG_Quit();
-        SDL_Quit();
-        return 1;
-    }
+    // Load the leaderboard, or the old high score txt file the first time
+    loadScores();
+    startupMark("highscore", "resources/leaderboard.bin");
+
+    // Leaderboard saves go to disk in the background
+    startSaveWriter(&saveWriter);
 
-    // Load font
-    largeFont = TTF_OpenFont("resources/SuperMario.ttf", 80); // larger font for "SNAKE GAME" in home page
-    gothicFont = TTF_OpenFont("resources/gothic.ttf", 22);
-    gothicFontLarge = TTF_OpenFont("resources/gothic.ttf", 40);
-    font = TTF_OpenFont("resources/grobold.ttf", 40);
-    if (font == NULL || largeFont == NULL || gothicFont == NULL || gothicFontLarge == NULL) {
-        printf("Failed to load font! SDL_ttf Error: %s\n", TTF_GetError());
-        SDL_DestroyTexture(backgroundTexture);
-        SDL_DestroyTexture(snakeBigTexture);
-        SDL_DestroyTexture(snakeTreeTexture);
-        SDL_DestroyTexture(helpTexture);
-        SDL_DestroyRenderer(renderer);
+    // Renderer, textures and fonts belong to the render thread
+    if (startRenderContext(&render, window, software, threaded) != 0) {
+        printf("Failed to start rendering: %s\n", SDL_GetError());
+        stopRenderContext(&render);
         SDL_DestroyWindow(window);
         TTF_Quit();
         IMG_Quit();
@@ -191,27 +197,26 @@ int main(int argc, char* args[]) {
         return 1;
     }
 
+    // Sound effects and music load in the background, the game runs silent without an audio device
+    initAudio(&audio);
+    initMusic(&music, &audio);
+    playMusic(&music, MUSIC_MENU);
+
     // Render texts
     SDL_Color textColorWhite = {255, 255, 255}; // white color
     SDL_Color textColorGreen = {121, 175, 107}; // green color
     SDL_Color textColorRed = {255, 0, 0, 255}; // red color
     SDL_Color textColorBlue = {93, 93, 173}; // blue color
+    SDL_Color noColorMod = {255, 255, 255, 255};
 
-    // Render "SNAKE GAME" text in front page
+    // "SNAKE GAME" text position in front page
     SDL_Rect snakeGameRect = {396, 51, 0, 0}; // Adjust position as needed,  currently at right side
-    SDL_Texture* snakeGameTexture = renderText(renderer, largeFont, "SNAKE GAME", textColorBlue, &snakeGameRect);
-    // Options
+    // Options, they slide in from the right
     SDL_Rect startRect = {SCREEN_WIDTH, 140, 0, 0};
-    startTexture = renderText(renderer, font, "START", textColorGreen, &startRect);
-
-    SDL_Rect instructionsRect = {SCREEN_WIDTH, 220, 0, 0};
-    instructionsTexture = renderText(renderer, font, "INSTRUCTIONS", textColorGreen, &instructionsRect);
-
-    SDL_Rect highscoreRect = {SCREEN_WIDTH, 300, 0, 0};
-    highscoreTexture = renderText(renderer, font, "HIGHSCORE", textColorGreen, &highscoreRect);
-
-    SDL_Rect exitRect = {SCREEN_WIDTH, 380, 0, 0};
-    exitTexture = renderText(renderer, font, "EXIT", textColorGreen, &exitRect);
+    SDL_Rect autopilotRect = {SCREEN_WIDTH, 210, 0, 0};
+    SDL_Rect instructionsRect = {SCREEN_WIDTH, 280, 0, 0};
+    SDL_Rect highscoreRect = {SCREEN_WIDTH, 350, 0, 0};
+    SDL_Rect exitRect = {SCREEN_WIDTH, 420, 0, 0};
 
     // Main page loop flags
     int quit = 0;
@@ -228,92 +233,199 @@ int main(int argc, char* args[]) {
     // **Main Snake Game Starts here**
     // Snake game state
     Snake snake;
-    initSnake(&snake, renderer);
+    initSnake(&snake);
+
+    // Turns wait here until the tick that applies them
+    InputQueue input;
+    resetInputQueue(&input, &snake);
+
+    // Background and snake layer, redrawn incrementally every tick
+    Playfield playfield;
+    initPlayfield(&playfield, render.layerSupported);
 
     int bonusActive=0;
 
     // Initialize Food
     Food food;
-    food.texture = loadTexture(renderer, "resources/food.png");
     food.rect.w = 15;  // Food initial position ** Horizontal position (left to right 15px)
     food.rect.h = 15;  // Food initial position ** Vertical position (top to bottom 15px)
+    food.random = 0;   // Placed with rand()
     generateFood(&food);  // Generate normal food
 
     bonusFood bonus;
     bonus.rect.w = rand() % SCREEN_WIDTH;  // Random grid position respect to width
     bonus.rect.h = rand() % SCREEN_HEIGHT; // Random grid position respect to height
-    bonus.texture = loadTexture(renderer, "resources/bonusFood.png");
     generateBonusFood(&bonus);
 
+    // Gameplay HUD text, damaged when it changes
+    char scoreText[50] = "";
+    char highscoreText[50] = "";
+
+    // Scripted runs (allocation gate, soak, autopilot benchmark) start playing right away
+    int soak = soakMinutes > 0;
+    int scripted = allocGate || soak || autopilotGames > 0;
+    int gateTick = 0;
+    int gateFailed = 0;
+    MemStats gateStart;
+    // Autopilot: the bot plays instead of the arrow keys
+    initAutopilot(&bot);
+    initHamiltonBot(&cycleBot);
+    double heuristicWeights[HEURISTIC_FEATURES];
+    memcpy(heuristicWeights, HEURISTIC_DEFAULT_WEIGHTS, sizeof(heuristicWeights));
+    if (botType == BOT_HEURISTIC) {
+        loadHeuristicWeights(TRAINER_CHECKPOINT, heuristicWeights);
+    }
+    initHeuristicBot(&heuristicBot, heuristicWeights);
+    // The search leaves a core for the render thread
+    if (botType == BOT_MCTS && startMcts(&mctsBot, SDL_GetCPUCount() - 1, MCTS_TICK_BUDGET_MS) != 0) {
+        botType = BOT_PATH;
+    }
+    if (botType == BOT_POLICY && loadPolicy(&policyBot, POLICY_FILE, 1) != 0) {
+        botType = BOT_PATH;
+    }
+    int autopilot = autopilotGames > 0;
+    int autopilotPlayed = 0;
+    long autopilotScore = 0;
+    int autopilotBest = 0;
+    double botMs = 0;
+    int botTicks = 0;
+    Uint64 autopilotStart = perfNow();
+
+    // Human games go to the dataset, the writer thread encodes and writes them
+    DatasetRecorder recorder;
+    int recording = recordFile != NULL && !scripted && startRecorder(&recorder, recordFile) == 0;
+
+    if (scripted) {
+        showSnakeGame = 1;
+        resetPlayfield(&playfield, &snake, currentRenderList(&render));
+        resetHamiltonBot(&cycleBot, &snake);
+    }
+
+    // Soak samples, one CSV line per second
+    FILE* soakCsv = NULL;
+    Uint32 soakStart = SDL_GetTicks();
+    int soakSeconds = 0;
+    int soakGames = 1;
+    int soakBaseRssKb = -1;
+    int soakBaseTextures = 0;
+    if (soak) {
+        soakCsv = fopen(soakFile, "w");
+        if (soakCsv == NULL) {
+            printf("Unable to open file %s for writing\n", soakFile);
+            gateFailed = 1;
+            quit = 1;
+        } else {
+            fprintf(soakCsv, "seconds,rss_kb,live_textures,allocs,frees,ticks,games\n");
+        }
+    }
+
+    // Changed screen areas, gameplay frames only repaint and upload these in the software path
+    SDL_Rect lastFoodRect = {0, 0, 0, 0};
+    SDL_Rect lastBonusRect = {0, 0, 0, 0};
+    int wasPlaying = 0;
+
+    // Performance overlay, toggled with F3
+    int showHud = 0;
+    int hudToggled = 0;
+
     // While loop to run full the game
     while (!quit) {
         startTicks = SDL_GetTicks();
+        Uint64 tickStart = perfNow();
+        TRACE_SCOPE("frame");
+        RenderList* list = currentRenderList(&render);
+
         // Handle events on queue
+        Uint64 tracePoll = traceBegin();
         while (SDL_PollEvent(&e) != 0) {
             // User requests quit, pressed ESCAPE
             if (e.type == SDL_QUIT) {
                 quit = 1;
             }
 
+            // Render targets lose their content when the device is reset
+            if (e.type == SDL_RENDER_TARGETS_RESET || e.type == SDL_RENDER_DEVICE_RESET) {
+                resetPlayfield(&playfield, &snake, list);
+            }
+
+            if (e.type == SDL_KEYDOWN && e.key.keysym.sym == SDLK_F3 && !e.key.repeat) {
+                showHud = !showHud;
+                hudToggled = 1;
+            }
+
+            // F4 writes the trace recorded so far, or starts tracing
+            if (e.type == SDL_KEYDOWN && e.key.keysym.sym == SDLK_F4 && !e.key.repeat) {
+                if (traceEnabled()) {
+                    traceDump();
+                } else {
+                    traceEnable(NULL);
+                }
+            }
+
             // Handle key events for menu selection
+            int onMenu = !showSnakeGame && !showInstructions && !showHighscore;
+            if (e.type == SDL_KEYDOWN && onMenu) {
+                switch (e.key.keysym.sym) {
+                    case SDLK_UP:
+                    case SDLK_DOWN:
+                        playSfx(&audio, SFX_SELECT);
+                        break;
+                    case SDLK_RETURN:
+                        playSfx(&audio, SFX_SELECTED);
+                        break;
+                    default:
+                        break;
+                }
+            }
             if (e.type == SDL_KEYDOWN) {
                 switch (e.key.keysym.sym) {
                     case SDLK_UP:  // Move selection up
                         selectedMenuItem--;
                         if (selectedMenuItem < 0) {
-                            selectedMenuItem = 3;  // LIMIT:Wrap around to the last item
+                            selectedMenuItem = MENU_ITEMS - 1;  // LIMIT:Wrap around to the last item
                         }
                         break;
                     case SDLK_DOWN:  // Move selection down
                         selectedMenuItem++;
-                        if (selectedMenuItem > 3) {
+                        if (selectedMenuItem > MENU_ITEMS - 1) {
                             selectedMenuItem = 0;  // LIMIT:Wrap around to the first item
                         }
                         break;
                     case SDLK_RETURN:  // Enter key to select current item
                         switch (selectedMenuItem) {
                             case 0:  // START selected
+                            case 1:  // AUTOPILOT selected, the bot plays demo games until Esc
                                 showSnakeGame = 1;
-                                // Mix_HaltMusic(); // Stop menu music
-                                // if (Mix_PlayMusic(gameMusic, -1) == -1)
-                                // {
-                                //     printf("Failed to play game music: %s\n", Mix_GetError());
-                                // }
-                                initSnake(&snake, renderer);
+                                autopilot = selectedMenuItem == 1;
+                                playMusic(&music, MUSIC_GAME);
+                                initSnake(&snake);
+                                resetInputQueue(&input, &snake);
+                                resetAutopilot(&bot);
+                                resetHamiltonBot(&cycleBot, &snake);
+                                resetPlayfield(&playfield, &snake, list);
                                 generateFood(&food);
                                 break;
-                            case 1:  // INSTRUCTIONS selected
+                            case 2:  // INSTRUCTIONS selected
                                 showInstructions = 1;
                                 break;
-                            case 2:  // HIGH SCORE selected
+                            case 3:  // HIGH SCORE selected
                                 showHighscore = 1;
                                 break;
-                            case 3:  // EXIT selected
+                            case 4:  // EXIT selected
                                 quit = 1;
                                 break;
                             default:
                                 break;
                         }
                         break;
-                    // case SDLK_ESCAPE:
-                    //     if (showSnakeGame)
-                    //     {
-                    //         showSnakeGame = 0;
-                    //         Mix_HaltMusic(); // Stop game music
-                    //         if (Mix_PlayMusic(menuMusic, -1) == -1)
-                    //         {
-                    //             printf("Failed to play menu music: %s\n", Mix_GetError());
-                    //         }
-                    //     }
-                    //     break;
                     default:
                         break;
                 }
             }
 
-            // Handle key events in main game
-            if (showSnakeGame) {
-                handleSnakeEvents(&e, &snake, renderer);
+            // Handle key events in main game, the autopilot ignores the arrows
+            if (showSnakeGame && !autopilot) {
+                handleSnakeEvents(&e, &input);
             }
 
             // Handle ESC key to exit from sub-menus
@@ -322,7 +434,12 @@ int main(int argc, char* args[]) {
                     showInstructions = 0;
                 }
                 if (showSnakeGame) {
+                    if (recording && !gameOver) {
+                        recordQuit(&recorder, &snake);
+                    }
                     showSnakeGame = 0;
+                    autopilot = 0;
+                    playMusic(&music, MUSIC_MENU);
                 }
                 if (showHighscore) {
                     showHighscore = 0;
@@ -331,17 +448,38 @@ int main(int argc, char* args[]) {
             }
         }
 
+        traceEnd("poll events", tracePoll);
+        updateMusic(&music);
+
+        // Menus and other screens repaint everything, gameplay tracks what changed
+        int playing = !showInstructions && showSnakeGame && !gameOver;
+        DamageTracker* damage = &list->damage;
+        if (!playing || !wasPlaying) {
+            damageAddFull(damage);
+        }
+        wasPlaying = playing;
+
+        // The overlay is redrawn every frame, and the area under it repainted once when it's hidden
+        if (showHud || hudToggled) {
+            damageAdd(damage, HUD_RECT);
+            hudToggled = 0;
+        }
+
         // Clear screen to go deeper
-        SDL_RenderClear(renderer);
+        if (!playing) {
+            pushClear(list);
+        }
 
         // Condition to start functions
         if (showInstructions) {
-            renderInstructions(renderer, helpTexture);
+            renderInstructions(list);
         }
         else if (showSnakeGame && !gameOver){
             // Check for collision with food
+            Uint64 traceCollision = traceBegin();
             if (showSnakeGame && checkCollision(&snake, &food)) {
-                snake.length += 2;   // Increase snake's length
+                growSnake(&snake, 2);   // Increase snake's length
+                playSfx(&audio, SFX_EAT);
                 snake.score += 1;    // Increase score when snake eats food
                 generateFood(&food); // Generate new food
             }
@@ -350,6 +488,7 @@ int main(int argc, char* args[]) {
             if (showSnakeGame && bonusActive && checkBonusFoodCollision(&snake, &bonus)) {
                // snake.length += 3; // Uncomment to implement length increment
                 snake.score += 3;
+                playSfx(&audio, SFX_POP);
                 bonusActive = 0;
             }
 
@@ -357,6 +496,7 @@ int main(int argc, char* args[]) {
             if (!bonusActive && snake.score % 10 == 0 && snake.score > 0) //10 point difference
             {
                 bonusActive = 1;
+                playSfx(&audio, SFX_BONUS_TIME);
                 bonusStart = SDL_GetTicks();
             }
 
@@ -369,71 +509,108 @@ int main(int argc, char* args[]) {
                 }
             }
 
+            traceEnd("collision", traceCollision);
+
             // Update snake position and state
+            if (autopilot) {
+                Uint64 botStart = perfNow();
+                if (botType == BOT_CYCLE) {
+                    hamiltonTurn(&cycleBot, &snake, &food, &input);
+                } else if (botType == BOT_MCTS) {
+                    mctsTurn(&mctsBot, &snake, &food, &input);
+                } else if (botType == BOT_HEURISTIC) {
+                    heuristicTurn(&heuristicBot, &snake, &food, &input);
+                } else if (botType == BOT_POLICY) {
+                    policyTurn(&policyBot, &snake, &food, &input);
+                } else {
+                    autopilotTurn(&bot, &snake, &food, &input);
+                }
+                botMs += perfMs(botStart, perfNow());
+                botTicks++;
+            } else if (scripted) {
+                queueScriptTurn(&input, snake.tick);
+            }
+
+            // One queued turn per tick, the frame showing it carries the key press time
+            Uint64 turnTime;
+            if (applyNextTurn(&input, &snake, &turnTime)) {
+                markInputTime(list, turnTime);
+            }
+            SDL_Rect oldTail = snake.segments[snake.length - 1];
+            Uint64 traceUpdate = traceBegin();
+            int scoreBefore = snake.score;
+            if (recording && !autopilot) {
+                recordTick(&recorder, &snake, &food, &bonus, bonusActive);
+            }
             updateSnake(&snake, &food);
+            if (snake.score != scoreBefore) {
+                playSfx(&audio, SFX_EAT);
+            }
+            traceEnd("updateSnake", traceUpdate);
+            updatePlayfield(&playfield, &snake, oldTail, list);
 
-            // Render game background
-            SDL_Texture *gameBackground = loadTexture(renderer, BACKGROUND_GAME);
-            SDL_RenderCopy(renderer, gameBackground, NULL, NULL);
-            SDL_DestroyTexture(gameBackground);
-
-            // Render snake, food, and bonus food (if active)
-            renderSnake(&snake, renderer);
-            renderFood(&food, renderer);
-            if (bonusActive){
-                renderBonusFood(&bonus, renderer);
-            }
-
-            // Render score at the bottom
-            char scoreText[50];
-            sprintf(scoreText, "Score: %d", snake.score);
-            SDL_Rect scoreRect = {10, 565, 0, 0}; // Adjust position as needed
-            SDL_Texture *scoreTexture = renderText(renderer, gothicFont, scoreText, textColorRed, &scoreRect);
-            SDL_RenderCopy(renderer, scoreTexture, NULL, &scoreRect);
-            SDL_DestroyTexture(scoreTexture);
-
-            // Render high score
-            char highscoreText[50];
-            sprintf(highscoreText, "Highscore: %d", highScore);
-            SDL_Rect highscoreTextRect = {800, 565, 0, 0}; // Example position
-            SDL_Texture *highscoreTextTexture = renderText(renderer, gothicFont, highscoreText, textColorRed, &highscoreTextRect);
-            SDL_RenderCopy(renderer, highscoreTextTexture, NULL, &highscoreTextRect);
-            SDL_DestroyTexture(highscoreTextTexture);
+            // Food and bonus food damage where they were and where they are now
+            SDL_Rect foodRect = {food.x, food.y, food.rect.w, food.rect.h};
+            SDL_Rect bonusRect = {0, 0, 0, 0};
+            if (bonusActive) {
+                bonusRect = bonus.rect;
+            }
+            damageTrackRect(damage, &lastFoodRect, foodRect);
+            damageTrackRect(damage, &lastBonusRect, bonusRect);
+
+            // Score and high score at the bottom
+            Uint64 traceHud = traceBegin();
+            char hudText[50];
+            sprintf(hudText, "Score: %d", snake.score);
+            if (strcmp(hudText, scoreText) != 0) {
+                strcpy(scoreText, hudText);
+                damageAdd(damage, SCORE_HUD_RECT);
+            }
+            sprintf(hudText, "Highscore: %d", highScore);
+            if (strcmp(hudText, highscoreText) != 0) {
+                strcpy(highscoreText, hudText);
+                damageAdd(damage, HIGHSCORE_HUD_RECT);
+            }
+            traceEnd("hud text", traceHud);
+
+            // Render game background and snake, food, bonus food and score, only inside the damaged rects when possible
+            if (!render.softwarePresent || damage->full) {
+                pushClear(list);
+                renderGameScene(list, &playfield, &snake, &food, &bonus, bonusActive, scoreText, highscoreText);
+            } else {
+                for (int i = 0; i < damage->count; ++i) {
+                    pushClip(list, &damage->rects[i]);
+                    renderGameScene(list, &playfield, &snake, &food, &bonus, bonusActive, scoreText, highscoreText);
+                }
+                pushClip(list, NULL);
+            }
         }
         else if (showHighscore) {
             // Render highscore background
-            SDL_Texture* highscoreBackground = loadTexture(renderer, BACKGROUND_HIGHSCORE);
-            SDL_RenderCopy(renderer, highscoreBackground, NULL, NULL);
-            SDL_DestroyTexture(highscoreBackground);
+            pushCopy(list, TEX_HIGHSCORE_BG, NULL, NULL);
 
             // Render highscore text
-            char highscoreText[50];
-            sprintf(highscoreText, "Highscore: %d", highScore);
-            SDL_Rect highscoreTextRect = {350, 280, 0, 0}; // Example position
-            SDL_Texture* highscoreTextTexture = renderText(renderer, font, highscoreText, textColorRed, &highscoreTextRect);
-            SDL_RenderCopy(renderer, highscoreTextTexture, NULL, &highscoreTextRect);
-            SDL_DestroyTexture(highscoreTextTexture);
+            char highscoreScreenText[50];
+            sprintf(highscoreScreenText, "Highscore: %d", highScore);
+            pushText(list, TEXT_HIGHSCORE_SCREEN, FONT_MENU, highscoreScreenText, textColorRed, 350, 100, noColorMod);
+            renderLeaderboard(list, textColorBlue);
         }
         else {
             // Render main menu
-            SDL_RenderCopy(renderer, backgroundTexture, NULL, NULL);
-
-            // Render menu items
-            SDL_Rect menuRect = {SCREEN_WIDTH, 140, 0, 0};
-            SDL_Texture* menuTextures[4] = {startTexture, instructionsTexture, highscoreTexture, exitTexture};
+            pushCopy(list, TEX_MENU_BG, NULL, NULL);
 
-            for (int i = 0; i < 4; ++i) {
-                menuRect.y = 140 + i * 80;  // Adjust vertical spacing as needed
+            // Menu item colors
+            SDL_Color menuMods[MENU_ITEMS];
+            for (int i = 0; i < MENU_ITEMS; ++i) {
                 if (i == selectedMenuItem) {
                     // Highlight selected item
-                    SDL_SetTextureColorMod(menuTextures[i], 85, 104, 42);  // Green color for selected item
-                    SDL_SetTextureAlphaMod(menuTextures[i], 255);  // Full opacity for selected item
+                    SDL_Color selectedMod = {85, 104, 42, 255};  // Green color, full opacity for selected item
+                    menuMods[i] = selectedMod;
                 } else {
                     // Normal color for other items
-                    SDL_SetTextureColorMod(menuTextures[i], 121, 130, 59);  // Light green color
-                    SDL_SetTextureAlphaMod(menuTextures[i], 128);  // Semi-transparent for other items
+                    SDL_Color normalMod = {121, 130, 59, 128};  // Light green color, semi-transparent for other items
+                    menuMods[i] = normalMod;
                 }
-                SDL_RenderCopy(renderer, menuTextures[i], NULL, &menuRect);
             }
 
             // Render snakeBig texture gradually
@@ -441,77 +618,192 @@ int main(int argc, char* args[]) {
                 snakeBigPosX += 42; // Adjust speed as needed, 2px ahead beacause of 1st item
             }
             SDL_Rect snakeBigRect = {snakeBigPosX, 0, SCREEN_WIDTH, SCREEN_HEIGHT};
-            SDL_RenderCopy(renderer, snakeBigTexture, NULL, &snakeBigRect);
+            pushCopy(list, TEX_SNAKE_BIG, NULL, &snakeBigRect);
 
             // Render snakeTree texture gradually
             if (snakeTreePosX < 0) {
             snakeTreePosX += 40;  // Adjust speed as needed
             }
             SDL_Rect snakeTreeRect = {snakeTreePosX, 0, SCREEN_WIDTH, SCREEN_HEIGHT};
-            SDL_RenderCopy(renderer, snakeTreeTexture, NULL, &snakeTreeRect);
+            pushCopy(list, TEX_SNAKE_TREE, NULL, &snakeTreeRect);
 
             // Move and render texts sequentially
             if (startRect.x > 622) {
             startRect.x -= 37;  // Adjust speed as needed
             }
-            SDL_RenderCopy(renderer, startTexture, NULL, &startRect);
+            pushText(list, TEXT_START, FONT_MENU, "START", textColorGreen, startRect.x, startRect.y, menuMods[0]);
+
+            if (autopilotRect.x > 570) {
+            autopilotRect.x -= 36;  // Adjust speed as needed
+            }
+            pushText(list, TEXT_AUTOPILOT, FONT_MENU, "AUTOPILOT", textColorGreen, autopilotRect.x, autopilotRect.y, menuMods[1]);
 
             if (instructionsRect.x > 550) {
             instructionsRect.x -= 36;  // Adjust speed as needed
             }
-            SDL_RenderCopy(renderer, instructionsTexture, NULL, &instructionsRect);
+            pushText(list, TEXT_INSTRUCTIONS, FONT_MENU, "INSTRUCTIONS", textColorGreen, instructionsRect.x, instructionsRect.y, menuMods[2]);
 
             if (highscoreRect.x > 570) {
             highscoreRect.x -= 35;  // Adjust speed as needed
             }
-            SDL_RenderCopy(renderer, highscoreTexture, NULL, &highscoreRect);
+            pushText(list, TEXT_HIGHSCORE, FONT_MENU, "HIGHSCORE", textColorGreen, highscoreRect.x, highscoreRect.y, menuMods[3]);
 
             if (exitRect.x > 640) {
             exitRect.x -= 34;  // Adjust speed as needed
             }
-            SDL_RenderCopy(renderer, exitTexture, NULL, &exitRect);
+            pushText(list, TEXT_EXIT, FONT_MENU, "EXIT", textColorGreen, exitRect.x, exitRect.y, menuMods[4]);
 
             // Render big text "SNAKE GAME" on top of "START" option
-            SDL_RenderCopy(renderer, snakeGameTexture, NULL, &snakeGameRect);
+            pushText(list, TEXT_TITLE, FONT_TITLE, "SNAKE GAME", textColorBlue, snakeGameRect.x, snakeGameRect.y, noColorMod);
         }
 
-        // Update screen
-        SDL_RenderPresent(renderer);
+        // Update screen, the render thread presents the frame
+        list->showHud = showHud;
+        list->tickMs = perfMs(tickStart, perfNow());
+        Uint64 traceSubmit = traceBegin();
+        submitRenderList(&render);
+        traceEnd("submit", traceSubmit);
+
+        // Allocation gate: count everything between warmup and the end, the render thread must be done with both ends
+        if (allocGate && showSnakeGame && !gameOver) {
+            gateTick++;
+            if (gateTick == GATE_WARMUP_TICKS) {
+                finishRenderLists(&render);
+                memStatsSnapshot(&gateStart);
+            } else if (gateTick == GATE_WARMUP_TICKS + GATE_TICKS) {
+                finishRenderLists(&render);
+                MemStats gateEnd;
+                MemStats delta;
+                memStatsSnapshot(&gateEnd);
+                memStatsDelta(&gateStart, &gateEnd, &delta);
+                printf("Alloc gate: %d ticks, %d allocations (%s), %d frees, %d textures created, %d destroyed, %d text renders\n",
+                       GATE_TICKS, delta.allocs, MEMSTATS_COUNTS_CRT ? "SDL and CRT" : "SDL only", delta.frees,
+                       delta.texturesCreated, delta.texturesDestroyed, delta.textRenders);
+                gateFailed = delta.allocs != 0 || delta.texturesCreated != 0 || delta.textRenders != 0;
+                printf("Alloc gate: %s\n", gateFailed ? "FAIL" : "PASS");
+                quit = 1;
+            }
+        }
 
-        // Cap for frame rate
-        capFrameRate(startTicks);
+        // Startup ends with the first presented menu frame
+        if (startupExit && renderFramesPresented(&render) > 0) {
+            quit = 1;
+        }
 
-        // Check game over condition
-        if (showSnakeGame && isGameOver(&snake)) {
+        // Soak: sample memory once a second, stop when the time is up
+        if (soakCsv != NULL && SDL_GetTicks() - soakStart >= (Uint32)(soakSeconds + 1) * 1000) {
+            soakSeconds++;
+            MemStats stats;
+            memStatsSnapshot(&stats);
+            int rssKb = currentRssKb();
+            int textures = liveTextureCount();
+            fprintf(soakCsv, "%d,%d,%d,%d,%d,%d,%d\n", soakSeconds, rssKb, textures, stats.allocs, stats.frees, snake.tick, soakGames);
+            fflush(soakCsv);
+            if (soakSeconds == SOAK_WARMUP_SECONDS || (soakBaseRssKb < 0 && soakSeconds >= soakMinutes * 60)) {
+                soakBaseRssKb = rssKb;
+                soakBaseTextures = textures;
+            }
+            if (soakSeconds >= soakMinutes * 60) {
+                int growthKb = rssKb - soakBaseRssKb;
+                gateFailed = growthKb > soakMaxGrowthKb || textures > soakBaseTextures;
+                printf("Soak: %d s, %d games, RSS %d KB (%+d KB after warmup, limit %d KB), live textures %d (%+d)\n",
+                       soakSeconds, soakGames, rssKb, growthKb, soakMaxGrowthKb, textures, textures - soakBaseTextures);
+                printf("Soak: %s, samples in %s\n", gateFailed ? "FAIL" : "PASS", soakFile);
+                quit = 1;
+            }
+        }
+
+        // Cap for frame rate, the allocation gate and the autopilot benchmark run as fast as they can
+        if (!allocGate && !autopilotGames) {
+            capFrameRate(startTicks);
+        }
+
+        // Check game over condition, autopilot games also end when they run long
+        int demoOver = autopilot && snake.tick >= AUTOPILOT_GAME_TICKS;
+        if (showSnakeGame && (isGameOver(&snake) || demoOver)) {
             gameOver = 1;
+            playSfx(&audio, SFX_DIE);
+            playMusic(&music, MUSIC_OVER);
+            if (allocGate) {
+                printf("Alloc gate: FAIL, the scripted game ended at tick %d\n", gateTick);
+                gateFailed = 1;
+                break;
+            }
 
-            if (snake.score > highScore) {
-                highScore = snake.score;
-                saveHighScore("resources/highscore.txt");
+            // Scripted and bot games don't touch the real high score
+            if (!scripted && !autopilot) {
+                recordScore(&snake, &saveWriter);
+                if (recording) {
+                    recordGameOver(&recorder, &snake);
+                }
             }
 
-            printf("Game Over! Length of snake: %d\n", snake.length);
-            printf("Your score: %d\n", snake.score);  // Print final score in terminal
+            if (autopilot) {
+                autopilotPlayed++;
+                autopilotScore += snake.score;
+                if (snake.score > autopilotBest) {
+                    autopilotBest = snake.score;
+                }
+            }
+            if (autopilotGames > 0 && autopilotPlayed >= autopilotGames) {
+                double seconds = perfMs(autopilotStart, perfNow()) / 1000.0;
+                printf("Autopilot: %d games, mean score %.1f, best %d, %.0f ticks/s, bot %.2f us/tick, ",
+                       autopilotPlayed, (double)autopilotScore / autopilotPlayed, autopilotBest, botTicks / seconds,
+                       botMs * 1000.0 / botTicks);
+                if (botType == BOT_CYCLE) {
+                    printf("%d cycle skips in %d ticks\n", cycleBot.skips, cycleBot.decisions);
+                } else if (botType == BOT_MCTS) {
+                    printf("%.0f simulations per tick on %d threads\n", (double)mctsBot.simulations / mctsBot.decisions,
+                           mctsBot.threads);
+                } else if (botType == BOT_HEURISTIC) {
+                    printf("weights %.4f %.4f %.4f %.4f\n", heuristicBot.weights[FEATURE_FOOD],
+                           heuristicBot.weights[FEATURE_SPACE], heuristicBot.weights[FEATURE_TAIL],
+                           heuristicBot.weights[FEATURE_WALL]);
+                } else if (botType == BOT_POLICY) {
+                    printf("%.1f us per inference, %s kernels\n", policyBot.runMs * 1000.0 / policyBot.runs,
+                           policyBot.kernels == POLICY_AVX2 ? "avx2" : policyBot.kernels == POLICY_SSE2 ? "sse2" : "scalar");
+                } else {
+                    printf("%d field rebuilds in %d ticks\n", bot.rebuilds, bot.decisions);
+                }
+                break;
+            }
+            if (autopilotGames == 0) {
+                printf("Game Over! Length of snake: %d\n", snake.length);
+                printf("Your score: %d\n", snake.score);  // Print final score in terminal
+            }
 
-            SDL_Delay(1000); // Game over screen loading 1sec delay, multiply it for to increase seconds
+            if (!soak && !autopilotGames) {
+                SDL_Delay(1000); // Game over screen loading 1sec delay, multiply it for to increase seconds
+            }
 
             // Remove snake game from screen
-            SDL_RenderClear(renderer);
-            SDL_RenderCopy(renderer, gameOverTexture, NULL, NULL);
+            list = currentRenderList(&render);
+            pushClear(list);
+            pushCopy(list, TEX_GAME_OVER, NULL, NULL);
 
             // Render the score on the game over screen
-            char scoreText[50];
-            sprintf(scoreText, "Score: %d", snake.score);
-            SDL_Rect gameOverScoreRect = {390, 255, 0, 0}; // Adjust position as needed
-            SDL_Texture* gameOverScoreTexture = renderText(renderer, gothicFontLarge, scoreText, textColorWhite, &gameOverScoreRect);
-            SDL_RenderCopy(renderer, gameOverScoreTexture, NULL, &gameOverScoreRect);
-            SDL_DestroyTexture(gameOverScoreTexture);
-
-            SDL_RenderPresent(renderer);
+            char gameOverText[50];
+            sprintf(gameOverText, "Score: %d", snake.score);
+            pushText(list, TEXT_GAME_OVER_SCORE, FONT_GOTHIC_LARGE, gameOverText, textColorWhite, 390, 255, noColorMod); // Adjust position as needed
+
+            damageAddFull(&list->damage);
+            submitRenderList(&render);
+
+            // Soak and autopilot games restart right away
+            if (soak || autopilot) {
+                gameOver = 0;
+                soakGames++;
+                restartGame(&snake, &input, &playfield, &food, currentRenderList(&render));
+                resetAutopilot(&bot);
+                resetHamiltonBot(&cycleBot, &snake);
+                playMusic(&music, MUSIC_GAME);
+            }
 
             // Enter or Esc key to restart the game
-            int gameOverHandled = 0;
+            int gameOverHandled = soak || autopilot;
             while (!gameOverHandled) {
+                updateMusic(&music);
+                SDL_Delay(10);
                 while (SDL_PollEvent(&e)) {
                     if (e.type == SDL_QUIT) {
                         quit = 1;
@@ -522,8 +814,8 @@ int main(int argc, char* args[]) {
                             gameOverHandled = 1;
                             gameOver = 0;
                             // Reset the snake for a new game
-                            initSnake(&snake, renderer);
-                            generateFood(&food); // Generate new food -> the next game
+                            restartGame(&snake, &input, &playfield, &food, currentRenderList(&render));
+                            playMusic(&music, MUSIC_GAME);
                             SDL_Delay(100); // Delay 0.1sec before restarting
                         }
                     }
@@ -534,36 +826,39 @@ int main(int argc, char* args[]) {
     }
 
     // Free resources and close SDL
-    // Mix_FreeMusic(menuMusic);
-    // Mix_FreeMusic(gameMusic);
-    // Mix_CloseAudio();
-    SDL_DestroyTexture(gameOverTexture);
-    SDL_DestroyTexture(backgroundTexture);
-    SDL_DestroyTexture(snakeBigTexture);
-    SDL_DestroyTexture(snakeTreeTexture);
-    SDL_DestroyTexture(startTexture);
-    SDL_DestroyTexture(instructionsTexture);
-    SDL_DestroyTexture(highscoreTexture);
-    SDL_DestroyTexture(exitTexture);
-    SDL_DestroyTexture(helpTexture);
-    SDL_DestroyTexture(snakeGameTexture);
-    TTF_CloseFont(largeFont);
-    TTF_CloseFont(font);
-    TTF_CloseFont(gothicFont);
-    TTF_CloseFont(gothicFontLarge);
-    SDL_DestroyRenderer(renderer);
+    if (botType == BOT_MCTS) {
+        stopMcts(&mctsBot);
+    }
+    if (botType == BOT_POLICY) {
+        freePolicy(&policyBot);
+    }
+    if (recording) {
+        stopRecorder(&recorder, &snake);
+    }
+    stopSaveWriter(&saveWriter);
+    closeMusic(&music);
+    closeAudio(&audio);
+    reportLatency("SFX latency (event -> audible)", &audio.latency);
+    if (soakCsv != NULL) {
+        fclose(soakCsv);
+    }
+    stopRenderContext(&render);
+    reportLatency("Input latency (key -> present)", &render.inputLatency);
+    if (traceEnabled()) {
+        traceDump();
+    }
     SDL_DestroyWindow(window);
     TTF_Quit();
     IMG_Quit();
     SDL_Quit();
 
-    return 0;
+    return gateFailed;
 }
 // ** Main game ends here **
 
 // Functions for full game is here
-// Function to initialize SDL and create window and renderer
-int initSDL(SDL_Window **window, SDL_Renderer **renderer) {
+// Function to initialize SDL and create window, the renderer is created by the render context
+int initSDL(SDL_Window **window) {
     // Initialize SDL
     if (SDL_Init(SDL_INIT_VIDEO) < 0) {
         printf("Function:initSDL, SDL_init failed,Error: %s\n", SDL_GetError());
@@ -577,13 +872,6 @@ int initSDL(SDL_Window **window, SDL_Renderer **renderer) {
         return 1;
     }
 
-    // Create renderer for window
-    *renderer = SDL_CreateRenderer(*window, -1, SDL_RENDERER_ACCELERATED);
-    if (*renderer == NULL) {
-        printf("Function:initSDL, SDL_createRenderer failed,Error: %s\n", SDL_GetError());
-        return 1;
-    }
-
     // Initialize SDL_image
     int imgFlags = IMG_INIT_PNG;
     if (!(IMG_Init(imgFlags) & imgFlags)) {
@@ -600,219 +888,49 @@ int initSDL(SDL_Window **window, SDL_Renderer **renderer) {
     return 0;
 }
 
-// Function to load texture from file
-SDL_Texture* loadTexture(SDL_Renderer *renderer, const char *filePath) {
-    // Load image
-    SDL_Surface* surface = IMG_Load(filePath);
-    if (surface == NULL) {
-        printf("Function:loadTexture, Surface image loading failed %s! Error: %s\n", filePath, IMG_GetError());
-        return NULL;
-    }
-
-    // Create texture from surface pixels
-    SDL_Texture* texture = SDL_CreateTextureFromSurface(renderer, surface);
-    if (texture == NULL) {
-        printf("Function:loadTexture, Texture creation failed %s! Error: %s\n", filePath, SDL_GetError());
-    }
-
-    // Free loaded surface
-    SDL_FreeSurface(surface);
-
-    return texture;
-}
-
-// Function to render text using SDL_ttf
-SDL_Texture* renderText(SDL_Renderer *renderer, TTF_Font *font, const char *text, SDL_Color color, SDL_Rect *rect) {
-    // Render text surface
-    SDL_Surface* surface = TTF_RenderText_Solid(font, text, color);
-    if (surface == NULL) {
-        printf("Function:renderText, Surface creation failed,Error: %s\n", TTF_GetError());
-        return NULL;
-    }
-
-    // Create texture from surface pixels
-    SDL_Texture* texture = SDL_CreateTextureFromSurface(renderer, surface);
-    if (texture == NULL) {
-        printf("Function:renderText, texture creation failed, Error: %s\n", SDL_GetError());
-    }
-
-    // Get width and height of surface
-    rect->w = surface->w;
-    rect->h = surface->h;
-
-    // Free surface
-    SDL_FreeSurface(surface);
-
-    return texture;
-}
-
-// Function to render instructions
-void renderInstructions(SDL_Renderer *renderer, SDL_Texture *helpTexture) {
-    // Clear screen
-    SDL_RenderClear(renderer);
-
+// Function to render instructions, the main loop clears and presents the screen
+void renderInstructions(RenderList *list) {
     // Render help texture
-    SDL_RenderCopy(renderer, helpTexture, NULL, NULL);
-
-    // Update screen
-    SDL_RenderPresent(renderer);
+    pushCopy(list, TEX_HELP, NULL, NULL);
 }
 
-// Snake game state initialization
-void initSnake(Snake* snake, SDL_Renderer* renderer) {
-    // Initialize snake starting position and direction
-    snake->x = SCREEN_WIDTH/2;
-    snake->y = SCREEN_HEIGHT/2;
-    snake->dx = 10;
-    snake->dy = 0;
-    snake->length = 10;
-    snake->score = 0;
-
-    // Load textures
-    snake->headTexture = loadTexture(renderer, HEAD_RIGHT);
-    snake->bodyTexture = loadTexture(renderer, BODY_HORIZONTAL);
-    snake->tailTexture = loadTexture(renderer, TAIL_RIGHT);
-
-    // Initialize segments
-    for (int i = 0; i < snake->length; ++i) {
-        snake->segments[i].x = snake->x - i * 15;
-        snake->segments[i].y = snake->y;
-        snake->segments[i].w = 15;
-        snake->segments[i].h = 13;
-        snake->directions[i] = 0; // Initialize all directions to 0
-    }
+// Reset the snake for a new game
+void restartGame(Snake* snake, InputQueue* input, Playfield* playfield, Food* food, RenderList* list) {
+    initSnake(snake);
+    resetInputQueue(input, snake);
+    resetPlayfield(playfield, snake, list);
+    generateFood(food); // Generate new food -> the next game
 }
 
-// Snake game update logic
-void updateSnake(Snake* snake, Food* food) {
-    // Update the position of each segment
-    for (int i = snake->length - 1; i > 0; --i) {
-        snake->segments[i] = snake->segments[i - 1];
-        snake->directions[i] = snake->directions[i - 1]; // Update direction
-    }
-    // Update head position based on direction
-    snake->segments[0].x += snake->dx;
-    snake->segments[0].y += snake->dy;
-
-    if (snake->dx > 0) {
-        snake->directions[0] = 1; // Moving right
-    } else if (snake->dx < 0) {
-        snake->directions[0] = 2; // Moving left
-    } else if (snake->dy > 0) {
-        snake->directions[0] = 3; // Moving down
-    } else if (snake->dy < 0) {
-        snake->directions[0] = 4; // Moving up
+// Scripted turns for --alloc-gate and --soak: the head runs an 80 cell rectangle (30 right, 10 down, 30 left, 10 up),
+// in a soak the snake outgrows it after enough food and the game restarts
+void queueScriptTurn(InputQueue* input, int tick) {
+    switch (tick % 80) {
+        case 0:  queueTurn(input, 10, 0, 0); break;
+        case 30: queueTurn(input, 0, 10, 0); break;
+        case 40: queueTurn(input, -10, 0, 0); break;
+        case 70: queueTurn(input, 0, -10, 0); break;
+        default: break;
     }
-
-    // Check if snake eats food
-    if (checkCollision(snake, food)) {
-        snake->length += 1;  // Increase snake's length
-        snake->score += 1;
-        generateFood(food);  // Generate new food
-    }
-}
-
-// ** Caution: COMPLEX LOGIC ** ANY CHANGE WILL COST SEVERE DAMAGE TO THE SNAKE BODY :)
-// Snake game rendering logic
-void renderSnake(Snake* snake, SDL_Renderer* renderer) {
-    // Render snake head
-    SDL_Rect headRect = {snake->segments[0].x, snake->segments[0].y, 15, 13};
-    SDL_RenderCopy(renderer, snake->headTexture, NULL, &headRect);
-
-    // Render snake body segments with joints
-    for (int i = 1; i < snake->length - 1; ++i) {
-        SDL_Rect segmentRect = {snake->segments[i].x, snake->segments[i].y, 15, 13};
-
-        // Determine texture based on direction changes
-        if ((snake->segments[i].y > snake->segments[i - 1].y && snake->segments[i].x == snake->segments[i - 1].x && snake->segments[i].x > snake->segments[i + 1].x && snake->segments[i].y == snake->segments[i + 1].y)
-            || (snake->segments[i].y == snake->segments[i - 1].y && snake->segments[i].x > snake->segments[i - 1].x && snake->segments[i].x == snake->segments[i + 1].x && snake->segments[i].y > snake->segments[i + 1].y)) {
-            SDL_Texture* jointTexture = loadTexture(renderer, RIGHT_UP);
-            SDL_RenderCopy(renderer, jointTexture, NULL, &segmentRect);
-            SDL_DestroyTexture(jointTexture);
-        } else if ((snake->segments[i].y > snake->segments[i - 1].y && snake->segments[i].x == snake->segments[i - 1].x && snake->segments[i].x < snake->segments[i + 1].x && snake->segments[i].y == snake->segments[i + 1].y)
-            || (snake->segments[i].y == snake->segments[i - 1].y && snake->segments[i].x < snake->segments[i - 1].x && snake->segments[i].x == snake->segments[i + 1].x && snake->segments[i].y > snake->segments[i + 1].y)) {
-            SDL_Texture* jointTexture = loadTexture(renderer, LEFT_UP);
-            SDL_RenderCopy(renderer, jointTexture, NULL, &segmentRect);
-            SDL_DestroyTexture(jointTexture);
-        } else if ((snake->segments[i].y < snake->segments[i - 1].y && snake->segments[i].x == snake->segments[i - 1].x && snake->segments[i].x > snake->segments[i + 1].x && snake->segments[i].y == snake->segments[i + 1].y)
-            || (snake->segments[i].y == snake->segments[i - 1].y && snake->segments[i].x > snake->segments[i - 1].x && snake->segments[i].x == snake->segments[i + 1].x && snake->segments[i].y < snake->segments[i + 1].y)) {
-            SDL_Texture* jointTexture = loadTexture(renderer, RIGHT_DOWN);
-            SDL_RenderCopy(renderer, jointTexture, NULL, &segmentRect);
-            SDL_DestroyTexture(jointTexture);
-        } else if ((snake->segments[i].y < snake->segments[i - 1].y && snake->segments[i].x == snake->segments[i - 1].x && snake->segments[i].x < snake->segments[i + 1].x && snake->segments[i].y == snake->segments[i + 1].y)
-            || (snake->segments[i].y == snake->segments[i - 1].y && snake->segments[i].x < snake->segments[i - 1].x && snake->segments[i].x == snake->segments[i + 1].x && snake->segments[i].y < snake->segments[i + 1].y)) {
-            SDL_Texture* jointTexture = loadTexture(renderer, LEFT_DOWN);
-            SDL_RenderCopy(renderer, jointTexture, NULL, &segmentRect);
-            SDL_DestroyTexture(jointTexture);
-        } else {
-            // Render snake body segments
-            SDL_Rect bodyRect = {snake->segments[i].x, snake->segments[i].y, 15, 13}; // Adjust size as needed
-            if (snake->segments[i].x == snake->segments[i - 1].x) {
-                SDL_RenderCopy(renderer, loadTexture(renderer, BODY_VERTICAL), NULL, &bodyRect);
-            } else {
-                SDL_RenderCopy(renderer, loadTexture(renderer, BODY_HORIZONTAL), NULL, &bodyRect);
-            }
-        }
-    }
-
-    SDL_Texture* tailTexture = NULL;
-    // Determine and render the tail texture based on the direction of the last segment
-    int tailIdx = snake->length - 1;
-    if (snake->segments[tailIdx].x > snake->segments[tailIdx - 1].x) {
-        snake->tailTexture = loadTexture(renderer, TAIL_LEFT);
-    } else if (snake->segments[tailIdx].x < snake->segments[tailIdx - 1].x) {
-        snake->tailTexture = loadTexture(renderer, TAIL_RIGHT);
-    } else if (snake->segments[tailIdx].y > snake->segments[tailIdx - 1].y) {
-        snake->tailTexture = loadTexture(renderer, TAIL_UP);
-    } else if (snake->segments[tailIdx].y < snake->segments[tailIdx - 1].y) {
-        snake->tailTexture = loadTexture(renderer, TAIL_DOWN);
-    }
-
-    // Render the tail
-    SDL_RenderCopy(renderer, snake->tailTexture, NULL, &snake->segments[tailIdx]);
-    SDL_DestroyTexture(tailTexture);
 }
 
-// Handle snake game events
-void handleSnakeEvents(SDL_Event* e, Snake* snake, SDL_Renderer* renderer) {
+// Handle snake game events, turns are queued with the time of the key press
+void handleSnakeEvents(SDL_Event* e, InputQueue* input) {
     // Handle key press events for snake direction
-    if (e->type == SDL_KEYDOWN) {
+    if (e->type == SDL_KEYDOWN && !e->key.repeat) {
+        Uint64 time = eventTime(e->key.timestamp);
         switch (e->key.keysym.sym) {
             case SDLK_UP:
-                if (snake->dy == 0) {
-                    snake->dx = 0;
-                    snake->dy = -10; // Adjust movement speed as needed
-                    snake->headTexture = loadTexture(renderer, HEAD_UP);
-                    snake->bodyTexture = loadTexture(renderer, BODY_VERTICAL);
-                    snake->tailTexture = loadTexture(renderer, TAIL_UP);
-                }
+                queueTurn(input, 0, -10, time); // Adjust movement speed as needed
                 break;
             case SDLK_DOWN:
-                if (snake->dy == 0) {
-                    snake->dx = 0;
-                    snake->dy = 10; // Adjust movement speed as needed
-                    snake->headTexture = loadTexture(renderer, HEAD_DOWN);
-                    snake->bodyTexture = loadTexture(renderer, BODY_VERTICAL);
-                    snake->tailTexture = loadTexture(renderer, TAIL_DOWN);
-                }
+                queueTurn(input, 0, 10, time);
                 break;
             case SDLK_LEFT:
-                if (snake->dx == 0) {
-                    snake->dx = -10; // Adjust movement speed as needed
-                    snake->dy = 0;
-                    snake->headTexture = loadTexture(renderer, HEAD_LEFT);
-                    snake->bodyTexture = loadTexture(renderer, BODY_HORIZONTAL);
-                    snake->tailTexture = loadTexture(renderer, TAIL_LEFT);
-                }
+                queueTurn(input, -10, 0, time);
                 break;
             case SDLK_RIGHT:
-                if (snake->dx == 0) {
-                    snake->dx = 10; // Adjust movement speed as needed
-                    snake->dy = 0;
-                    snake->headTexture = loadTexture(renderer, HEAD_RIGHT);
-                    snake->bodyTexture = loadTexture(renderer, BODY_HORIZONTAL);
-                    snake->tailTexture = loadTexture(renderer, TAIL_RIGHT);
-                }
+                queueTurn(input, 10, 0, time);
                 break;
             default:
                 break;
@@ -820,79 +938,29 @@ void handleSnakeEvents(SDL_Event* e, Snake* snake, SDL_Renderer* renderer) {
     }
 }
 
-// Check if game over (e.g., snake hits boundary or itself)
-int isGameOver(Snake* snake) {
-    // Implement game over conditions
-    // Condition 1: hitting screen boundary
-    if (snake->segments[0].x < 15 || snake->segments[0].x >= 929 || snake->segments[0].y < 15 || snake->segments[0].y >= 529) {
-        return 1;
-    }
-    // Condition 2: hitting itself (for loop through snake segments)
-    for (int i = 1; i < snake->length; ++i) {
-        if (snake->segments[0].x == snake->segments[i].x && snake->segments[0].y == snake->segments[i].y) {
-            return 1;
-        }
-    }
-    return 0;
-}
-
-// Generate random positions for food within the game screen
-void generateFood(Food* food) {
-    food->x = 16 + rand() % (928 - 16 - food->rect.w);  // Adjusted for x-axis within the specified range
-    food->y = 16 + rand() % (528 - 16 - food->rect.h);  // Adjusted for y-axis within the specified range
-    // Food generation grid
-    food->x -= food->x % 10;
-    food->y -= food->y % 10;
-}
-
-// Generate random positions for bonus food within the game screen
-void generateBonusFood(bonusFood* bonus) {
-    bonus->x = 16 + rand() % (928 - 16 - bonus->rect.w); // x-axis range
-    bonus->y = 16 + rand() % (528 - 16 - bonus->rect.h); // y-axis range
-
-    // Bonus food generation grid
-    bonus->x -= bonus->x % 10;
-    bonus->y -= bonus->y % 10;
-
-    bonus->rect.w = 15; // Image width
-    bonus->rect.h = 15; // Image height
-
-    // Update the rect position based on the new coordinates
-    bonus->rect.x = bonus->x;
-    bonus->rect.y = bonus->y;
-}
-
-// Check if snake's head collides with food
-int checkCollision(Snake* snake, Food* food) {
-    if (snake->segments[0].x < food->x + food->rect.w &&
-        snake->segments[0].x + snake->segments[0].w > food->x &&
-        snake->segments[0].y < food->y + food->rect.h &&
-        snake->segments[0].y + snake->segments[0].h > food->y) {
-        return 1;
-    }
-    return 0;
-}
-
-int checkBonusFoodCollision(Snake* snake, bonusFood* bonus) {
-    // Check if the snake's head collides with the bonus food
-    if (snake->segments[0].x < bonus->x + bonus->rect.w &&
-        snake->segments[0].x + snake->segments[0].w > bonus->x &&
-        snake->segments[0].y < bonus->y + bonus->rect.h &&
-        snake->segments[0].y + snake->segments[0].h > bonus->y) {
-        return 1; // Collision detected
-    }
-    return 0; // No collision
-}
-
-void renderFood(Food* food, SDL_Renderer* renderer) {
+void renderFood(Food* food, RenderList* list) {
     SDL_Rect destRect = { food->x, food->y, food->rect.w, food->rect.h };
-    SDL_RenderCopy(renderer, food->texture, NULL, &destRect);
+    pushCopy(list, TEX_FOOD, NULL, &destRect);
 }
-void renderBonusFood(bonusFood* bonus, SDL_Renderer* renderer) {
+void renderBonusFood(bonusFood* bonus, RenderList* list) {
     // Create a destination rectangle based on the bonus food's position and dimensions
     SDL_Rect destRect = { bonus->x, bonus->y, bonus->rect.w, bonus->rect.h };
     // Render the bonus food texture
-    SDL_RenderCopy(renderer, bonus->texture, NULL, &destRect);
+    pushCopy(list, TEX_BONUS_FOOD, NULL, &destRect);
+}
+
+// Draw the gameplay screen, callers clip it to the damaged rects
+void renderGameScene(RenderList* list, Playfield* playfield, Snake* snake, Food* food, bonusFood* bonus, int bonusActive, const char* scoreText, const char* highscoreText) {
+    TRACE_SCOPE("renderGameScene");
+    SDL_Color textColorRed = {255, 0, 0, 255}; // red color
+    renderPlayfield(playfield, snake, list);
+    renderFood(food, list);
+    if (bonusActive){
+        renderBonusFood(bonus, list);
+    }
+    // The score changes during play, glyph text draws it without creating a texture
+    pushGlyphText(list, FONT_GOTHIC, scoreText, textColorRed, SCORE_HUD_RECT.x, SCORE_HUD_RECT.y);
+    pushGlyphText(list, FONT_GOTHIC, highscoreText, textColorRed, HIGHSCORE_HUD_RECT.x, HIGHSCORE_HUD_RECT.y);
 }
 
 void loadHighScore(const char *filePath) {
@@ -905,12 +973,59 @@ void loadHighScore(const char *filePath) {
     fclose(file);
 }
 
-void saveHighScore(const char *filePath) {
-    FILE *file = fopen(filePath, "w");
-    if (file == NULL) {
-        printf("Failed to write high score file: %s\n", filePath);
-        return;
+// Leaderboard of this board size, the old single score file is imported when there is none
+void loadScores(void) {
+    if (loadLeaderboard(&leaderboard, "resources/leaderboard.bin") != 0) {
+        loadHighScore("resources/highscore.txt");
+        if (highScore > 0) {
+            LeaderboardEntry entry = {};
+            entry.cols = GRID_COLS;
+            entry.rows = GRID_ROWS;
+            entry.score = highScore;
+            leaderboardInsert(&leaderboard, &entry);
+        }
     }
-    fprintf(file, "%d", highScore);
-    fclose(file);
-}
\ No newline at end of file
+    const LeaderboardEntry* table;
+    if (leaderboardTable(&leaderboard, GRID_COLS, GRID_ROWS, 0, &table) > 0) {
+        highScore = table[0].score;
+    }
+}
+
+// Add a finished game, the file is only saved when it made the table
+void recordScore(Snake* snake, SaveWriter* writer) {
+    LeaderboardEntry entry = {};
+    entry.cols = GRID_COLS;
+    entry.rows = GRID_ROWS;
+    entry.score = snake->score;
+    entry.length = snake->length;
+    entry.durationMs = snake->tick * SCREEN_TICK_PER_FRAME;
+    entry.date = (Sint64)time(NULL);
+    if (leaderboardInsert(&leaderboard, &entry) >= 0) {
+        saveLeaderboard(&leaderboard, writer);
+    }
+    if (snake->score > highScore) {
+        highScore = snake->score;
+    }
+}
+
+// Best games on this board size
+void renderLeaderboard(RenderList* list, SDL_Color color) {
+    const LeaderboardEntry* table;
+    int count = leaderboardTable(&leaderboard, GRID_COLS, GRID_ROWS, 0, &table);
+    if (count > LEADERBOARD_SHOWN) {
+        count = LEADERBOARD_SHOWN;
+    }
+    for (int i = 0; i < count; ++i) {
+        char date[16] = "-";
+        time_t when = (time_t)table[i].date;
+        struct tm* local = when != 0 ? localtime(&when) : NULL;
+        if (local != NULL) {
+            strftime(date, sizeof(date), "%Y-%m-%d", local);
+        }
+        int seconds = table[i].durationMs / 1000;
+        char line[96];
+        snprintf(line, sizeof(line), "%2d.  %6d   length %4d   %3d:%02d   %s",
+                 i + 1, table[i].score, table[i].length, seconds / 60, seconds % 60, date);
+        pushGlyphText(list, FONT_GOTHIC, line, color, 230, 170 + i * 30);
+    }
+}
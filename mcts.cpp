@@ -0,0 +1,394 @@
+#include "mcts.h"
+#include "autopilot.h"
+#include "perf.h"
+#include <math.h>
+#include <stdio.h>
+#include <string.h>
+
+// Directions index STEP_COLS/STEP_ROWS (right, left, down, up), reversing is direction ^ 1
+
+// Exploration constant of UCT
+const double MCTS_EXPLORATION = 0.7;
+
+// Direction of child k (0..2) of a node reached moving in direction
+int childDirection(int direction, int k) {
+    return k >= (direction ^ 1) ? k + 1 : k;
+}
+
+// Would the simulated head die entering this cell? Cells entered in this simulation hold the segment that
+// entered them step - stamp ticks ago, the others hold the real snake's segment shifted by the steps taken.
+// A segment stays after the move if its index plus one is still inside the body
+int simBlocked(Mcts* mcts, MctsWorker* worker, int col, int row) {
+    if (!insideBoard(col, row)) {
+        return 1;
+    }
+    int stamp = worker->entered[row * GRID_COLS + col];
+    int previous;
+    if (stamp > worker->base) {
+        previous = worker->step - (stamp - worker->base);
+    } else {
+        int idx = snakeSegmentAt(mcts->root, col, row);
+        if (idx < 0) {
+            return 0;
+        }
+        previous = idx + worker->step;
+    }
+    return previous + 1 < worker->length;
+}
+
+// Start a simulation from the root position
+void simBegin(Mcts* mcts, MctsWorker* worker) {
+    worker->base += MCTS_MAX_DEPTH + MCTS_ROLLOUT_DEPTH + 1;
+    if (worker->base > 2000000000) {
+        memset(worker->entered, 0, sizeof(worker->entered));
+        worker->base = 0;
+    }
+    Snake* root = mcts->root;
+    worker->headCol = root->segments[0].x / CELL_SIZE;
+    worker->headRow = root->segments[0].y / CELL_SIZE;
+    worker->direction = mcts->rootDirection;
+    worker->length = root->length;
+    worker->step = 0;
+    // The worker's random sequence places the food and picks rollout moves for the whole simulation
+    worker->food = mcts->rootFood;
+    worker->food.random = worker->random;
+}
+
+// Move the simulated head, returns -1 if it died, otherwise the food eaten (0 or 1)
+int simMove(Mcts* mcts, MctsWorker* worker, int direction) {
+    int col = worker->headCol + STEP_COLS[direction];
+    int row = worker->headRow + STEP_ROWS[direction];
+    if (simBlocked(mcts, worker, col, row)) {
+        return -1;
+    }
+    worker->step++;
+    worker->steps++;
+    worker->entered[row * GRID_COLS + col] = worker->base + worker->step;
+    worker->headCol = col;
+    worker->headRow = row;
+    worker->direction = direction;
+    if (!eatsFood(&worker->food, col, row)) {
+        return 0;
+    }
+    // Grows like updateSnake, then by two more if the new food lands on the head like the check at the top of a tick
+    worker->length += 1;
+    generateFood(&worker->food);
+    if (eatsFood(&worker->food, col, row)) {
+        worker->length += 2;
+        generateFood(&worker->food);
+    }
+    return 1;
+}
+
+// Heuristic playout: mostly towards the food, never straight into a wall or the body when there's a choice.
+// Returns the simulation value in [0, 1]: dying is worst and dying later less bad, food eaten sooner is better
+double simRollout(Mcts* mcts, MctsWorker* worker, double foodValue) {
+    double discount = 1.0;
+    for (int t = 0; t < MCTS_ROLLOUT_DEPTH; ++t) {
+        int safe[3];
+        int safeCount = 0;
+        int best = -1;
+        int bestDistance = 0;
+        for (int k = 0; k < 3; ++k) {
+            int direction = childDirection(worker->direction, k);
+            int col = worker->headCol + STEP_COLS[direction];
+            int row = worker->headRow + STEP_ROWS[direction];
+            if (simBlocked(mcts, worker, col, row)) {
+                continue;
+            }
+            safe[safeCount++] = direction;
+            int distance = abs(col * CELL_SIZE - worker->food.x) + abs(row * CELL_SIZE - worker->food.y);
+            if (best < 0 || distance < bestDistance) {
+                best = direction;
+                bestDistance = distance;
+            }
+        }
+        if (safeCount == 0) {
+            return 0.3 * (worker->step) / (MCTS_MAX_DEPTH + MCTS_ROLLOUT_DEPTH);
+        }
+        Uint32 r = nextRandom(&worker->food.random);
+        int direction = (r & 3) != 0 ? best : safe[(r >> 8) % safeCount];
+        discount *= 0.97;
+        if (simMove(mcts, worker, direction) > 0) {
+            foodValue += discount;
+        }
+    }
+    return 0.5 + 0.5 * (foodValue < 1.0 ? foodValue : 1.0);
+}
+
+// Take three nodes from the pool for the children, -1 when the pool is used up
+int allocateChildren(Mcts* mcts) {
+    int first = SDL_AtomicAdd(&mcts->nodeCount, 3);
+    if (first + 3 > MCTS_MAX_NODES) {
+        return -1;
+    }
+    for (int k = 0; k < 3; ++k) {
+        MctsNode* node = &mcts->nodes[first + k];
+        SDL_AtomicSet(&node->visits, 0);
+        SDL_AtomicSet(&node->value, 0);
+        SDL_AtomicSet(&node->state, 0);
+        node->firstChild = -1;
+        node->dead = 0;
+    }
+    return first;
+}
+
+// UCT over the children, virtual losses count as visits without value. -1 if every child dies
+int selectChild(Mcts* mcts, MctsNode* node) {
+    int parentVisits = SDL_AtomicGet(&node->visits);
+    double logVisits = log((double)(parentVisits > 1 ? parentVisits : 1));
+    int best = -1;
+    double bestScore = 0;
+    for (int k = 0; k < 3; ++k) {
+        MctsNode* child = &mcts->nodes[node->firstChild + k];
+        if (child->dead) {
+            continue;
+        }
+        int visits = SDL_AtomicGet(&child->visits);
+        double score;
+        if (visits == 0) {
+            score = 1e9;
+        } else {
+            double mean = (double)SDL_AtomicGet(&child->value) / ((double)visits * MCTS_VALUE_SCALE);
+            score = mean + MCTS_EXPLORATION * sqrt(logVisits / visits);
+        }
+        if (best < 0 || score > bestScore) {
+            best = k;
+            bestScore = score;
+        }
+    }
+    return best;
+}
+
+// One simulation: select down the tree with virtual loss, expand a leaf, roll out, back up the value
+void runSimulation(Mcts* mcts, MctsWorker* worker) {
+    simBegin(mcts, worker);
+    int depth = 0;
+    int nodeIndex = 0;
+    worker->path[0] = 0;
+    SDL_AtomicAdd(&mcts->nodes[0].visits, MCTS_VIRTUAL_LOSS);
+    double foodValue = 0;
+    double discount = 1.0;
+    double value = -1;
+
+    while (depth < MCTS_MAX_DEPTH) {
+        MctsNode* node = &mcts->nodes[nodeIndex];
+        int state = SDL_AtomicGet(&node->state);
+        if (state == 0 && SDL_AtomicCAS(&node->state, 0, 1)) {
+            // Expand: children for the three moves, the ones that die right away are marked dead
+            int first = allocateChildren(mcts);
+            if (first >= 0) {
+                for (int k = 0; k < 3; ++k) {
+                    int direction = childDirection(worker->direction, k);
+                    mcts->nodes[first + k].dead = simBlocked(mcts, worker, worker->headCol + STEP_COLS[direction],
+                                                             worker->headRow + STEP_ROWS[direction]);
+                }
+                node->firstChild = first;
+                SDL_MemoryBarrierRelease();
+                SDL_AtomicSet(&node->state, 2);
+            }
+            // Pool used up: the node stays marked so nobody else tries, this and later simulations roll out from it
+            break;
+        }
+        if (state != 2) {
+            break;
+        }
+        SDL_MemoryBarrierAcquire();
+        int k = selectChild(mcts, node);
+        if (k < 0) {
+            value = 0;
+            break;
+        }
+        int direction = childDirection(worker->direction, k);
+        nodeIndex = node->firstChild + k;
+        worker->path[++depth] = nodeIndex;
+        SDL_AtomicAdd(&mcts->nodes[nodeIndex].visits, MCTS_VIRTUAL_LOSS);
+        discount *= 0.97;
+        int eaten = simMove(mcts, worker, direction);
+        if (eaten < 0) {
+            // Food inside the tree differs between simulations, a move can die in one and not another
+            value = 0.3 * worker->step / (MCTS_MAX_DEPTH + MCTS_ROLLOUT_DEPTH);
+            break;
+        }
+        foodValue += eaten * discount;
+    }
+    if (value < 0) {
+        value = simRollout(mcts, worker, foodValue);
+    }
+
+    int fixed = (int)(value * MCTS_VALUE_SCALE);
+    for (int i = 0; i <= depth; ++i) {
+        MctsNode* node = &mcts->nodes[worker->path[i]];
+        SDL_AtomicAdd(&node->value, fixed);
+        SDL_AtomicAdd(&node->visits, 1 - MCTS_VIRTUAL_LOSS);
+    }
+    worker->simulations++;
+    worker->random = worker->food.random;
+}
+
+void searchUntilDeadline(Mcts* mcts, MctsWorker* worker) {
+    while (perfNow() < mcts->deadline) {
+        runSimulation(mcts, worker);
+    }
+}
+
+int mctsWorkerMain(void* data) {
+    MctsWorker* worker = (MctsWorker*)data;
+    Mcts* mcts = worker->mcts;
+    while (1) {
+        SDL_SemWait(mcts->start);
+        if (mcts->quit) {
+            break;
+        }
+        searchUntilDeadline(mcts, worker);
+        SDL_SemPost(mcts->done);
+    }
+    return 0;
+}
+
+// Threads includes the calling thread, 0 or less means one per CPU core. Returns 0 on success
+int startMcts(Mcts* mcts, int threads, double budgetMs) {
+    mcts->threads = threads > 0 ? threads : SDL_GetCPUCount();
+    if (mcts->threads < 1) {
+        mcts->threads = 1;
+    }
+    if (mcts->threads > MCTS_MAX_THREADS) {
+        mcts->threads = MCTS_MAX_THREADS;
+    }
+    mcts->budgetMs = budgetMs;
+    mcts->quit = 0;
+    mcts->decisions = 0;
+    mcts->simulations = 0;
+    mcts->steps = 0;
+    mcts->searchMs = 0;
+    memset(mcts->workers, 0, sizeof(mcts->workers));
+    mcts->start = SDL_CreateSemaphore(0);
+    mcts->done = SDL_CreateSemaphore(0);
+    mcts->nodes = (MctsNode*)SDL_malloc(MCTS_MAX_NODES * sizeof(MctsNode));
+    if (mcts->start == NULL || mcts->done == NULL || mcts->nodes == NULL) {
+        printf("Function:startMcts, allocation failed,Error: %s\n", SDL_GetError());
+        mcts->threads = 0;
+        stopMcts(mcts);
+        return 1;
+    }
+
+    for (int i = 0; i < mcts->threads; ++i) {
+        MctsWorker* worker = (MctsWorker*)SDL_malloc(sizeof(MctsWorker));
+        if (worker == NULL) {
+            printf("Function:startMcts, worker allocation failed\n");
+            mcts->threads = i;
+            break;
+        }
+        memset(worker->entered, 0, sizeof(worker->entered));
+        worker->mcts = mcts;
+        worker->thread = NULL;
+        worker->index = i;
+        worker->base = 0;
+        Food seeded;
+        seedFood(&seeded, 0x6d637473 + i);
+        worker->random = seeded.random;
+        worker->simulations = 0;
+        worker->steps = 0;
+        mcts->workers[i] = worker;
+
+        // Worker 0 is the thread that calls mctsTurn
+        if (i > 0) {
+            worker->thread = SDL_CreateThread(mctsWorkerMain, "mcts worker", worker);
+            if (worker->thread == NULL) {
+                printf("Function:startMcts, SDL_CreateThread failed,Error: %s\n", SDL_GetError());
+                SDL_free(worker);
+                mcts->workers[i] = NULL;
+                mcts->threads = i;
+                break;
+            }
+        }
+    }
+    return mcts->threads > 0 ? 0 : 1;
+}
+
+void stopMcts(Mcts* mcts) {
+    mcts->quit = 1;
+    for (int i = 1; i < mcts->threads; ++i) {
+        SDL_SemPost(mcts->start);
+    }
+    for (int i = 0; i < MCTS_MAX_THREADS; ++i) {
+        if (mcts->workers[i] != NULL) {
+            if (mcts->workers[i]->thread != NULL) {
+                SDL_WaitThread(mcts->workers[i]->thread, NULL);
+            }
+            SDL_free(mcts->workers[i]);
+            mcts->workers[i] = NULL;
+        }
+    }
+    if (mcts->start != NULL) {
+        SDL_DestroySemaphore(mcts->start);
+    }
+    if (mcts->done != NULL) {
+        SDL_DestroySemaphore(mcts->done);
+    }
+    SDL_free(mcts->nodes);
+    mcts->start = NULL;
+    mcts->done = NULL;
+    mcts->nodes = NULL;
+    mcts->threads = 0;
+}
+
+// Search for the time budget and queue the most visited move, returns 0 when every move dies
+int mctsTurn(Mcts* mcts, Snake* snake, Food* food, InputQueue* input) {
+    if (mcts->threads < 1) {
+        return 0;
+    }
+    mcts->decisions++;
+    mcts->root = snake;
+    mcts->rootFood = *food;
+    mcts->rootDirection = snake->dx > 0 ? 0 : snake->dx < 0 ? 1 : snake->dy > 0 ? 2 : 3;
+    SDL_AtomicSet(&mcts->nodeCount, 1);
+    MctsNode* root = &mcts->nodes[0];
+    SDL_AtomicSet(&root->visits, 0);
+    SDL_AtomicSet(&root->value, 0);
+    SDL_AtomicSet(&root->state, 0);
+    root->firstChild = -1;
+    root->dead = 0;
+
+    Uint64 start = perfNow();
+    mcts->deadline = start + (Uint64)(mcts->budgetMs * SDL_GetPerformanceFrequency() / 1000.0);
+    SDL_MemoryBarrierRelease();
+    for (int i = 1; i < mcts->threads; ++i) {
+        SDL_SemPost(mcts->start);
+    }
+    searchUntilDeadline(mcts, mcts->workers[0]);
+    for (int i = 1; i < mcts->threads; ++i) {
+        SDL_SemWait(mcts->done);
+    }
+    mcts->searchMs += perfMs(start, perfNow());
+
+    long long simulations = 0;
+    long long steps = 0;
+    for (int i = 0; i < mcts->threads; ++i) {
+        simulations += mcts->workers[i]->simulations;
+        steps += mcts->workers[i]->steps;
+    }
+    mcts->simulations = simulations;
+    mcts->steps = steps;
+
+    // Most visited move that doesn't die right away
+    if (SDL_AtomicGet(&root->state) != 2) {
+        return 0;
+    }
+    int best = -1;
+    int bestVisits = -1;
+    for (int k = 0; k < 3; ++k) {
+        MctsNode* child = &mcts->nodes[root->firstChild + k];
+        int visits = SDL_AtomicGet(&child->visits);
+        if (!child->dead && visits > bestVisits) {
+            best = k;
+            bestVisits = visits;
+        }
+    }
+    if (best < 0) {
+        return 0;
+    }
+    int direction = childDirection(mcts->rootDirection, best);
+    queueTurn(input, STEP_COLS[direction] * CELL_SIZE, STEP_ROWS[direction] * CELL_SIZE, 0);
+    return 1;
+}
@@ -0,0 +1,87 @@
+// Monte Carlo tree search bot: every tick it grows a tree of moves from the current position for a fixed
+// time budget, on several threads at once, and takes the most visited move.
+// The tree is shared: nodes are taken from a pool with an atomic counter, visit counts and value sums are
+// atomic adds, and a thread passing through a node adds a virtual loss (extra visits with no value) until
+// its result comes back, so the other threads spread out over other moves.
+// Simulations don't copy the snake: the position is the real snake read-only plus the cells each thread's
+// simulated head entered, stamped in a per-thread grid, so a simulated move costs the same as a real one.
+// The tree is open loop: food eaten inside it reappears at a random place in every simulation.
+// Rollouts past the tree mostly head for the food and avoid moves that die at once
+
+#ifndef MCTS_H
+#define MCTS_H
+
+#include <SDL2/SDL.h>
+#include "snake.h"
+#include "input.h"
+
+const int MCTS_MAX_THREADS = 16;
+const int MCTS_MAX_NODES = 1 << 18;
+const int MCTS_MAX_DEPTH = 48;       // Tree depth, selection stops there and rolls out
+const int MCTS_ROLLOUT_DEPTH = 60;   // Moves simulated past the tree
+const int MCTS_VIRTUAL_LOSS = 3;
+const int MCTS_VALUE_SCALE = 1024;   // Values in [0, 1] are summed as fixed point
+
+typedef struct {
+    SDL_atomic_t visits;  // Including virtual losses of simulations still running through the node
+    SDL_atomic_t value;   // Sum of simulation values, MCTS_VALUE_SCALE each at most
+    SDL_atomic_t state;   // 0 leaf, 1 being expanded, 2 children ready
+    int firstChild;       // Three children, one per move that doesn't reverse
+    int dead;             // The move into this node always dies
+} MctsNode;
+
+typedef struct Mcts Mcts;
+
+// One searching thread, the calling thread is worker 0
+typedef struct {
+    Mcts* mcts;
+    SDL_Thread* thread;
+    int index;
+
+    // Stamp of the step at which the simulated head entered each cell, only stamps above base are current
+    int entered[GRID_CELLS];
+    int base;
+    int path[MCTS_MAX_DEPTH + 1];  // Nodes of the current simulation from the root
+
+    // Simulated position
+    int headCol, headRow;
+    int direction;  // 0 right, 1 left, 2 down, 3 up
+    int length;
+    int step;
+    Food food;
+    Uint32 random;  // Seeded per worker, the food carries it during a simulation
+
+    long long simulations;
+    long long steps;
+} MctsWorker;
+
+struct Mcts {
+    MctsNode* nodes;
+    SDL_atomic_t nodeCount;
+
+    // Position being searched, read-only while the workers run
+    Snake* root;
+    Food rootFood;
+    int rootDirection;
+    Uint64 deadline;
+
+    int threads;
+    double budgetMs;
+    MctsWorker* workers[MCTS_MAX_THREADS];
+    SDL_sem* start;
+    SDL_sem* done;
+    int quit;
+
+    // Counters for benchmarks
+    int decisions;
+    long long simulations;
+    long long steps;
+    double searchMs;
+};
+
+// MCTS functions
+int startMcts(Mcts* mcts, int threads, double budgetMs);
+void stopMcts(Mcts* mcts);
+int mctsTurn(Mcts* mcts, Snake* snake, Food* food, InputQueue* input);
+
+#endif
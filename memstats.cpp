@@ -0,0 +1,165 @@
+#include "memstats.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <new>
+
+#ifdef _WIN32
+#include <windows.h>
+#include <psapi.h>
+#else
+#include <unistd.h>
+#endif
+
+// Counters are shared by the game and render threads
+SDL_atomic_t allocCounter;
+SDL_atomic_t freeCounter;
+SDL_atomic_t textureCreateCounter;
+SDL_atomic_t textureDestroyCounter;
+SDL_atomic_t textRenderCounter;
+
+// SDL's own allocator, the counting functions forward to it
+SDL_malloc_func baseMalloc;
+SDL_calloc_func baseCalloc;
+SDL_realloc_func baseRealloc;
+SDL_free_func baseFree;
+
+void* countingMalloc(size_t size) {
+    SDL_AtomicIncRef(&allocCounter);
+    return baseMalloc(size);
+}
+
+void* countingCalloc(size_t count, size_t size) {
+    SDL_AtomicIncRef(&allocCounter);
+    return baseCalloc(count, size);
+}
+
+void* countingRealloc(void* memory, size_t size) {
+    if (memory == NULL) {
+        SDL_AtomicIncRef(&allocCounter);
+    }
+    return baseRealloc(memory, size);
+}
+
+void countingFree(void* memory) {
+    if (memory != NULL) {
+        SDL_AtomicIncRef(&freeCounter);
+    }
+    baseFree(memory);
+}
+
+#ifdef SNAKE_COUNT_CRT_ALLOCS
+// The linker sends the game's CRT allocator calls here (--wrap), __real_* are the CRT's own
+extern "C" {
+void* __real_malloc(size_t size);
+void* __real_calloc(size_t count, size_t size);
+void* __real_realloc(void* memory, size_t size);
+void __real_free(void* memory);
+
+void* __wrap_malloc(size_t size) {
+    SDL_AtomicIncRef(&allocCounter);
+    return __real_malloc(size);
+}
+
+void* __wrap_calloc(size_t count, size_t size) {
+    SDL_AtomicIncRef(&allocCounter);
+    return __real_calloc(count, size);
+}
+
+void* __wrap_realloc(void* memory, size_t size) {
+    if (memory == NULL) {
+        SDL_AtomicIncRef(&allocCounter);
+    }
+    return __real_realloc(memory, size);
+}
+
+void __wrap_free(void* memory) {
+    if (memory != NULL) {
+        SDL_AtomicIncRef(&freeCounter);
+    }
+    __real_free(memory);
+}
+}
+
+// new and delete go through the wrapped malloc and free, also when the C++ runtime is a DLL
+void* operator new(size_t size) {
+    void* memory = malloc(size > 0 ? size : 1);
+    if (memory == NULL) {
+        throw std::bad_alloc();
+    }
+    return memory;
+}
+
+void* operator new[](size_t size) {
+    return operator new(size);
+}
+
+void operator delete(void* memory) noexcept {
+    free(memory);
+}
+
+void operator delete[](void* memory) noexcept {
+    free(memory);
+}
+#endif
+
+// Count every SDL allocation from now on, call before SDL_Init. Returns 0 on success
+int installMemoryCounters(void) {
+    SDL_GetMemoryFunctions(&baseMalloc, &baseCalloc, &baseRealloc, &baseFree);
+    if (SDL_SetMemoryFunctions(countingMalloc, countingCalloc, countingRealloc, countingFree) != 0) {
+        printf("Function:installMemoryCounters, SDL_SetMemoryFunctions failed, Error: %s\n", SDL_GetError());
+        return 1;
+    }
+    return 0;
+}
+
+void memStatsSnapshot(MemStats* stats) {
+    stats->allocs = SDL_AtomicGet(&allocCounter);
+    stats->frees = SDL_AtomicGet(&freeCounter);
+    stats->texturesCreated = SDL_AtomicGet(&textureCreateCounter);
+    stats->texturesDestroyed = SDL_AtomicGet(&textureDestroyCounter);
+    stats->textRenders = SDL_AtomicGet(&textRenderCounter);
+}
+
+void memStatsDelta(const MemStats* before, const MemStats* after, MemStats* delta) {
+    delta->allocs = after->allocs - before->allocs;
+    delta->frees = after->frees - before->frees;
+    delta->texturesCreated = after->texturesCreated - before->texturesCreated;
+    delta->texturesDestroyed = after->texturesDestroyed - before->texturesDestroyed;
+    delta->textRenders = after->textRenders - before->textRenders;
+}
+
+void countTextureCreated(void) {
+    SDL_AtomicIncRef(&textureCreateCounter);
+}
+
+void countTextureDestroyed(void) {
+    SDL_AtomicIncRef(&textureDestroyCounter);
+}
+
+void countTextRender(void) {
+    SDL_AtomicIncRef(&textRenderCounter);
+}
+
+// Resident set size of the process in KB, -1 if it can't be read
+int currentRssKb(void) {
+#ifdef _WIN32
+    PROCESS_MEMORY_COUNTERS counters;
+    if (!GetProcessMemoryInfo(GetCurrentProcess(), &counters, sizeof(counters))) {
+        return -1;
+    }
+    return (int)(counters.WorkingSetSize / 1024);
+#else
+    FILE* file = fopen("/proc/self/statm", "r");
+    if (file == NULL) {
+        return -1;
+    }
+    long pages = 0;
+    long residentPages = 0;
+    int read = fscanf(file, "%ld %ld", &pages, &residentPages);
+    fclose(file);
+    if (read != 2) {
+        return -1;
+    }
+    return (int)(residentPages * (sysconf(_SC_PAGESIZE) / 1024));
+#endif
+}
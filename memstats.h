@@ -0,0 +1,36 @@
+// Allocation and texture accounting
+// SDL, SDL_image and SDL_ttf allocate through SDL_malloc, installMemoryCounters routes that through counters,
+// textures and TTF renders are counted by the helpers in texture.cpp.
+// The game's own malloc, calloc, realloc, free, new and delete are counted too when it is built with
+// -DSNAKE_COUNT_CRT_ALLOCS and linked with -Wl,--wrap=malloc,--wrap=calloc,--wrap=realloc,--wrap=free (the
+// Makefile does this for main). The C runtime's allocations from inside the SDL DLLs stay unseen
+
+#ifndef MEMSTATS_H
+#define MEMSTATS_H
+
+#include <SDL2/SDL.h>
+
+#ifdef SNAKE_COUNT_CRT_ALLOCS
+const int MEMSTATS_COUNTS_CRT = 1;
+#else
+const int MEMSTATS_COUNTS_CRT = 0;
+#endif
+
+typedef struct {
+    int allocs;            // malloc/calloc and realloc(NULL), SDL's and with MEMSTATS_COUNTS_CRT the CRT's and new
+    int frees;
+    int texturesCreated;
+    int texturesDestroyed;
+    int textRenders;       // TTF_Render* calls
+} MemStats;
+
+// Memory stats functions
+int installMemoryCounters(void);
+void memStatsSnapshot(MemStats* stats);
+void memStatsDelta(const MemStats* before, const MemStats* after, MemStats* delta);
+void countTextureCreated(void);
+void countTextureDestroyed(void);
+void countTextRender(void);
+int currentRssKb(void);
+
+#endif
@@ -0,0 +1,300 @@
+// Microbenchmarks for the simulation and render hot paths
+// Usage: microbench [--min-ms N] [--filter name]
+// Prints CSV on stdout: benchmark,board,length,iterations,ns_per_op,allocs_per_op
+//   the board size is fixed at build time (make microbench builds one binary per size)
+//   snakes are laid out as a zigzag that fills the board row by row, so isGameOver scans the whole body
+//   allocs_per_op counts SDL allocations (SDL_malloc, surfaces, textures, SDL_ttf), FreeType's own mallocs are not seen
+//   render benchmarks use the software renderer on a hidden dummy window and need the resources folder
+
+#include <SDL2/SDL.h>
+#include <SDL2/SDL_image.h>
+#include <SDL2/SDL_ttf.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "perf.h"
+#include "snake.h"
+#include "playfield.h"
+#include "render.h"
+#include "memstats.h"
+#include "observation.h"
+#include "zobrist.h"
+
+const int BENCH_LENGTHS[] = {10, 100, 1000, 10000, 100000};
+const int BENCH_LENGTH_COUNT = sizeof(BENCH_LENGTHS) / sizeof(BENCH_LENGTHS[0]);
+
+typedef struct {
+    Snake* snake;
+    Food food;
+    int length;
+    RenderContext* render;
+    RenderList* list;  // Recording only, never executed
+    Uint8* observation;   // OBS_BYTES_SIZE
+    Uint64* observationBits;
+    bonusFood bonus;
+    ZobristTracker tracker;
+    TransTable table;  // 1 << 20 entries
+    Uint64 key;
+    volatile int sink;
+} BenchState;
+
+typedef void (*BenchFunction)(BenchState* state);
+
+// Cells inside the board, in zigzag order
+void zigzagCell(int index, int* x, int* y) {
+    int cols = BOARD_COLS;
+    int row = index / cols;
+    int col = index % cols;
+    if (row % 2 == 1) {
+        col = cols - 1 - col;
+    }
+    *x = (BOARD_FIRST_COL + col) * CELL_SIZE;
+    *y = (BOARD_FIRST_ROW + row) * CELL_SIZE;
+}
+
+// Lay the snake out along the zigzag with the head at the far end, returns 0 if it doesn't fit
+int layoutSnake(Snake* snake, int length) {
+    if (length > BOARD_COLS * BOARD_ROWS || length > SNAKE_MAX_LENGTH) {
+        return 0;
+    }
+    initSnake(snake);
+    snake->length = length;
+    for (int i = 0; i < length; ++i) {
+        zigzagCell(length - 1 - i, &snake->segments[i].x, &snake->segments[i].y);
+        snake->segments[i].w = SEGMENT_WIDTH;
+        snake->segments[i].h = SEGMENT_HEIGHT;
+        int col = snake->segments[i].x / CELL_SIZE;
+        int row = snake->segments[i].y / CELL_SIZE;
+        snake->cellStamp[row * GRID_COLS + col] = -i;
+    }
+
+    // Direction each segment moved to get where it is (1 right, 2 left, 3 down, 4 up), the tail takes the next one's
+    for (int i = 0; i < length; ++i) {
+        int to = i;
+        int from = i + 1;
+        if (from == length) {
+            to = i - 1;
+            from = i;
+        }
+        int dx = snake->segments[to].x - snake->segments[from].x;
+        int dy = snake->segments[to].y - snake->segments[from].y;
+        snake->directions[i] = dx > 0 ? 1 : dx < 0 ? 2 : dy > 0 ? 3 : 4;
+    }
+    snake->dx = snake->directions[0] == 1 ? CELL_SIZE : snake->directions[0] == 2 ? -CELL_SIZE : 0;
+    snake->dy = snake->directions[0] == 3 ? CELL_SIZE : snake->directions[0] == 4 ? -CELL_SIZE : 0;
+    return 1;
+}
+
+void benchUpdateSnake(BenchState* state) {
+    updateSnake(state->snake, &state->food);
+}
+
+void benchIsGameOver(BenchState* state) {
+    state->sink = isGameOver(state->snake);
+}
+
+void benchGenerateFood(BenchState* state) {
+    generateFood(&state->food);
+}
+
+void benchCheckCollision(BenchState* state) {
+    state->sink = checkCollision(state->snake, &state->food);
+}
+
+void benchEncodeObservation(BenchState* state) {
+    encodeObservation(state->snake, &state->food, &state->bonus, 1, state->observation);
+}
+
+void benchEncodeObservationBits(BenchState* state) {
+    encodeObservationBits(state->snake, &state->food, &state->bonus, 1, state->observationBits);
+}
+
+void benchZobristHash(BenchState* state) {
+    state->sink = (int)zobristHash(state->snake, &state->food);
+}
+
+// A tick with the hash kept up to date, compare with updateSnake
+void benchZobristUpdate(BenchState* state) {
+    updateSnake(state->snake, &state->food);
+    state->sink = (int)zobristUpdate(&state->tracker, state->snake, &state->food);
+}
+
+// Keys spread over a table much bigger than the caches, half of the probes hit
+void benchTransStoreProbe(BenchState* state) {
+    TransResult result;
+    state->key = state->key * 6364136223846793005ULL + 1442695040888963407ULL;
+    if (state->key >> 63) {
+        result.value = (Sint32)state->key;
+        result.depth = (int)(state->key >> 40) & 0xff;
+        result.move = 0;
+        transStore(&state->table, state->key, &result);
+    }
+    state->sink = transProbe(&state->table, state->key, &result);
+}
+
+// Record the whole snake, lists that fill up are restarted so long snakes measure recording only
+void benchRenderSnakeRecord(BenchState* state) {
+    RenderList* list = state->list;
+    resetRenderList(list);
+    for (int i = 0; i < state->snake->length; ++i) {
+        if (list->count == RENDER_MAX_COMMANDS) {
+            resetRenderList(list);
+        }
+        renderSegment(state->snake, i, list);
+    }
+}
+
+// Record, replay on the software renderer and present the whole snake, long snakes take several lists
+void benchRenderSnake(BenchState* state) {
+    RenderContext* render = state->render;
+    RenderList* list = currentRenderList(render);
+    pushCopy(list, TEX_GAME_BG, NULL, NULL);
+    for (int i = 0; i < state->snake->length; ++i) {
+        if (list->count == RENDER_MAX_COMMANDS) {
+            submitRenderList(render);
+            list = currentRenderList(render);
+        }
+        renderSegment(state->snake, i, list);
+    }
+    damageAddFull(&list->damage);
+    submitRenderList(render);
+}
+
+void benchRenderText(BenchState* state) {
+    SDL_Color white = {255, 255, 255, 255};
+    SDL_Rect rect;
+    SDL_Texture* texture = renderText(state->render->renderer, state->render->fonts[FONT_GOTHIC], "Score: 1234", white, &rect);
+    destroyTexture(texture);
+}
+
+// Run with doubling iteration counts until one run takes minMs, then print that run
+void runBench(const char* name, BenchFunction function, BenchState* state, double minMs, const char* filter) {
+    if (filter != NULL && strstr(name, filter) == NULL) {
+        return;
+    }
+    Uint64 iterations = 1;
+    while (1) {
+        MemStats before;
+        MemStats after;
+        memStatsSnapshot(&before);
+        Uint64 start = perfNow();
+        for (Uint64 i = 0; i < iterations; ++i) {
+            function(state);
+        }
+        double elapsedMs = perfMs(start, perfNow());
+        memStatsSnapshot(&after);
+        int allocs = after.allocs - before.allocs;
+        if (elapsedMs >= minMs || iterations >= ((Uint64)1 << 32)) {
+            printf("%s,%dx%d,%d,%llu,%.2f,%.3f\n", name, SCREEN_WIDTH, SCREEN_HEIGHT, state->length, (unsigned long long)iterations,
+                   elapsedMs * 1000000.0 / (double)iterations, (double)allocs / (double)iterations);
+            fflush(stdout);
+            return;
+        }
+        iterations *= 2;
+    }
+}
+
+int main(int argc, char* args[]) {
+    double minMs = 200;
+    const char* filter = NULL;
+    for (int i = 1; i < argc; ++i) {
+        if (strcmp(args[i], "--min-ms") == 0 && i + 1 < argc) {
+            minMs = atof(args[++i]);
+        } else if (strcmp(args[i], "--filter") == 0 && i + 1 < argc) {
+            filter = args[++i];
+        } else {
+            printf("Usage: microbench [--min-ms N] [--filter name]\n");
+            return 1;
+        }
+    }
+
+    installMemoryCounters();
+
+    // Headless software rendering
+    SDL_setenv("SDL_VIDEODRIVER", "dummy", 0);
+    if (SDL_Init(SDL_INIT_VIDEO) < 0) {
+        printf("SDL could not initialize! SDL_Error: %s\n", SDL_GetError());
+        return 1;
+    }
+    if (!(IMG_Init(IMG_INIT_PNG) & IMG_INIT_PNG) || TTF_Init() == -1) {
+        printf("SDL_image or SDL_ttf could not initialize! Error: %s\n", SDL_GetError());
+        SDL_Quit();
+        return 1;
+    }
+    SDL_Window* window = SDL_CreateWindow("microbench", SDL_WINDOWPOS_UNDEFINED, SDL_WINDOWPOS_UNDEFINED, SCREEN_WIDTH, SCREEN_HEIGHT, SDL_WINDOW_HIDDEN);
+    if (window == NULL) {
+        printf("Window could not be created! SDL_Error: %s\n", SDL_GetError());
+        SDL_Quit();
+        return 1;
+    }
+    RenderContext* render = (RenderContext*)malloc(sizeof(RenderContext));
+    BenchState* state = (BenchState*)malloc(sizeof(BenchState));
+    state->snake = (Snake*)malloc(sizeof(Snake));
+    state->list = (RenderList*)malloc(sizeof(RenderList));
+    state->observation = (Uint8*)malloc(OBS_BYTES_SIZE);
+    state->observationBits = (Uint64*)malloc(OBS_BITS_SIZE);
+    if (render == NULL || state == NULL || state->snake == NULL || state->list == NULL || state->observation == NULL ||
+        state->observationBits == NULL || initTransTable(&state->table, 20) != 0) {
+        printf("Function:main, benchmark allocation failed\n");
+        return 1;
+    }
+    if (startRenderContext(render, window, 1, 0) != 0) {
+        printf("Failed to start rendering: %s\n", SDL_GetError());
+        return 1;
+    }
+    state->render = render;
+
+    // Food far off the board, updateSnake never eats it
+    state->food.rect.w = 15;
+    state->food.rect.h = 15;
+    state->food.random = 0;
+    state->food.x = -1000;
+    state->food.y = -1000;
+    state->bonus.x = BOARD_LEFT + 5 * CELL_SIZE;
+    state->bonus.y = BOARD_TOP + 5 * CELL_SIZE;
+
+    printf("benchmark,board,length,iterations,ns_per_op,allocs_per_op\n");
+
+    // Length independent
+    state->length = 0;
+    layoutSnake(state->snake, 10);
+    runBench("generateFood", benchGenerateFood, state, minMs, filter);
+    runBench("checkCollision", benchCheckCollision, state, minMs, filter);
+    runBench("renderText", benchRenderText, state, minMs, filter);
+    state->key = 1;
+    runBench("transStoreProbe", benchTransStoreProbe, state, minMs, filter);
+
+    for (int i = 0; i < BENCH_LENGTH_COUNT; ++i) {
+        int length = BENCH_LENGTHS[i];
+        if (!layoutSnake(state->snake, length)) {
+            fprintf(stderr, "Length %d does not fit a %dx%d board, skipped\n", length, SCREEN_WIDTH, SCREEN_HEIGHT);
+            continue;
+        }
+        state->length = length;
+        runBench("isGameOver", benchIsGameOver, state, minMs, filter);
+        runBench("renderSnake_record", benchRenderSnakeRecord, state, minMs, filter);
+        runBench("renderSnake", benchRenderSnake, state, minMs, filter);
+        runBench("encodeObservation", benchEncodeObservation, state, minMs, filter);
+        runBench("encodeObservationBits", benchEncodeObservationBits, state, minMs, filter);
+        runBench("zobristHash", benchZobristHash, state, minMs, filter);
+
+        // Last, they move the snake off its layout
+        runBench("updateSnake", benchUpdateSnake, state, minMs, filter);
+        zobristStart(&state->tracker, state->snake, &state->food);
+        runBench("zobristUpdate", benchZobristUpdate, state, minMs, filter);
+    }
+
+    stopRenderContext(render);
+    free(state->list);
+    free(state->observation);
+    free(state->observationBits);
+    freeTransTable(&state->table);
+    free(state->snake);
+    free(state);
+    free(render);
+    SDL_DestroyWindow(window);
+    TTF_Quit();
+    IMG_Quit();
+    SDL_Quit();
+    return 0;
+}
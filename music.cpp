@@ -0,0 +1,374 @@
+#include "music.h"
+#include <stdio.h>
+#include <string.h>
+
+// Music files in MUSIC_* order, the game over track plays once
+const char* MUSIC_FILES[MUSIC_COUNT] = {
+    "resources/intro.mp3",
+    "resources/game.mp3",
+    "resources/over.mp3",
+};
+const int MUSIC_LOOPS[MUSIC_COUNT] = {-1, -1, 0};
+const int MUSIC_RESUME[MUSIC_COUNT] = {1, 0, 0};
+
+// Reader thread file reads, and bytes kept behind the decoder for short seeks back
+const int MUSIC_READ_CHUNK = 4096;
+const int MUSIC_BACKLOG = 4096;
+
+// Keep the ring filled ahead of the decoder
+int musicReaderMain(void* data) {
+    MusicStream* stream = (MusicStream*)data;
+    Uint8 chunk[MUSIC_READ_CHUNK];
+    SDL_LockMutex(stream->lock);
+    while (!stream->quit) {
+        Sint64 next = stream->dataStart + stream->count;
+        if (MUSIC_STREAM_BUFFER - stream->count < MUSIC_READ_CHUNK || next >= stream->size) {
+            SDL_CondWait(stream->changed, stream->lock);
+            continue;
+        }
+
+        // Read without holding the lock, the decoder may seek meanwhile
+        int generation = stream->generation;
+        SDL_UnlockMutex(stream->lock);
+        size_t bytes = 0;
+        if (SDL_RWseek(stream->file, next, RW_SEEK_SET) >= 0) {
+            bytes = SDL_RWread(stream->file, chunk, 1, MUSIC_READ_CHUNK);
+        }
+        SDL_LockMutex(stream->lock);
+
+        if (generation != stream->generation) {
+            continue;
+        }
+        if (bytes == 0) {
+            // Read error, pretend the file ends here so the decoder doesn't wait forever
+            stream->size = next;
+            SDL_CondBroadcast(stream->changed);
+            continue;
+        }
+        for (size_t i = 0; i < bytes; ++i) {
+            stream->data[(stream->head + stream->count + i) % MUSIC_STREAM_BUFFER] = chunk[i];
+        }
+        stream->count += (int)bytes;
+        SDL_CondBroadcast(stream->changed);
+    }
+    SDL_UnlockMutex(stream->lock);
+    return 0;
+}
+
+MusicStream* streamOf(SDL_RWops* rw) {
+    return (MusicStream*)rw->hidden.unknown.data1;
+}
+
+Sint64 musicStreamSize(SDL_RWops* rw) {
+    return streamOf(rw)->size;
+}
+
+Sint64 musicStreamSeek(SDL_RWops* rw, Sint64 offset, int whence) {
+    MusicStream* stream = streamOf(rw);
+    SDL_LockMutex(stream->lock);
+    Sint64 position = offset;
+    if (whence == RW_SEEK_CUR) {
+        position += stream->position;
+    } else if (whence == RW_SEEK_END) {
+        position += stream->size;
+    }
+    if (position < 0) {
+        position = 0;
+    }
+    stream->position = position;
+    SDL_UnlockMutex(stream->lock);
+    return position;
+}
+
+// Copy from the ring, restarting the reader when the decoder jumped outside of it
+size_t musicStreamRead(SDL_RWops* rw, void* ptr, size_t size, size_t maxnum) {
+    MusicStream* stream = streamOf(rw);
+    Uint8* out = (Uint8*)ptr;
+    size_t wanted = size * maxnum;
+    size_t copied = 0;
+
+    SDL_LockMutex(stream->lock);
+    while (copied < wanted && stream->position < stream->size) {
+        Sint64 position = stream->position;
+        if (position < stream->dataStart || position > stream->dataStart + stream->count) {
+            stream->dataStart = position;
+            stream->head = 0;
+            stream->count = 0;
+            stream->generation++;
+            SDL_CondBroadcast(stream->changed);
+        }
+        Sint64 available = stream->dataStart + stream->count - position;
+        if (available == 0) {
+            SDL_CondWait(stream->changed, stream->lock);
+            continue;
+        }
+
+        size_t bytes = wanted - copied;
+        if ((Sint64)bytes > available) {
+            bytes = (size_t)available;
+        }
+        int offset = (int)(position - stream->dataStart);
+        for (size_t i = 0; i < bytes; ++i) {
+            out[copied + i] = stream->data[(stream->head + offset + i) % MUSIC_STREAM_BUFFER];
+        }
+        copied += bytes;
+        stream->position += bytes;
+
+        // Free what the decoder is done with so the reader can go on
+        Sint64 keepFrom = stream->position - MUSIC_BACKLOG;
+        if (keepFrom > stream->dataStart) {
+            int drop = (int)(keepFrom - stream->dataStart);
+            stream->head = (stream->head + drop) % MUSIC_STREAM_BUFFER;
+            stream->count -= drop;
+            stream->dataStart = keepFrom;
+            SDL_CondBroadcast(stream->changed);
+        }
+    }
+    SDL_UnlockMutex(stream->lock);
+    return size > 0 ? copied / size : 0;
+}
+
+size_t musicStreamWrite(SDL_RWops* rw, const void* ptr, size_t size, size_t num) {
+    (void)rw;
+    (void)ptr;
+    (void)size;
+    (void)num;
+    SDL_SetError("Music streams are read only");
+    return 0;
+}
+
+int musicStreamClose(SDL_RWops* rw) {
+    MusicStream* stream = streamOf(rw);
+    SDL_LockMutex(stream->lock);
+    stream->quit = 1;
+    SDL_CondBroadcast(stream->changed);
+    SDL_UnlockMutex(stream->lock);
+    SDL_WaitThread(stream->reader, NULL);
+    SDL_DestroyCond(stream->changed);
+    SDL_DestroyMutex(stream->lock);
+    SDL_RWclose(stream->file);
+    SDL_free(stream);
+    SDL_FreeRW(rw);
+    return 0;
+}
+
+// Open a file behind a read-ahead ring, NULL on failure
+SDL_RWops* openMusicStream(const char* filePath) {
+    SDL_RWops* file = SDL_RWFromFile(filePath, "rb");
+    if (file == NULL) {
+        printf("Function:openMusicStream, Unable to open %s, Error: %s\n", filePath, SDL_GetError());
+        return NULL;
+    }
+    MusicStream* stream = (MusicStream*)SDL_malloc(sizeof(MusicStream));
+    SDL_RWops* rw = SDL_AllocRW();
+    if (stream == NULL || rw == NULL) {
+        printf("Function:openMusicStream, allocation failed\n");
+        SDL_free(stream);
+        if (rw != NULL) {
+            SDL_FreeRW(rw);
+        }
+        SDL_RWclose(file);
+        return NULL;
+    }
+    stream->file = file;
+    stream->size = SDL_RWsize(file);
+    stream->head = 0;
+    stream->count = 0;
+    stream->dataStart = 0;
+    stream->position = 0;
+    stream->generation = 0;
+    stream->quit = 0;
+    stream->lock = SDL_CreateMutex();
+    stream->changed = SDL_CreateCond();
+    stream->reader = SDL_CreateThread(musicReaderMain, "music reader", stream);
+
+    rw->size = musicStreamSize;
+    rw->seek = musicStreamSeek;
+    rw->read = musicStreamRead;
+    rw->write = musicStreamWrite;
+    rw->close = musicStreamClose;
+    rw->type = SDL_RWOPS_UNKNOWN;
+    rw->hidden.unknown.data1 = stream;
+    return rw;
+}
+
+// Loader thread: open the requested track, opening parses the file and can take a while
+int musicLoaderMain(void* data) {
+    MusicPlayer* music = (MusicPlayer*)data;
+    while (1) {
+        SDL_SemWait(music->requested);
+        if (SDL_AtomicGet(&music->quit)) {
+            break;
+        }
+        Mix_Music* loaded = NULL;
+        if (SDL_AtomicGet(&music->openStreams) < MUSIC_MAX_OPEN) {
+            SDL_RWops* rw = openMusicStream(MUSIC_FILES[music->loadTrack]);
+            if (rw != NULL) {
+                // SDL_mixer closes the stream when the music is freed
+                loaded = Mix_LoadMUS_RW(rw, 1);
+                if (loaded == NULL) {
+                    printf("Failed to load music %s! Error: %s\n", MUSIC_FILES[music->loadTrack], Mix_GetError());
+                } else {
+                    SDL_AtomicIncRef(&music->openStreams);
+                }
+            }
+        }
+        music->loaded = loaded;
+        SDL_MemoryBarrierRelease();
+        SDL_AtomicSet(&music->loadDone, 1);
+    }
+    return 0;
+}
+
+void freeMusic(MusicPlayer* music, Mix_Music* track) {
+    if (track != NULL) {
+        Mix_FreeMusic(track);
+        SDL_AtomicAdd(&music->openStreams, -1);
+    }
+}
+
+// Nothing is opened here, music starts in updateMusic once the audio loader is done
+void initMusic(MusicPlayer* music, AudioSystem* audio) {
+    music->audio = audio;
+    music->started = 0;
+    music->enabled = 0;
+    music->wanted = MUSIC_NONE;
+    music->current = MUSIC_NONE;
+    music->leaving = 0;
+    music->playing = NULL;
+    music->next = NULL;
+    music->nextTrack = MUSIC_NONE;
+    music->loading = 0;
+    music->loadTrack = MUSIC_NONE;
+    music->loaded = NULL;
+    music->loader = NULL;
+    for (int i = 0; i < MUSIC_COUNT; ++i) {
+        music->resume[i] = 0;
+    }
+    SDL_AtomicSet(&music->loadDone, 0);
+    SDL_AtomicSet(&music->quit, 0);
+    SDL_AtomicSet(&music->openStreams, 0);
+}
+
+// Start the loader, returns 0 on success. Without audio the game has no music
+int startMusic(MusicPlayer* music) {
+    if (!music->audio->open) {
+        return 1;
+    }
+    if (!(Mix_Init(MIX_INIT_MP3) & MIX_INIT_MP3)) {
+        printf("Function:startMusic, MP3 support missing, Error: %s\n", Mix_GetError());
+        return 1;
+    }
+
+    music->requested = SDL_CreateSemaphore(0);
+    music->loader = SDL_CreateThread(musicLoaderMain, "music loader", music);
+    if (music->loader == NULL) {
+        printf("Function:startMusic, loader thread creation failed, Error: %s\n", SDL_GetError());
+        SDL_DestroySemaphore(music->requested);
+        Mix_Quit();
+        return 1;
+    }
+    music->enabled = 1;
+    return 0;
+}
+
+// Ask for a track, the switch happens in updateMusic
+void playMusic(MusicPlayer* music, int track) {
+    music->wanted = track;
+}
+
+// Drive loading and fading, call once per frame
+void updateMusic(MusicPlayer* music) {
+    if (!music->started) {
+        if (!audioLoaded(music->audio)) {
+            return;
+        }
+        music->started = 1;
+        startMusic(music);
+    }
+    if (!music->enabled) {
+        return;
+    }
+
+    // Pick up a finished load, drop it if the game moved on meanwhile
+    if (music->loading && SDL_AtomicGet(&music->loadDone)) {
+        SDL_MemoryBarrierAcquire();
+        SDL_AtomicSet(&music->loadDone, 0);
+        music->loading = 0;
+        music->next = music->loaded;
+        music->nextTrack = music->loadTrack;
+        if (music->next != NULL && music->nextTrack != music->wanted) {
+            freeMusic(music, music->next);
+            music->next = NULL;
+        }
+    }
+
+    if (music->wanted == music->current) {
+        // The game asked for the current track again during its fade out: drop the track opened to replace it
+        // and fade this one back in from where it left off once the fade out is done
+        if (music->leaving) {
+            freeMusic(music, music->next);
+            music->next = NULL;
+            if (!Mix_PlayingMusic()) {
+                music->leaving = 0;
+                if (music->playing != NULL &&
+                    Mix_FadeInMusicPos(music->playing, MUSIC_LOOPS[music->current], MUSIC_FADE_MS, music->resume[music->current]) == -1) {
+                    printf("Mix_FadeInMusicPos failed: %s\n", Mix_GetError());
+                }
+            }
+        }
+        return;
+    }
+
+    // Open the wanted track while the current one fades out
+    if (music->next == NULL && !music->loading && music->wanted != MUSIC_NONE) {
+        music->loadTrack = music->wanted;
+        music->loading = 1;
+        SDL_SemPost(music->requested);
+    }
+    if (Mix_PlayingMusic() && Mix_FadingMusic() != MIX_FADING_OUT) {
+        if (MUSIC_RESUME[music->current]) {
+            // -1 when the decoder can't tell, the track then starts over
+            double position = Mix_GetMusicPosition(music->playing);
+            music->resume[music->current] = position > 0 ? position : 0;
+        }
+        Mix_FadeOutMusic(MUSIC_FADE_MS);
+        music->leaving = 1;
+    }
+
+    // Faded out, start the next one
+    if (!Mix_PlayingMusic() && (music->next != NULL || music->wanted == MUSIC_NONE)) {
+        freeMusic(music, music->playing);
+        music->playing = music->next;
+        music->current = music->wanted;
+        music->next = NULL;
+        music->leaving = 0;
+        // Seeking back into the file restarts the stream's reader at that offset
+        if (music->playing != NULL &&
+            Mix_FadeInMusicPos(music->playing, MUSIC_LOOPS[music->current], MUSIC_FADE_MS, music->resume[music->current]) == -1) {
+            printf("Mix_FadeInMusicPos failed: %s\n", Mix_GetError());
+        }
+    }
+}
+
+void closeMusic(MusicPlayer* music) {
+    if (!music->enabled) {
+        return;
+    }
+    Mix_HaltMusic();
+    SDL_AtomicSet(&music->quit, 1);
+    SDL_SemPost(music->requested);
+    SDL_WaitThread(music->loader, NULL);
+    SDL_DestroySemaphore(music->requested);
+
+    // A load that finished after the last update
+    if (music->loading && SDL_AtomicGet(&music->loadDone)) {
+        freeMusic(music, music->loaded);
+    }
+    freeMusic(music, music->next);
+    freeMusic(music, music->playing);
+    music->next = NULL;
+    music->playing = NULL;
+    music->enabled = 0;
+    Mix_Quit();
+}
@@ -0,0 +1,73 @@
+// Streaming music for the menu, game and game over screens
+// SDL_mixer decodes the MP3 a little at a time while it plays, reading from a small read-ahead ring that a
+// background thread fills from the file, so memory doesn't depend on track length. Tracks are opened on a
+// loader thread and switched with a fade out / fade in. Nothing starts before the audio loader is done, and
+// the menu track resumes where it was left instead of starting over
+
+#ifndef MUSIC_H
+#define MUSIC_H
+
+#include <SDL2/SDL.h>
+#include <SDL2/SDL_mixer.h>
+#include "audio.h"
+
+enum {
+    MUSIC_NONE = -1,
+    MUSIC_MENU,
+    MUSIC_GAME,
+    MUSIC_OVER,
+    MUSIC_COUNT
+};
+
+const int MUSIC_FADE_MS = 600;
+
+// Compressed bytes kept per open track, at most two tracks are open (the one fading out and the next one)
+const int MUSIC_STREAM_BUFFER = 64 * 1024;
+const int MUSIC_MAX_OPEN = 2;
+
+// Read-ahead ring over a music file, the decoder reads it through an SDL_RWops
+typedef struct {
+    SDL_RWops* file;
+    Sint64 size;
+    Uint8 data[MUSIC_STREAM_BUFFER];
+    int head;            // Ring index of dataStart
+    int count;           // Bytes buffered
+    Sint64 dataStart;    // File offset of the oldest buffered byte
+    Sint64 position;     // Decoder read position
+    int generation;      // Bumped when the decoder seeks outside the buffer, the reader drops reads in flight
+    int quit;
+    SDL_mutex* lock;
+    SDL_cond* changed;
+    SDL_Thread* reader;
+} MusicStream;
+
+typedef struct {
+    AudioSystem* audio;
+    int started;         // Set once the audio loader is done
+    int enabled;         // Needs an open audio device and MP3 support
+    int wanted;          // Track the game asked for
+    int current;         // Track playing or fading in
+    int leaving;         // current is fading out to switch tracks
+    Mix_Music* playing;
+    Mix_Music* next;     // Opened, waiting for playing to fade out
+    int nextTrack;
+    int loading;         // A load is in flight
+    double resume[MUSIC_COUNT];  // Seconds to seek to when the track plays again
+
+    // Loader thread
+    int loadTrack;
+    Mix_Music* loaded;
+    SDL_atomic_t loadDone;
+    SDL_atomic_t quit;
+    SDL_atomic_t openStreams;
+    SDL_sem* requested;
+    SDL_Thread* loader;
+} MusicPlayer;
+
+// Music functions, all on the game thread
+void initMusic(MusicPlayer* music, AudioSystem* audio);
+void playMusic(MusicPlayer* music, int track);
+void updateMusic(MusicPlayer* music);
+void closeMusic(MusicPlayer* music);
+
+#endif
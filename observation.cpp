@@ -0,0 +1,114 @@
+#include "observation.h"
+#include <string.h>
+
+// Walls set, every other plane empty. Built on the first call, the board size is fixed at build time
+Uint8 observationBytesBase[OBS_BYTES_SIZE];
+Uint64 observationBitsBase[OBS_CHANNELS * OBS_PLANE_WORDS];
+int observationBaseBuilt = 0;
+
+int isWallCell(int col, int row) {
+    return col == 0 || col == OBS_COLS - 1 || row == 0 || row == OBS_ROWS - 1;
+}
+
+void buildObservationBase(void) {
+    memset(observationBytesBase, 0, sizeof(observationBytesBase));
+    memset(observationBitsBase, 0, sizeof(observationBitsBase));
+    Uint8* walls = observationBytesBase + OBS_WALLS * OBS_CELLS;
+    Uint64* wallBits = observationBitsBase + OBS_WALLS * OBS_PLANE_WORDS;
+    for (int row = 0; row < OBS_ROWS; ++row) {
+        for (int col = 0; col < OBS_COLS; ++col) {
+            if (isWallCell(col, row)) {
+                walls[row * OBS_COLS + col] = 255;
+                wallBits[row * OBS_ROW_WORDS + col / 64] |= (Uint64)1 << (col % 64);
+            }
+        }
+    }
+    observationBaseBuilt = 1;
+}
+
+// Observation cell of a screen position, -1 outside the grid (a head that just left the board).
+// Negative positions turn into huge unsigned ones and fail the range check like any other
+int observationCell(int x, int y) {
+    unsigned int col = (unsigned int)x / CELL_SIZE - OBS_FIRST_COL;
+    unsigned int row = (unsigned int)y / CELL_SIZE - OBS_FIRST_ROW;
+    if (col >= (unsigned int)OBS_COLS || row >= (unsigned int)OBS_ROWS) {
+        return -1;
+    }
+    return row * OBS_COLS + col;
+}
+
+void encodeObservation(Snake* snake, Food* food, bonusFood* bonus, int bonusActive, Uint8* out) {
+    if (!observationBaseBuilt) {
+        buildObservationBase();
+    }
+    memcpy(out, observationBytesBase, OBS_BYTES_SIZE);
+
+    // Tail first so the younger of two segments on one cell (growth) wins, age falls linearly to the tail
+    Uint8* body = out + OBS_BODY * OBS_CELLS;
+    SDL_Rect* segments = snake->segments;
+    Uint32 step = (254u << 16) / (Uint32)snake->length;
+    for (int i = snake->length - 1; i >= 1; --i) {
+        unsigned int col = (unsigned int)segments[i].x / CELL_SIZE - OBS_FIRST_COL;
+        unsigned int row = (unsigned int)segments[i].y / CELL_SIZE - OBS_FIRST_ROW;
+        if (col < (unsigned int)OBS_COLS && row < (unsigned int)OBS_ROWS) {
+            body[row * OBS_COLS + col] = (Uint8)(255 - (((Uint32)i * step) >> 16));
+        }
+    }
+    int head = observationCell(snake->segments[0].x, snake->segments[0].y);
+    if (head >= 0) {
+        out[OBS_HEAD * OBS_CELLS + head] = 255;
+    }
+    int cell = observationCell(food->x, food->y);
+    if (cell >= 0) {
+        out[OBS_FOOD * OBS_CELLS + cell] = 255;
+    }
+    cell = bonusActive ? observationCell(bonus->x, bonus->y) : -1;
+    if (cell >= 0) {
+        out[OBS_BONUS * OBS_CELLS + cell] = 255;
+    }
+}
+
+void setObservationBit(Uint64* plane, int cell) {
+    int col = cell % OBS_COLS;
+    int row = cell / OBS_COLS;
+    plane[row * OBS_ROW_WORDS + col / 64] |= (Uint64)1 << (col % 64);
+}
+
+void encodeObservationBits(Snake* snake, Food* food, bonusFood* bonus, int bonusActive, Uint64* out) {
+    if (!observationBaseBuilt) {
+        buildObservationBase();
+    }
+    memcpy(out, observationBitsBase, sizeof(observationBitsBase));
+
+    Uint64* body = out + OBS_BODY * OBS_PLANE_WORDS;
+    // Neighbouring segments mostly share a word, collect their bits in a register and store once per word
+    SDL_Rect* segments = snake->segments;
+    int word = 0;
+    Uint64 bits = 0;
+    for (int i = 1; i < snake->length; ++i) {
+        unsigned int col = (unsigned int)segments[i].x / CELL_SIZE - OBS_FIRST_COL;
+        unsigned int row = (unsigned int)segments[i].y / CELL_SIZE - OBS_FIRST_ROW;
+        if (col < (unsigned int)OBS_COLS && row < (unsigned int)OBS_ROWS) {
+            int segmentWord = row * OBS_ROW_WORDS + col / 64;
+            if (segmentWord != word) {
+                body[word] |= bits;
+                word = segmentWord;
+                bits = 0;
+            }
+            bits |= (Uint64)1 << (col % 64);
+        }
+    }
+    body[word] |= bits;
+    int cell = observationCell(snake->segments[0].x, snake->segments[0].y);
+    if (cell >= 0) {
+        setObservationBit(out + OBS_HEAD * OBS_PLANE_WORDS, cell);
+    }
+    cell = observationCell(food->x, food->y);
+    if (cell >= 0) {
+        setObservationBit(out + OBS_FOOD * OBS_PLANE_WORDS, cell);
+    }
+    cell = bonusActive ? observationCell(bonus->x, bonus->y) : -1;
+    if (cell >= 0) {
+        setObservationBit(out + OBS_BONUS * OBS_PLANE_WORDS, cell);
+    }
+}
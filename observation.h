@@ -0,0 +1,41 @@
+// Observation encoder: the game state as a tensor for training and learned bots, written straight into the
+// caller's buffer instead of rendering and reading pixels back. The grid is the board's cells plus a ring of
+// wall cells around them, one plane per channel, row major. Two formats:
+//   bytes: OBS_CHANNELS planes of OBS_ROWS x OBS_COLS bytes, 255 where set, the body plane holds the segment
+//          age (255 next to the head down to 1 at the tail)
+//   bits:  OBS_CHANNELS planes of OBS_ROWS rows of OBS_ROW_WORDS 64-bit words, bit b of word w is column
+//          w * 64 + b, the body plane only says occupied
+// The constant parts (walls, empty planes) are built once and copied in, then only the snake and the food
+// are written, so an observation costs a copy of the buffer plus one write per segment
+
+#ifndef OBSERVATION_H
+#define OBSERVATION_H
+
+#include "snake.h"
+
+// Observation grid on the screen grid: board cells plus one wall cell on every side
+const int OBS_FIRST_COL = BOARD_FIRST_COL - 1;
+const int OBS_FIRST_ROW = BOARD_FIRST_ROW - 1;
+const int OBS_COLS = BOARD_COLS + 2;
+const int OBS_ROWS = BOARD_ROWS + 2;
+const int OBS_CELLS = OBS_COLS * OBS_ROWS;
+
+// Channels, in plane order
+const int OBS_HEAD = 0;
+const int OBS_BODY = 1;
+const int OBS_FOOD = 2;   // The cell the food sprite starts on
+const int OBS_BONUS = 3;  // Same for the bonus food, empty while it isn't shown
+const int OBS_WALLS = 4;
+const int OBS_CHANNELS = 5;
+
+// Buffer sizes, the bit format needs 8 byte alignment
+const int OBS_ROW_WORDS = (OBS_COLS + 63) / 64;
+const int OBS_PLANE_WORDS = OBS_ROWS * OBS_ROW_WORDS;
+const int OBS_BYTES_SIZE = OBS_CHANNELS * OBS_CELLS;
+const int OBS_BITS_SIZE = OBS_CHANNELS * OBS_PLANE_WORDS * 8;
+
+// Observation functions, call one of them once before starting threads that encode
+void encodeObservation(Snake* snake, Food* food, bonusFood* bonus, int bonusActive, Uint8* out);
+void encodeObservationBits(Snake* snake, Food* food, bonusFood* bonus, int bonusActive, Uint64* out);
+
+#endif
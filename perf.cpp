@@ -0,0 +1,128 @@
+#include "perf.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+// Maximum number of recorded startup steps (one per phase or asset)
+const int STARTUP_MAX_MARKS = 64;
+
+typedef struct {
+    const char *phase;
+    const char *asset;
+    double ms;
+} StartupMark;
+
+StartupMark startupMarks[STARTUP_MAX_MARKS];
+int startupMarkCount = 0;
+Uint64 startupFirst = 0;
+Uint64 startupLast = 0;
+
+Uint64 perfNow(void) {
+    return SDL_GetPerformanceCounter();
+}
+
+double perfMs(Uint64 startCounter, Uint64 endCounter) {
+    return (double)(endCounter - startCounter) * 1000.0 / (double)SDL_GetPerformanceFrequency();
+}
+
+// Start the startup clock, call this first thing in main
+void startupBegin(void) {
+    startupMarkCount = 0;
+    startupFirst = perfNow();
+    startupLast = startupFirst;
+}
+
+// Record the time spent since the previous mark under a phase name (asset may be NULL)
+void startupMark(const char *phase, const char *asset) {
+    Uint64 now = perfNow();
+    if (startupMarkCount < STARTUP_MAX_MARKS) {
+        startupMarks[startupMarkCount].phase = phase;
+        startupMarks[startupMarkCount].asset = asset;
+        startupMarks[startupMarkCount].ms = perfMs(startupLast, now);
+        startupMarkCount++;
+    }
+    startupLast = now;
+}
+
+double startupTotalMs(void) {
+    return perfMs(startupFirst, startupLast);
+}
+
+// Print every asset and the total per phase, phases keep the order they were first seen
+void startupReport(void) {
+    // Tools that link the renderer without timing startup
+    if (startupFirst == 0) {
+        return;
+    }
+    printf("Startup breakdown:\n");
+    for (int i = 0; i < startupMarkCount; ++i) {
+        if (startupMarks[i].asset != NULL) {
+            printf("  %-12s %-32s %8.3f ms\n", startupMarks[i].phase, startupMarks[i].asset, startupMarks[i].ms);
+        }
+    }
+    for (int i = 0; i < startupMarkCount; ++i) {
+        // Skip phases that were already summed
+        int seen = 0;
+        for (int j = 0; j < i; ++j) {
+            if (strcmp(startupMarks[j].phase, startupMarks[i].phase) == 0) {
+                seen = 1;
+                break;
+            }
+        }
+        if (seen) {
+            continue;
+        }
+
+        double phaseMs = 0;
+        for (int j = i; j < startupMarkCount; ++j) {
+            if (strcmp(startupMarks[j].phase, startupMarks[i].phase) == 0) {
+                phaseMs += startupMarks[j].ms;
+            }
+        }
+        printf("  phase %-12s %8.3f ms\n", startupMarks[i].phase, phaseMs);
+    }
+    // Machine readable line used by startup_bench
+    printf("Startup total: %.3f ms\n", startupTotalMs());
+    fflush(stdout);
+}
+
+void resetLatency(LatencyStats* stats) {
+    stats->count = 0;
+}
+
+void recordLatency(LatencyStats* stats, double ms) {
+    stats->ms[stats->count % LATENCY_SAMPLES] = ms;
+    stats->count++;
+}
+
+int compareMs(const void* a, const void* b) {
+    double x = *(const double*)a;
+    double y = *(const double*)b;
+    return (x > y) - (x < y);
+}
+
+// Nearest-rank percentile over the kept samples, 0 without samples
+double latencyPercentile(LatencyStats* stats, double p) {
+    static double sorted[LATENCY_SAMPLES];
+    int count = stats->count < LATENCY_SAMPLES ? stats->count : LATENCY_SAMPLES;
+    if (count == 0) {
+        return 0;
+    }
+    memcpy(sorted, stats->ms, sizeof(double) * count);
+    qsort(sorted, count, sizeof(double), compareMs);
+    int rank = (int)(p / 100.0 * count + 0.5);
+    if (rank < 1) {
+        rank = 1;
+    }
+    if (rank > count) {
+        rank = count;
+    }
+    return sorted[rank - 1];
+}
+
+void reportLatency(const char* label, LatencyStats* stats) {
+    if (stats->count == 0) {
+        return;
+    }
+    printf("%s: n=%d p50=%.2f ms p99=%.2f ms\n", label, stats->count, latencyPercentile(stats, 50), latencyPercentile(stats, 99));
+}
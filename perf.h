@@ -0,0 +1,32 @@
+// Performance timing helpers for the snake game
+// All times are taken with SDL_GetPerformanceCounter, which works before SDL_Init
+
+#ifndef PERF_H
+#define PERF_H
+
+#include <SDL2/SDL.h>
+
+// Timer functions
+Uint64 perfNow(void);
+double perfMs(Uint64 startCounter, Uint64 endCounter);
+
+// Startup phase timing (process start -> first presented menu frame)
+void startupBegin(void);
+void startupMark(const char *phase, const char *asset);
+double startupTotalMs(void);
+void startupReport(void);
+
+// Latency samples (ms), keeps the most recent LATENCY_SAMPLES
+const int LATENCY_SAMPLES = 1024;
+
+typedef struct {
+    double ms[LATENCY_SAMPLES];
+    int count;  // Samples recorded in total
+} LatencyStats;
+
+void resetLatency(LatencyStats* stats);
+void recordLatency(LatencyStats* stats, double ms);
+double latencyPercentile(LatencyStats* stats, double p);
+void reportLatency(const char* label, LatencyStats* stats);
+
+#endif
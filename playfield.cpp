@@ -0,0 +1,171 @@
+#include "playfield.h"
+#include "trace.h"
+
+static_assert(TEX_SPRITES + SPRITE_COUNT == TEX_LAYER, "render.h must reserve one texture per snake sprite");
+
+void initPlayfield(Playfield* playfield, int layerSupported) {
+    playfield->hasLayer = layerSupported;
+}
+
+// Redraw the whole layer, once per game and after the renderer lost its targets
+void resetPlayfield(Playfield* playfield, Snake* snake, RenderList* list) {
+    if (!playfield->hasLayer) {
+        return;
+    }
+    pushTarget(list, TEX_LAYER);
+    pushCopy(list, TEX_GAME_BG, NULL, NULL);
+    renderSnake(snake, list);
+    pushTarget(list, TEX_SCREEN);
+}
+
+// Add a segment to the draw list if its sprite overlaps the dirty rect
+void collectSegment(Snake* snake, int idx, SDL_Rect* dirty, int* found, int* count) {
+    if (idx < 0) {
+        return;
+    }
+    for (int i = 0; i < *count; ++i) {
+        if (found[i] == idx) {
+            return;
+        }
+    }
+    SDL_Rect segmentRect = {snake->segments[idx].x, snake->segments[idx].y, SEGMENT_WIDTH, SEGMENT_HEIGHT};
+    if (SDL_HasIntersection(&segmentRect, dirty)) {
+        found[(*count)++] = idx;
+    }
+}
+
+// Restore the background under a rect and redraw the segments overlapping it, in the same order as renderSnake
+void redrawRect(Snake* snake, SDL_Rect* dirty, RenderList* list) {
+    pushClip(list, dirty);
+    pushCopy(list, TEX_GAME_BG, dirty, dirty);
+
+    // Sprites are bigger than a cell, so only the 3x3 cells around the rect can overlap it
+    int found[12];
+    int count = 0;
+    int col = dirty->x / CELL_SIZE;
+    int row = dirty->y / CELL_SIZE;
+    for (int dy = -1; dy <= 1; ++dy) {
+        for (int dx = -1; dx <= 1; ++dx) {
+            collectSegment(snake, snakeSegmentAt(snake, col + dx, row + dy), dirty, found, &count);
+        }
+    }
+    // Head and tail may share a cell with other segments (e.g. right after growing)
+    collectSegment(snake, 0, dirty, found, &count);
+    collectSegment(snake, snake->length - 1, dirty, found, &count);
+
+    // Head first and tail last, like a full redraw
+    for (int i = 1; i < count; ++i) {
+        int idx = found[i];
+        int j = i - 1;
+        while (j >= 0 && found[j] > idx) {
+            found[j + 1] = found[j];
+            --j;
+        }
+        found[j + 1] = idx;
+    }
+    for (int i = 0; i < count; ++i) {
+        renderSegment(snake, found[i], list);
+    }
+}
+
+// Per tick update: only the vacated tail cell, the new tail, the old head (now body or joint) and the new head change
+// The same rects are the snake's screen damage for the frame
+void updatePlayfield(Playfield* playfield, Snake* snake, SDL_Rect oldTail, RenderList* list) {
+    TRACE_SCOPE("updatePlayfield");
+    SDL_Rect dirty[4];
+    dirty[0] = oldTail;
+    dirty[1] = snake->segments[snake->length - 1];
+    dirty[2] = snake->segments[1];
+    dirty[3] = snake->segments[0];
+    for (int i = 0; i < 4; ++i) {
+        dirty[i].w = SEGMENT_WIDTH;
+        dirty[i].h = SEGMENT_HEIGHT;
+        damageAdd(&list->damage, dirty[i]);
+    }
+
+    // Without the layer the whole snake is drawn every frame, so a full damage is needed
+    if (!playfield->hasLayer) {
+        damageAddFull(&list->damage);
+        return;
+    }
+
+    pushTarget(list, TEX_LAYER);
+    for (int i = 0; i < 4; ++i) {
+        redrawRect(snake, &dirty[i], list);
+    }
+    pushClip(list, NULL);
+    pushTarget(list, TEX_SCREEN);
+}
+
+// Draw the playfield to the screen
+void renderPlayfield(Playfield* playfield, Snake* snake, RenderList* list) {
+    if (playfield->hasLayer) {
+        pushCopy(list, TEX_LAYER, NULL, NULL);
+    } else {
+        pushCopy(list, TEX_GAME_BG, NULL, NULL);
+        renderSnake(snake, list);
+    }
+}
+
+// Snake game rendering logic, every segment
+void renderSnake(Snake* snake, RenderList* list) {
+    TRACE_SCOPE("renderSnake");
+    for (int i = 0; i < snake->length; ++i) {
+        renderSegment(snake, i, list);
+    }
+}
+
+// ** Caution: COMPLEX LOGIC ** ANY CHANGE WILL COST SEVERE DAMAGE TO THE SNAKE BODY :)
+// Render one segment, the sprite depends on the neighbouring segments
+void renderSegment(Snake* snake, int i, RenderList* list) {
+    SDL_Rect* segments = snake->segments;
+    SDL_Rect segmentRect = {segments[i].x, segments[i].y, SEGMENT_WIDTH, SEGMENT_HEIGHT};
+    int sprite;
+
+    if (i == 0) {
+        // Render snake head, facing the last move
+        switch (snake->directions[0]) {
+            case 2: sprite = SPRITE_HEAD_LEFT; break;
+            case 3: sprite = SPRITE_HEAD_DOWN; break;
+            case 4: sprite = SPRITE_HEAD_UP; break;
+            default: sprite = SPRITE_HEAD_RIGHT; break;
+        }
+    } else if (i == snake->length - 1) {
+        // Determine the tail texture based on the direction of the last segment
+        if (segments[i].x > segments[i - 1].x) {
+            sprite = SPRITE_TAIL_LEFT;
+        } else if (segments[i].x < segments[i - 1].x) {
+            sprite = SPRITE_TAIL_RIGHT;
+        } else if (segments[i].y > segments[i - 1].y) {
+            sprite = SPRITE_TAIL_UP;
+        } else if (segments[i].y < segments[i - 1].y) {
+            sprite = SPRITE_TAIL_DOWN;
+        } else {
+            // Tail waiting on the segment before it after growing, keep facing the way it moved
+            switch (snake->directions[i]) {
+                case 2: sprite = SPRITE_TAIL_LEFT; break;
+                case 3: sprite = SPRITE_TAIL_DOWN; break;
+                case 4: sprite = SPRITE_TAIL_UP; break;
+                default: sprite = SPRITE_TAIL_RIGHT; break;
+            }
+        }
+    } else if ((segments[i].y > segments[i - 1].y && segments[i].x == segments[i - 1].x && segments[i].x > segments[i + 1].x && segments[i].y == segments[i + 1].y)
+        || (segments[i].y == segments[i - 1].y && segments[i].x > segments[i - 1].x && segments[i].x == segments[i + 1].x && segments[i].y > segments[i + 1].y)) {
+        sprite = SPRITE_RIGHT_UP;
+    } else if ((segments[i].y > segments[i - 1].y && segments[i].x == segments[i - 1].x && segments[i].x < segments[i + 1].x && segments[i].y == segments[i + 1].y)
+        || (segments[i].y == segments[i - 1].y && segments[i].x < segments[i - 1].x && segments[i].x == segments[i + 1].x && segments[i].y > segments[i + 1].y)) {
+        sprite = SPRITE_LEFT_UP;
+    } else if ((segments[i].y < segments[i - 1].y && segments[i].x == segments[i - 1].x && segments[i].x > segments[i + 1].x && segments[i].y == segments[i + 1].y)
+        || (segments[i].y == segments[i - 1].y && segments[i].x > segments[i - 1].x && segments[i].x == segments[i + 1].x && segments[i].y < segments[i + 1].y)) {
+        sprite = SPRITE_RIGHT_DOWN;
+    } else if ((segments[i].y < segments[i - 1].y && segments[i].x == segments[i - 1].x && segments[i].x < segments[i + 1].x && segments[i].y == segments[i + 1].y)
+        || (segments[i].y == segments[i - 1].y && segments[i].x < segments[i - 1].x && segments[i].x == segments[i + 1].x && segments[i].y < segments[i + 1].y)) {
+        sprite = SPRITE_LEFT_DOWN;
+    } else if (segments[i].x == segments[i - 1].x) {
+        sprite = SPRITE_BODY_VERTICAL;
+    } else {
+        sprite = SPRITE_BODY_HORIZONTAL;
+    }
+
+    pushCopy(list, TEX_SPRITES + sprite, NULL, &segmentRect);
+}
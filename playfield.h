@@ -0,0 +1,42 @@
+// Persistent playfield layer: the game background and the snake body live in a render target texture,
+// each tick only the cells that changed are redrawn instead of the whole snake
+
+#ifndef PLAYFIELD_H
+#define PLAYFIELD_H
+
+#include <SDL2/SDL.h>
+#include "snake.h"
+#include "render.h"
+
+// Snake sprites, texture TEX_SPRITES + sprite
+enum {
+    SPRITE_HEAD_UP,
+    SPRITE_HEAD_DOWN,
+    SPRITE_HEAD_LEFT,
+    SPRITE_HEAD_RIGHT,
+    SPRITE_BODY_HORIZONTAL,
+    SPRITE_BODY_VERTICAL,
+    SPRITE_TAIL_UP,
+    SPRITE_TAIL_DOWN,
+    SPRITE_TAIL_LEFT,
+    SPRITE_TAIL_RIGHT,
+    SPRITE_LEFT_DOWN,
+    SPRITE_RIGHT_DOWN,
+    SPRITE_RIGHT_UP,
+    SPRITE_LEFT_UP,
+    SPRITE_COUNT
+};
+
+typedef struct {
+    int hasLayer;  // TEX_LAYER exists, otherwise the playfield is redrawn in full every frame
+} Playfield;
+
+// Playfield functions, they record render commands
+void initPlayfield(Playfield* playfield, int layerSupported);
+void resetPlayfield(Playfield* playfield, Snake* snake, RenderList* list);
+void updatePlayfield(Playfield* playfield, Snake* snake, SDL_Rect oldTail, RenderList* list);
+void renderPlayfield(Playfield* playfield, Snake* snake, RenderList* list);
+void renderSnake(Snake* snake, RenderList* list);
+void renderSegment(Snake* snake, int i, RenderList* list);
+
+#endif
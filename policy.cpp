@@ -0,0 +1,529 @@
+#include "policy.h"
+#include "observation.h"
+#include "autopilot.h"
+#include "perf.h"
+#include <stdio.h>
+#include <string.h>
+
+#if defined(__x86_64__) || defined(__i386__)
+#define POLICY_X86 1
+#include <immintrin.h>
+#endif
+
+// Weights one dense block covers, 16 KB
+const int POLICY_BLOCK_FLOATS = 4096;
+
+// out[o] += sum of values[i] * rows[i * outputs + o]
+void addRowsScalar(float* out, const float* rows, const float* values, int inputs, int outputs) {
+    for (int i = 0; i < inputs; ++i) {
+        const float* row = rows + (size_t)i * outputs;
+        for (int o = 0; o < outputs; ++o) {
+            out[o] += values[i] * row[o];
+        }
+    }
+}
+
+void reluScalar(float* values, int count) {
+    for (int i = 0; i < count; ++i) {
+        values[i] = values[i] > 0 ? values[i] : 0;
+    }
+}
+
+// The SIMD kernels are compiled for their instruction set whatever the build flags, and only called when the
+// CPU has it. They keep 8 outputs (32 with AVX2 while there are that many) in registers over all the inputs.
+// Zero inputs are multiplied like any other, past the first layer a branch on them costs more than it saves.
+// Loads are unaligned, the buffers are aligned anyway
+#ifdef POLICY_X86
+__attribute__((target("sse2"))) void addRowsSse2(float* out, const float* rows, const float* values, int inputs, int outputs) {
+    for (int o = 0; o < outputs; o += 8) {
+        __m128 low = _mm_loadu_ps(out + o);
+        __m128 high = _mm_loadu_ps(out + o + 4);
+        const float* row = rows + o;
+        for (int i = 0; i < inputs; ++i, row += outputs) {
+            __m128 factor = _mm_set1_ps(values[i]);
+            low = _mm_add_ps(low, _mm_mul_ps(factor, _mm_loadu_ps(row)));
+            high = _mm_add_ps(high, _mm_mul_ps(factor, _mm_loadu_ps(row + 4)));
+        }
+        _mm_storeu_ps(out + o, low);
+        _mm_storeu_ps(out + o + 4, high);
+    }
+}
+
+__attribute__((target("sse2"))) void reluSse2(float* values, int count) {
+    __m128 zero = _mm_setzero_ps();
+    for (int i = 0; i < count; i += 4) {
+        _mm_storeu_ps(values + i, _mm_max_ps(_mm_loadu_ps(values + i), zero));
+    }
+}
+
+__attribute__((target("avx2,fma"))) void addRowsAvx2(float* out, const float* rows, const float* values, int inputs, int outputs) {
+    int o = 0;
+    for (; o + 32 <= outputs; o += 32) {
+        __m256 sum0 = _mm256_loadu_ps(out + o);
+        __m256 sum1 = _mm256_loadu_ps(out + o + 8);
+        __m256 sum2 = _mm256_loadu_ps(out + o + 16);
+        __m256 sum3 = _mm256_loadu_ps(out + o + 24);
+        const float* row = rows + o;
+        for (int i = 0; i < inputs; ++i, row += outputs) {
+            __m256 factor = _mm256_set1_ps(values[i]);
+            sum0 = _mm256_fmadd_ps(factor, _mm256_loadu_ps(row), sum0);
+            sum1 = _mm256_fmadd_ps(factor, _mm256_loadu_ps(row + 8), sum1);
+            sum2 = _mm256_fmadd_ps(factor, _mm256_loadu_ps(row + 16), sum2);
+            sum3 = _mm256_fmadd_ps(factor, _mm256_loadu_ps(row + 24), sum3);
+        }
+        _mm256_storeu_ps(out + o, sum0);
+        _mm256_storeu_ps(out + o + 8, sum1);
+        _mm256_storeu_ps(out + o + 16, sum2);
+        _mm256_storeu_ps(out + o + 24, sum3);
+    }
+    for (; o < outputs; o += 8) {
+        __m256 sum = _mm256_loadu_ps(out + o);
+        const float* row = rows + o;
+        for (int i = 0; i < inputs; ++i, row += outputs) {
+            sum = _mm256_fmadd_ps(_mm256_set1_ps(values[i]), _mm256_loadu_ps(row), sum);
+        }
+        _mm256_storeu_ps(out + o, sum);
+    }
+}
+
+__attribute__((target("avx2,fma"))) void reluAvx2(float* values, int count) {
+    __m256 zero = _mm256_setzero_ps();
+    for (int i = 0; i < count; i += 8) {
+        _mm256_storeu_ps(values + i, _mm256_max_ps(_mm256_loadu_ps(values + i), zero));
+    }
+}
+#endif
+
+// Best of the requested kernel set and what the CPU runs, returns the set picked
+int setPolicyKernels(Policy* policy, int kernels) {
+    policy->kernels = POLICY_SCALAR;
+    policy->addRows = addRowsScalar;
+    policy->relu = reluScalar;
+#ifdef POLICY_X86
+    if (kernels >= POLICY_AVX2 && SDL_HasAVX2() && __builtin_cpu_supports("fma")) {
+        policy->kernels = POLICY_AVX2;
+        policy->addRows = addRowsAvx2;
+        policy->relu = reluAvx2;
+    } else if (kernels >= POLICY_SSE2 && SDL_HasSSE2()) {
+        policy->kernels = POLICY_SSE2;
+        policy->addRows = addRowsSse2;
+        policy->relu = reluSse2;
+    }
+#endif
+    return policy->kernels;
+}
+
+int readPolicyInts(FILE* file, Uint32* values, int count) {
+    if (fread(values, sizeof(Uint32), count, file) != (size_t)count) {
+        return 1;
+    }
+    for (int i = 0; i < count; ++i) {
+        values[i] = SDL_SwapLE32(values[i]);
+    }
+    return 0;
+}
+
+// rows of rowLength floats, stored stride floats apart in out
+int readPolicyFloats(FILE* file, float* out, int rows, int rowLength, int stride) {
+    for (int r = 0; r < rows; ++r) {
+        float* row = out + (size_t)r * stride;
+        if (fread(row, sizeof(float), rowLength, file) != (size_t)rowLength) {
+            return 1;
+        }
+        for (int i = 0; i < rowLength; ++i) {
+            row[i] = SDL_SwapFloatLE(row[i]);
+        }
+    }
+    return 0;
+}
+
+int roundUp8(int value) {
+    return (value + 7) & ~7;
+}
+
+// Sizes of a layer from the previous one's output, then its weights. Returns 0 on success
+int loadPolicyLayer(FILE* file, PolicyLayer* layer, PolicyLayer* previous) {
+    Uint32 fields[4];
+    if (readPolicyInts(file, fields, 4) != 0) {
+        return 1;
+    }
+    layer->type = (int)fields[0];
+    layer->outChannels = (int)fields[1];
+    layer->stride = (int)fields[2];
+    layer->relu = fields[3] != 0;
+    layer->inRows = previous->outRows;
+    layer->inCols = previous->outCols;
+    layer->inChannels = previous->outChannels;
+    layer->inStride = previous->outStride;
+    if (layer->outChannels < 1 || layer->outChannels > 4096) {
+        return 1;
+    }
+    layer->outStride = roundUp8(layer->outChannels);
+
+    // Weight rows per input cell (one per kernel position for a convolution), each padded to inStride rows
+    int groups;
+    if (layer->type == POLICY_CONV) {
+        if (layer->stride < 1 || layer->stride > 4) {
+            return 1;
+        }
+        layer->outRows = (layer->inRows - 1) / layer->stride + 1;
+        layer->outCols = (layer->inCols - 1) / layer->stride + 1;
+        groups = 9;
+    } else if (layer->type == POLICY_DENSE) {
+        layer->outRows = 1;
+        layer->outCols = 1;
+        groups = layer->inRows * layer->inCols;
+    } else {
+        return 1;
+    }
+
+    size_t groupFloats = (size_t)layer->inStride * layer->outStride;
+    size_t weightFloats = groups * groupFloats;
+    layer->weights = (float*)SDL_SIMDAlloc(weightFloats * sizeof(float));
+    layer->bias = (float*)SDL_SIMDAlloc(layer->outStride * sizeof(float));
+    if (layer->weights == NULL || layer->bias == NULL) {
+        return 1;
+    }
+    memset(layer->weights, 0, weightFloats * sizeof(float));
+    memset(layer->bias, 0, layer->outStride * sizeof(float));
+    for (int g = 0; g < groups; ++g) {
+        if (readPolicyFloats(file, layer->weights + g * groupFloats, layer->inChannels, layer->outChannels,
+                             layer->outStride) != 0) {
+            return 1;
+        }
+    }
+    return readPolicyFloats(file, layer->bias, 1, layer->outChannels, layer->outStride);
+}
+
+void policyObserve(Policy* policy, int slot, Snake* snake, Food* food) {
+    bonusFood bonus;
+    bonus.x = 0;
+    bonus.y = 0;
+    encodeObservation(snake, food, &bonus, 0, policy->observations + (size_t)slot * OBS_BYTES_SIZE);
+}
+
+// 3x3 convolution of one game: each output cell starts from the bias and adds the weights of its inputs.
+// The three input cells of a kernel row sit next to each other, and so do their weights, one call takes them
+void runConvLayer(Policy* policy, PolicyLayer* layer, const float* in, float* out) {
+    int cellFloats = layer->inStride * layer->outStride;
+    for (int row = 0; row < layer->outRows; ++row) {
+        for (int col = 0; col < layer->outCols; ++col) {
+            float* cell = out + (row * layer->outCols + col) * layer->outStride;
+            memcpy(cell, layer->bias, layer->outStride * sizeof(float));
+            int firstCol = col * layer->stride - 1;
+            for (int dy = 0; dy < 3; ++dy) {
+                int inRow = row * layer->stride + dy - 1;
+                if (inRow < 0 || inRow >= layer->inRows) {
+                    continue;
+                }
+                const float* values = in + (inRow * layer->inCols + firstCol) * layer->inStride;
+                const float* weights = layer->weights + dy * 3 * cellFloats;
+                if (firstCol >= 0 && firstCol + 2 < layer->inCols) {
+                    policy->addRows(cell, weights, values, 3 * layer->inStride, layer->outStride);
+                    continue;
+                }
+                for (int dx = 0; dx < 3; ++dx) {
+                    if (firstCol + dx >= 0 && firstCol + dx < layer->inCols) {
+                        policy->addRows(cell, weights + dx * cellFloats, values + dx * layer->inStride,
+                                        layer->inStride, layer->outStride);
+                    }
+                }
+            }
+            if (layer->relu) {
+                policy->relu(cell, layer->outStride);
+            }
+        }
+    }
+}
+
+// Dense layer of the whole batch, in blocks of weight rows small enough to stay in the cache while every
+// game adds its inputs for them
+void runDenseLayer(Policy* policy, PolicyLayer* layer, const float* in, float* out, int count) {
+    int slot = policy->slotFloats;
+    for (int s = 0; s < count; ++s) {
+        memcpy(out + (size_t)s * slot, layer->bias, layer->outStride * sizeof(float));
+    }
+    int inputs = layer->inRows * layer->inCols * layer->inStride;
+    int block = POLICY_BLOCK_FLOATS / layer->outStride;
+    block = block < 8 ? 8 : block;
+    for (int first = 0; first < inputs; first += block) {
+        int rows = inputs - first < block ? inputs - first : block;
+        const float* weights = layer->weights + (size_t)first * layer->outStride;
+        for (int s = 0; s < count; ++s) {
+            policy->addRows(out + (size_t)s * slot, weights, in + (size_t)s * slot + first, rows, layer->outStride);
+        }
+    }
+    if (layer->relu) {
+        for (int s = 0; s < count; ++s) {
+            policy->relu(out + (size_t)s * slot, layer->outStride);
+        }
+    }
+}
+
+// The walls never change, their part of the first layer is added to its bias once: the first layer's output
+// for an observation with nothing but walls, before ReLU
+void buildFirstBase(Policy* policy) {
+    float* walls = policy->inputs;
+    for (int row = 0; row < OBS_ROWS; ++row) {
+        for (int col = 0; col < OBS_COLS; ++col) {
+            if (row == 0 || row == OBS_ROWS - 1 || col == 0 || col == OBS_COLS - 1) {
+                walls[(row * OBS_COLS + col) * POLICY_INPUT_STRIDE + OBS_WALLS] = 1.0f;
+            }
+        }
+    }
+    PolicyLayer* first = &policy->layers[0];
+    int relu = first->relu;
+    first->relu = 0;
+    if (first->type == POLICY_CONV) {
+        runConvLayer(policy, first, walls, policy->firstBase);
+    } else {
+        runDenseLayer(policy, first, walls, policy->firstBase, 1);
+    }
+    first->relu = relu;
+    memset(walls, 0, POLICY_INPUT_FLOATS * sizeof(float));
+}
+
+// Byte planes of a slot to row, column, channel floats, walls left out. Only the cells set last time are
+// cleared, the words of 8 empty cells are skipped whole. Lists the cells that are set
+void convertObservation(Policy* policy, int slot) {
+    const Uint8* planes = policy->observations + (size_t)slot * OBS_BYTES_SIZE;
+    float* cells = policy->inputs + (size_t)slot * POLICY_INPUT_FLOATS;
+    int* list = policy->inputCells + (size_t)slot * OBS_CELLS;
+    for (int i = 0; i < policy->inputCounts[slot]; ++i) {
+        memset(cells + list[i] * POLICY_INPUT_STRIDE, 0, POLICY_INPUT_STRIDE * sizeof(float));
+    }
+    int count = 0;
+    for (int c = 0; c < OBS_CHANNELS; ++c) {
+        if (c == OBS_WALLS) {
+            continue;
+        }
+        const Uint8* plane = planes + c * OBS_CELLS;
+        for (int word = 0; word < OBS_CELLS; word += 8) {
+            Uint64 bytes = 0;
+            int length = OBS_CELLS - word < 8 ? OBS_CELLS - word : 8;
+            memcpy(&bytes, plane + word, length);
+            if (bytes == 0) {
+                continue;
+            }
+            for (int cell = word; cell < word + length; ++cell) {
+                if (plane[cell] == 0) {
+                    continue;
+                }
+                float* values = cells + cell * POLICY_INPUT_STRIDE;
+                int empty = 1;
+                for (int k = 0; k < c; ++k) {
+                    empty = empty && values[k] == 0;
+                }
+                if (empty) {
+                    list[count++] = cell;
+                }
+                values[c] = plane[cell] * (1.0f / 255.0f);
+            }
+        }
+    }
+    policy->inputCounts[slot] = count;
+}
+
+// First layer of a slot from its listed cells: the base, plus for a convolution each cell's weights into the
+// up to 3x3 outputs that see it, for a dense layer each cell's weight rows
+void runFirstLayer(Policy* policy, int slot, float* out) {
+    PolicyLayer* layer = &policy->layers[0];
+    const float* cells = policy->inputs + (size_t)slot * POLICY_INPUT_FLOATS;
+    const int* list = policy->inputCells + (size_t)slot * OBS_CELLS;
+    int count = policy->inputCounts[slot];
+    int outputs = layer->outRows * layer->outCols * layer->outStride;
+    int cellFloats = layer->inStride * layer->outStride;
+    memcpy(out, policy->firstBase, outputs * sizeof(float));
+    for (int i = 0; i < count; ++i) {
+        int cell = list[i];
+        const float* values = cells + cell * POLICY_INPUT_STRIDE;
+        if (layer->type == POLICY_DENSE) {
+            policy->addRows(out, layer->weights + (size_t)cell * cellFloats, values, layer->inStride, layer->outStride);
+            continue;
+        }
+        int inRow = cell / OBS_COLS;
+        int inCol = cell % OBS_COLS;
+        for (int dy = 0; dy < 3; ++dy) {
+            int row = inRow + 1 - dy;
+            if (row < 0 || row % layer->stride != 0 || row / layer->stride >= layer->outRows) {
+                continue;
+            }
+            for (int dx = 0; dx < 3; ++dx) {
+                int col = inCol + 1 - dx;
+                if (col < 0 || col % layer->stride != 0 || col / layer->stride >= layer->outCols) {
+                    continue;
+                }
+                float* target = out + ((row / layer->stride) * layer->outCols + col / layer->stride) * layer->outStride;
+                policy->addRows(target, layer->weights + (dy * 3 + dx) * cellFloats, values, layer->inStride,
+                                layer->outStride);
+            }
+        }
+    }
+    if (layer->relu) {
+        policy->relu(out, outputs);
+    }
+}
+
+void freePolicy(Policy* policy) {
+    for (int i = 0; i < policy->layerCount; ++i) {
+        SDL_SIMDFree(policy->layers[i].weights);
+        SDL_SIMDFree(policy->layers[i].bias);
+    }
+    SDL_SIMDFree(policy->activations[0]);
+    SDL_SIMDFree(policy->activations[1]);
+    SDL_free(policy->observations);
+    SDL_SIMDFree(policy->inputs);
+    SDL_free(policy->inputCells);
+    SDL_free(policy->inputCounts);
+    SDL_SIMDFree(policy->firstBase);
+    policy->layerCount = 0;
+    policy->inputs = NULL;
+    policy->inputCells = NULL;
+    policy->inputCounts = NULL;
+    policy->firstBase = NULL;
+    policy->activations[0] = NULL;
+    policy->activations[1] = NULL;
+    policy->observations = NULL;
+}
+
+int loadPolicy(Policy* policy, const char* path, int batch) {
+    memset(policy, 0, sizeof(Policy));
+    setPolicyKernels(policy, POLICY_AVX2);
+    if (batch < 1 || batch > POLICY_MAX_BATCH) {
+        printf("Function:loadPolicy, batch %d is not 1..%d\n", batch, POLICY_MAX_BATCH);
+        return 1;
+    }
+    policy->batch = batch;
+    FILE* file = fopen(path, "rb");
+    if (file == NULL) {
+        printf("Function:loadPolicy, Unable to open %s\n", path);
+        return 1;
+    }
+
+    char magic[4];
+    Uint32 header[5];
+    int failed = fread(magic, 1, 4, file) != 4 || memcmp(magic, "SNKP", 4) != 0 || readPolicyInts(file, header, 5) != 0;
+    if (!failed && (header[0] != 1 || header[1] != (Uint32)OBS_ROWS || header[2] != (Uint32)OBS_COLS ||
+                    header[3] != (Uint32)OBS_CHANNELS || header[4] < 1 || header[4] > (Uint32)POLICY_MAX_LAYERS)) {
+        printf("Function:loadPolicy, %s is for another board or version\n", path);
+        failed = 1;
+    }
+
+    // The observation as the output of a layer before the first
+    PolicyLayer input;
+    input.outRows = OBS_ROWS;
+    input.outCols = OBS_COLS;
+    input.outChannels = OBS_CHANNELS;
+    input.outStride = roundUp8(OBS_CHANNELS);
+    policy->slotFloats = 0;
+    PolicyLayer* previous = &input;
+    for (int i = 0; !failed && i < (int)header[4]; ++i) {
+        PolicyLayer* layer = &policy->layers[i];
+        policy->layerCount = i + 1;
+        failed = loadPolicyLayer(file, layer, previous);
+        int floats = layer->outRows * layer->outCols * layer->outStride;
+        policy->slotFloats = floats > policy->slotFloats ? floats : policy->slotFloats;
+        previous = layer;
+    }
+    fclose(file);
+    if (!failed && (previous->type != POLICY_DENSE || previous->outChannels != POLICY_ACTIONS)) {
+        printf("Function:loadPolicy, the last layer of %s must be dense with %d outputs\n", path, POLICY_ACTIONS);
+        failed = 1;
+    }
+
+    if (!failed) {
+        size_t floats = (size_t)batch * policy->slotFloats;
+        policy->activations[0] = (float*)SDL_SIMDAlloc(floats * sizeof(float));
+        policy->activations[1] = (float*)SDL_SIMDAlloc(floats * sizeof(float));
+        policy->observations = (Uint8*)SDL_malloc((size_t)batch * OBS_BYTES_SIZE);
+        policy->inputs = (float*)SDL_SIMDAlloc((size_t)batch * POLICY_INPUT_FLOATS * sizeof(float));
+        policy->inputCells = (int*)SDL_malloc((size_t)batch * OBS_CELLS * sizeof(int));
+        policy->inputCounts = (int*)SDL_malloc(batch * sizeof(int));
+        PolicyLayer* first = &policy->layers[0];
+        policy->firstBase = (float*)SDL_SIMDAlloc(first->outRows * first->outCols * first->outStride * sizeof(float));
+        failed = policy->activations[0] == NULL || policy->activations[1] == NULL || policy->observations == NULL ||
+                 policy->inputs == NULL || policy->inputCells == NULL || policy->inputCounts == NULL ||
+                 policy->firstBase == NULL;
+    }
+    if (!failed) {
+        memset(policy->inputs, 0, (size_t)batch * POLICY_INPUT_FLOATS * sizeof(float));
+        memset(policy->inputCounts, 0, batch * sizeof(int));
+        buildFirstBase(policy);
+    }
+    if (failed) {
+        printf("Function:loadPolicy, loading %s failed\n", path);
+        freePolicy(policy);
+        return 1;
+    }
+    return 0;
+}
+
+// Move scores of the first count slots, into logits
+void runPolicy(Policy* policy, int count) {
+    Uint64 start = perfNow();
+    int slot = policy->slotFloats;
+    for (int s = 0; s < count; ++s) {
+        convertObservation(policy, s);
+        runFirstLayer(policy, s, policy->activations[0] + (size_t)s * slot);
+    }
+
+    int current = 0;
+    for (int i = 1; i < policy->layerCount; ++i) {
+        PolicyLayer* layer = &policy->layers[i];
+        float* out = policy->activations[1 - current];
+        if (layer->type == POLICY_CONV) {
+            for (int s = 0; s < count; ++s) {
+                runConvLayer(policy, layer, policy->activations[current] + (size_t)s * slot, out + (size_t)s * slot);
+            }
+        } else {
+            runDenseLayer(policy, layer, policy->activations[current], out, count);
+        }
+        current = 1 - current;
+    }
+
+    for (int s = 0; s < count; ++s) {
+        memcpy(policy->logits + s * POLICY_ACTIONS, policy->activations[current] + (size_t)s * slot,
+               POLICY_ACTIONS * sizeof(float));
+    }
+    policy->runs++;
+    policy->decisions += count;
+    policy->runMs += perfMs(start, perfNow());
+}
+
+// Best scoring action of a slot that doesn't reverse, moves that die at once only when there is nothing else
+int policyAction(Policy* policy, int slot, Snake* snake) {
+    const float* scores = policy->logits + slot * POLICY_ACTIONS;
+    int head = segmentCell(snake, 0);
+    int headCol = head % GRID_COLS;
+    int headRow = head / GRID_COLS;
+
+    int best = -1;
+    int bestSafe = 0;
+    for (int a = 0; a < POLICY_ACTIONS; ++a) {
+        int dx = STEP_COLS[a] * CELL_SIZE;
+        int dy = STEP_ROWS[a] * CELL_SIZE;
+        if (dx == -snake->dx && dy == -snake->dy) {
+            continue;
+        }
+        int col = headCol + STEP_COLS[a];
+        int row = headRow + STEP_ROWS[a];
+        int safe = insideBoard(col, row) && !blockedNextTick(snake, col, row);
+        if (best < 0 || safe > bestSafe || (safe == bestSafe && scores[a] > scores[best])) {
+            best = a;
+            bestSafe = safe;
+        }
+    }
+    return best;
+}
+
+// One game on its own, the game loop's bot call
+int policyTurn(Policy* policy, Snake* snake, Food* food, InputQueue* input) {
+    policyObserve(policy, 0, snake, food);
+    runPolicy(policy, 1);
+    int action = policyAction(policy, 0, snake);
+    if (action < 0) {
+        return 0;
+    }
+    queueTurn(input, STEP_COLS[action] * CELL_SIZE, STEP_ROWS[action] * CELL_SIZE, 0);
+    return 1;
+}
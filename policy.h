@@ -0,0 +1,85 @@
+// Neural network policy: a small CNN/MLP that picks the next move from the board observation (observation.h),
+// on the CPU. Weights come from a flat binary file, little endian:
+//   header  "SNKP", Uint32 version 1, Uint32 rows, cols, channels (the observation grid), Uint32 layer count
+//   layer   Uint32 type (POLICY_CONV or POLICY_DENSE), Uint32 outputs, Uint32 stride (conv only), Uint32 relu,
+//           then float weights and float biases[outputs]
+//           conv:  3x3 kernel, zero padding, weights[3][3][inputs][outputs]
+//           dense: weights[inputs][outputs], inputs in the previous layer's row, column, channel order
+// The input is the byte observation scaled to 0..1, stored row, column, channel. The last layer is dense with
+// POLICY_ACTIONS outputs, the move scores in the order right, left, down, up (as snakeenv.h).
+// Activations keep their channels together and padded to a multiple of 8 floats, and the kernels add a block
+// of inputs times their weight rows into the outputs, in AVX2/FMA, SSE2 or plain C picked at load time.
+// Most of the input is empty board and the walls are the same in every observation, so the walls' share of
+// the first layer is worked out at load time and the first layer only visits the cells of the snake and food.
+// Everything an inference needs is allocated by loadPolicy for up to batch games at once. Dense weights are read
+// in cache sized blocks once per batch, so games stepped side by side share the cost of streaming them
+
+#ifndef POLICY_H
+#define POLICY_H
+
+#include <SDL2/SDL.h>
+#include "snake.h"
+#include "input.h"
+#include "observation.h"
+
+const int POLICY_CONV = 1;
+const int POLICY_DENSE = 2;
+const int POLICY_MAX_LAYERS = 8;
+const int POLICY_ACTIONS = 4;
+const int POLICY_MAX_BATCH = 256;  // Games one run can take at most
+
+// Network input of one game: observation cells, channels padded to 8 floats
+const int POLICY_INPUT_STRIDE = (OBS_CHANNELS + 7) & ~7;
+const int POLICY_INPUT_FLOATS = OBS_CELLS * POLICY_INPUT_STRIDE;
+
+// Kernel sets
+const int POLICY_SCALAR = 0;
+const int POLICY_SSE2 = 1;
+const int POLICY_AVX2 = 2;
+
+// out[o] += sum of values[i] * rows[i * outputs + o], outputs is a multiple of 8
+typedef void (*PolicyAddRows)(float* out, const float* rows, const float* values, int inputs, int outputs);
+typedef void (*PolicyRelu)(float* values, int count);
+
+typedef struct {
+    int type;
+    int relu;
+    int stride;
+    int inRows, inCols, inChannels, inStride;     // inStride: channels rounded up to a multiple of 8
+    int outRows, outCols, outChannels, outStride;
+    float* weights;  // One row per input channel padded to inStride rows, outStride floats each, padding is 0
+    float* bias;
+} PolicyLayer;
+
+typedef struct {
+    PolicyLayer layers[POLICY_MAX_LAYERS];
+    int layerCount;
+    int batch;           // Games one run can take
+    int slotFloats;      // Largest activation of one game
+    float* activations[2];  // Ping-pong, batch * slotFloats each
+    Uint8* observations;    // batch * OBS_BYTES_SIZE
+    float* inputs;          // batch * POLICY_INPUT_FLOATS, walls left out
+    int* inputCells;        // Cells set in inputs, batch * OBS_CELLS
+    int* inputCounts;
+    float* firstBase;       // First layer output for the walls alone, bias included
+    float logits[POLICY_ACTIONS * POLICY_MAX_BATCH];
+    int kernels;
+    PolicyAddRows addRows;
+    PolicyRelu relu;
+
+    // Counters for benchmarks
+    int runs;
+    long long decisions;
+    double runMs;
+} Policy;
+
+// Policy functions
+int loadPolicy(Policy* policy, const char* path, int batch);
+void freePolicy(Policy* policy);
+int setPolicyKernels(Policy* policy, int kernels);
+void policyObserve(Policy* policy, int slot, Snake* snake, Food* food);
+void runPolicy(Policy* policy, int count);
+int policyAction(Policy* policy, int slot, Snake* snake);
+int policyTurn(Policy* policy, Snake* snake, Food* food, InputQueue* input);
+
+#endif
@@ -0,0 +1,223 @@
+// Policy benchmark: headless games stepped side by side, one batched inference per tick for all of them
+// Usage: policybench [--policy FILE] [--write-random FILE] [--arch cnn|mlp] [--games N] [--ticks N]
+//                    [--kernels scalar|sse2|avx2] [--check]
+// Prints CSV on stdout: games,kernels,decisions,episodes,mean_score,us_per_run,us_per_decision,decisions_per_s
+//   us_per_run is one inference for all games, us_per_decision divides it by the games
+//   --write-random writes a network with random weights for this board and exits, to time inference before
+//   there is a trained one: cnn is conv 8 stride 2, conv 16 stride 2, then dense 64, 64 and 4, mlp is dense 64,
+//   64 and 4 straight on the observation
+//   --check runs one observation through every kernel set the CPU has and prints the largest difference to C
+//   games that die, fill up or go 2 * GRID_CELLS ticks without food start over with the next seed
+//   the board size is fixed at build time like microbench (-DSNAKE_SCREEN_WIDTH=...)
+
+#include <SDL2/SDL.h>
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "perf.h"
+#include "snake.h"
+#include "input.h"
+#include "autopilot.h"
+#include "observation.h"
+#include "policy.h"
+
+const char* KERNEL_NAMES[3] = {"scalar", "sse2", "avx2"};
+
+typedef struct {
+    Snake snake;
+    Food food;
+    InputQueue input;
+    int lastScore;
+    int lastFood;
+} PolicyGame;
+
+void writePolicyInt(FILE* file, Uint32 value) {
+    value = SDL_SwapLE32(value);
+    fwrite(&value, sizeof(value), 1, file);
+}
+
+// Uniform in +-sqrt(6 / inputs) so activations keep about the same size from layer to layer
+void writeRandomLayer(FILE* file, int type, int inputs, int outputs, int stride, int relu, Uint32* random) {
+    writePolicyInt(file, type);
+    writePolicyInt(file, outputs);
+    writePolicyInt(file, stride);
+    writePolicyInt(file, relu);
+    int fanIn = type == POLICY_CONV ? 9 * inputs : inputs;
+    float limit = (float)sqrt(6.0 / fanIn);
+    int weights = fanIn * outputs;
+    for (int i = 0; i < weights + outputs; ++i) {
+        float value = i < weights ? (nextRandom(random) / 4294967296.0f * 2.0f - 1.0f) * limit : 0.01f;
+        value = SDL_SwapFloatLE(value);
+        fwrite(&value, sizeof(value), 1, file);
+    }
+}
+
+int writeRandomPolicy(const char* path, int mlp) {
+    FILE* file = fopen(path, "wb");
+    if (file == NULL) {
+        printf("Function:writeRandomPolicy, Unable to create %s\n", path);
+        return 1;
+    }
+    Uint32 random = 0x9e3779b9;
+    fwrite("SNKP", 1, 4, file);
+    writePolicyInt(file, 1);
+    writePolicyInt(file, OBS_ROWS);
+    writePolicyInt(file, OBS_COLS);
+    writePolicyInt(file, OBS_CHANNELS);
+    if (mlp) {
+        writePolicyInt(file, 3);
+        writeRandomLayer(file, POLICY_DENSE, OBS_CELLS * OBS_CHANNELS, 64, 0, 1, &random);
+    } else {
+        int rows = (OBS_ROWS - 1) / 2 + 1;
+        int cols = (OBS_COLS - 1) / 2 + 1;
+        rows = (rows - 1) / 2 + 1;
+        cols = (cols - 1) / 2 + 1;
+        writePolicyInt(file, 5);
+        writeRandomLayer(file, POLICY_CONV, OBS_CHANNELS, 8, 2, 1, &random);
+        writeRandomLayer(file, POLICY_CONV, 8, 16, 2, 1, &random);
+        writeRandomLayer(file, POLICY_DENSE, rows * cols * 16, 64, 0, 1, &random);
+    }
+    writeRandomLayer(file, POLICY_DENSE, 64, 64, 0, 1, &random);
+    writeRandomLayer(file, POLICY_DENSE, 64, POLICY_ACTIONS, 0, 0, &random);
+    if (fclose(file) != 0) {
+        printf("Function:writeRandomPolicy, Writing %s failed\n", path);
+        return 1;
+    }
+    return 0;
+}
+
+void startPolicyGame(PolicyGame* game, Uint32 seed) {
+    initSnake(&game->snake);
+    resetInputQueue(&game->input, &game->snake);
+    game->food.rect.w = 15;
+    game->food.rect.h = 15;
+    seedFood(&game->food, seed);
+    generateFood(&game->food);
+    game->lastScore = 0;
+    game->lastFood = 0;
+}
+
+// One observation through every kernel set, largest difference of the scores to the C kernels
+void checkKernels(Policy* policy, PolicyGame* game) {
+    float reference[POLICY_ACTIONS];
+    int best = setPolicyKernels(policy, POLICY_AVX2);
+    for (int kernels = POLICY_SCALAR; kernels <= best; ++kernels) {
+        setPolicyKernels(policy, kernels);
+        policyObserve(policy, 0, &game->snake, &game->food);
+        runPolicy(policy, 1);
+        double difference = 0;
+        for (int a = 0; a < POLICY_ACTIONS; ++a) {
+            if (kernels == POLICY_SCALAR) {
+                reference[a] = policy->logits[a];
+            }
+            double d = fabs(policy->logits[a] - reference[a]);
+            difference = d > difference ? d : difference;
+        }
+        printf("Check: %s scores %.5f %.5f %.5f %.5f, largest difference to scalar %g\n", KERNEL_NAMES[kernels],
+               policy->logits[0], policy->logits[1], policy->logits[2], policy->logits[3], difference);
+    }
+    setPolicyKernels(policy, best);
+}
+
+int main(int argc, char* args[]) {
+    const char* path = "policy.bin";
+    const char* randomPath = NULL;
+    int mlp = 0;
+    int count = 64;
+    int ticks = 2000;
+    int kernels = POLICY_AVX2;
+    int check = 0;
+    for (int i = 1; i < argc; ++i) {
+        if (strcmp(args[i], "--policy") == 0 && i + 1 < argc) {
+            path = args[++i];
+        } else if (strcmp(args[i], "--write-random") == 0 && i + 1 < argc) {
+            randomPath = args[++i];
+        } else if (strcmp(args[i], "--arch") == 0 && i + 1 < argc) {
+            mlp = strcmp(args[++i], "mlp") == 0;
+        } else if (strcmp(args[i], "--games") == 0 && i + 1 < argc) {
+            count = atoi(args[++i]);
+        } else if (strcmp(args[i], "--ticks") == 0 && i + 1 < argc) {
+            ticks = atoi(args[++i]);
+        } else if (strcmp(args[i], "--kernels") == 0 && i + 1 < argc) {
+            ++i;
+            kernels = strcmp(args[i], "scalar") == 0 ? POLICY_SCALAR : strcmp(args[i], "sse2") == 0 ? POLICY_SSE2 : POLICY_AVX2;
+        } else if (strcmp(args[i], "--check") == 0) {
+            check = 1;
+        } else {
+            printf("Usage: policybench [--policy FILE] [--write-random FILE] [--arch cnn|mlp] [--games N] [--ticks N] [--kernels scalar|sse2|avx2] [--check]\n");
+            return 1;
+        }
+    }
+    if (randomPath != NULL) {
+        return writeRandomPolicy(randomPath, mlp);
+    }
+
+    Policy* policy = (Policy*)malloc(sizeof(Policy));
+    PolicyGame* games = (PolicyGame*)malloc(count * sizeof(PolicyGame));
+    if (policy == NULL || games == NULL) {
+        printf("Function:main, allocation failed\n");
+        return 1;
+    }
+    if (loadPolicy(policy, path, count) != 0) {
+        return 1;
+    }
+    Uint32 nextSeed = 1;
+    for (int i = 0; i < count; ++i) {
+        startPolicyGame(&games[i], nextSeed++);
+    }
+    if (check) {
+        checkKernels(policy, &games[0]);
+    }
+    setPolicyKernels(policy, kernels);
+    policy->runs = 0;
+    policy->decisions = 0;
+    policy->runMs = 0;
+
+    int episodes = 0;
+    long long episodeScore = 0;
+    Uint64 start = perfNow();
+    for (int tick = 0; tick < ticks; ++tick) {
+        for (int i = 0; i < count; ++i) {
+            PolicyGame* game = &games[i];
+            if (checkCollision(&game->snake, &game->food)) {
+                growSnake(&game->snake, 2);
+                game->snake.score += 1;
+                generateFood(&game->food);
+            }
+            policyObserve(policy, i, &game->snake, &game->food);
+        }
+        runPolicy(policy, count);
+        for (int i = 0; i < count; ++i) {
+            PolicyGame* game = &games[i];
+            Snake* snake = &game->snake;
+            int action = policyAction(policy, i, snake);
+            if (action >= 0) {
+                queueTurn(&game->input, STEP_COLS[action] * CELL_SIZE, STEP_ROWS[action] * CELL_SIZE, 0);
+            }
+            Uint64 turnTime;
+            applyNextTurn(&game->input, snake, &turnTime);
+            updateSnake(snake, &game->food);
+            if (snake->score != game->lastScore) {
+                game->lastScore = snake->score;
+                game->lastFood = snake->tick;
+            }
+            if (isGameOver(snake) || snake->length >= SNAKE_MAX_LENGTH || snake->tick - game->lastFood > 2 * GRID_CELLS) {
+                episodes++;
+                episodeScore += snake->score;
+                startPolicyGame(game, nextSeed++);
+            }
+        }
+    }
+    double seconds = perfMs(start, perfNow()) / 1000.0;
+
+    printf("games,kernels,decisions,episodes,mean_score,us_per_run,us_per_decision,decisions_per_s\n");
+    printf("%d,%s,%lld,%d,%.1f,%.2f,%.3f,%.0f\n", count, KERNEL_NAMES[policy->kernels], policy->decisions, episodes,
+           episodes > 0 ? (double)episodeScore / episodes : 0.0, policy->runMs * 1000.0 / policy->runs,
+           policy->runMs * 1000.0 / policy->decisions, policy->decisions / seconds);
+
+    freePolicy(policy);
+    free(policy);
+    free(games);
+    return 0;
+}
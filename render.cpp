@@ -0,0 +1,466 @@
+#include "render.h"
+#include "perf.h"
+#include "snake.h"
+#include "trace.h"
+#include <SDL2/SDL_image.h>
+#include <stdio.h>
+#include <string.h>
+
+// Render thread resources (textures follow the TEX_* order, sprites follow SPRITE_* in playfield.h)
+const char* TEXTURE_FILES[TEX_LAYER] = {
+    "resources/bg.png",
+    "resources/snakeBig1.png",
+    "resources/snakeTree.png",
+    "resources/help.png",
+    "resources/overBG.png",
+    "resources/highBG.png",
+    "resources/food.png",
+    "resources/bonusFood.png",
+    "resources/bgS.png",
+    "resources/headUp.png",
+    "resources/headDown.png",
+    "resources/headLeft.png",
+    "resources/headRight.png",
+    "resources/bodyHorr.png",
+    "resources/bodyVert.png",
+    "resources/tailUp.png",
+    "resources/tailDown.png",
+    "resources/tailLeft.png",
+    "resources/tailRight.png",
+    "resources/leftDown.png",
+    "resources/rightDown.png",
+    "resources/rightUp.png",
+    "resources/leftUp.png",
+};
+
+typedef struct {
+    const char* file;
+    int size;
+} FontFile;
+
+const FontFile FONT_FILES[FONT_COUNT] = {
+    {"resources/SuperMario.ttf", 80},  // larger font for "SNAKE GAME" in home page
+    {"resources/gothic.ttf", 22},
+    {"resources/gothic.ttf", 40},
+    {"resources/grobold.ttf", 40},
+};
+
+// Create the renderer and load every texture and font, runs on the render thread
+int initRenderResources(RenderContext* context) {
+    // Create renderer for window
+    context->renderer = NULL;
+    context->softwarePresent = 0;
+    if (!context->software) {
+        context->renderer = SDL_CreateRenderer(context->window, -1, SDL_RENDERER_ACCELERATED);
+    }
+
+    // Software rendering straight into the window surface (requested, headless dummy driver or no GPU),
+    // frames are presented with SDL_UpdateWindowSurfaceRects
+    if (context->renderer == NULL) {
+        SDL_Surface* windowSurface = SDL_GetWindowSurface(context->window);
+        if (windowSurface != NULL) {
+            context->renderer = SDL_CreateSoftwareRenderer(windowSurface);
+            context->softwarePresent = 1;
+        }
+    }
+    if (context->renderer == NULL) {
+        printf("Function:initRenderResources, SDL_createRenderer failed,Error: %s\n", SDL_GetError());
+        return 1;
+    }
+    startupMark("renderer", NULL);
+
+    // Load textures
+    for (int i = 0; i < TEX_LAYER; ++i) {
+        context->textures[i] = loadTexture(context->renderer, TEXTURE_FILES[i]);
+        startupMark("textures", TEXTURE_FILES[i]);
+        if (context->textures[i] == NULL) {
+            return 1;
+        }
+    }
+
+    // Playfield layer, without render targets the playfield is redrawn in full every frame
+    context->textures[TEX_LAYER] = NULL;
+    if (SDL_RenderTargetSupported(context->renderer)) {
+        context->textures[TEX_LAYER] = countTexture(SDL_CreateTexture(context->renderer, SDL_PIXELFORMAT_RGBA8888, SDL_TEXTUREACCESS_TARGET, SCREEN_WIDTH, SCREEN_HEIGHT));
+        if (context->textures[TEX_LAYER] == NULL) {
+            printf("Function:initRenderResources, layer creation failed, Error: %s\n", SDL_GetError());
+        }
+    }
+    context->layerSupported = context->textures[TEX_LAYER] != NULL;
+
+    // Load font
+    for (int i = 0; i < FONT_COUNT; ++i) {
+        context->fonts[i] = TTF_OpenFont(FONT_FILES[i].file, FONT_FILES[i].size);
+        startupMark("fonts", FONT_FILES[i].file);
+        if (context->fonts[i] == NULL) {
+            printf("Failed to load font! SDL_ttf Error: %s\n", TTF_GetError());
+            return 1;
+        }
+    }
+    return 0;
+}
+
+void destroyRenderResources(RenderContext* context) {
+    for (int i = 0; i < TEXT_COUNT; ++i) {
+        destroyCachedText(&context->texts[i]);
+    }
+    for (int i = 0; i < FONT_COUNT; ++i) {
+        destroyGlyphCache(&context->glyphs[i]);
+        if (context->fonts[i] != NULL) {
+            TTF_CloseFont(context->fonts[i]);
+        }
+    }
+    for (int i = 0; i < TEX_COUNT; ++i) {
+        destroyTexture(context->textures[i]);
+    }
+    SDL_DestroyRenderer(context->renderer);
+}
+
+// Glyph atlas of a font, built the first time it's needed so startup doesn't pay for unused fonts
+GlyphCache* glyphCache(RenderContext* context, int font) {
+    GlyphCache* glyphs = &context->glyphs[font];
+    if (glyphs->atlas == NULL && initGlyphCache(glyphs, context->renderer, context->fonts[font]) != 0) {
+        return NULL;
+    }
+    return glyphs;
+}
+
+void resetRenderList(RenderList* list) {
+    list->count = 0;
+    list->textUsed = 0;
+    list->inputTime = 0;
+    list->showHud = 0;
+    list->tickMs = 0;
+    damageReset(&list->damage);
+}
+
+// Replay a list of commands and present it
+void executeRenderList(RenderContext* context, RenderList* list) {
+    SDL_Renderer* renderer = context->renderer;
+    Uint64 renderStart = perfNow();
+    Uint64 traceReplay = traceBegin();
+    int drawCalls = 0;
+    for (int i = 0; i < list->count; ++i) {
+        RenderCommand* command = &list->commands[i];
+        switch (command->type) {
+            case RC_CLEAR:
+                SDL_RenderClear(renderer);
+                drawCalls++;
+                break;
+            case RC_COPY: {
+                SDL_Texture* texture = context->textures[command->id];
+                SDL_SetTextureColorMod(texture, command->mod.r, command->mod.g, command->mod.b);
+                SDL_SetTextureAlphaMod(texture, command->mod.a);
+                SDL_RenderCopy(renderer, texture, command->hasSrc ? &command->src : NULL, command->dst.w > 0 ? &command->dst : NULL);
+                drawCalls++;
+                break;
+            }
+            case RC_TEXT: {
+                CachedText* cached = &context->texts[command->id];
+                updateCachedText(cached, renderer, context->fonts[command->font], &list->textPool[command->text], command->color);
+                cached->rect.x = command->dst.x;
+                cached->rect.y = command->dst.y;
+                SDL_SetTextureColorMod(cached->texture, command->mod.r, command->mod.g, command->mod.b);
+                SDL_SetTextureAlphaMod(cached->texture, command->mod.a);
+                SDL_RenderCopy(renderer, cached->texture, NULL, &cached->rect);
+                drawCalls++;
+                break;
+            }
+            case RC_GLYPHS: {
+                GlyphCache* glyphs = glyphCache(context, command->font);
+                if (glyphs != NULL) {
+                    drawGlyphText(glyphs, renderer, &list->textPool[command->text], command->dst.x, command->dst.y, command->color);
+                    drawCalls++;
+                }
+                break;
+            }
+            case RC_CLIP:
+                SDL_RenderSetClipRect(renderer, command->dst.w > 0 ? &command->dst : NULL);
+                break;
+            case RC_TARGET:
+                SDL_SetRenderTarget(renderer, command->id == TEX_SCREEN ? NULL : context->textures[command->id]);
+                break;
+            default:
+                break;
+        }
+    }
+    traceEnd("replay commands", traceReplay);
+    if (list->showHud) {
+        TRACE_SCOPE("perf hud");
+        GlyphCache* glyphs = glyphCache(context, FONT_GOTHIC);
+        if (glyphs != NULL) {
+            renderPerfHud(&context->hud, renderer, glyphs);
+        }
+    }
+
+    Uint64 presentStart = perfNow();
+    presentFrame(context->window, renderer, &list->damage, context->softwarePresent);
+    Uint64 presentEnd = perfNow();
+    if (traceEnabled()) {
+        traceRecord("present", presentStart, presentEnd);
+    }
+    hudFrame(&context->hud, list->tickMs, perfMs(renderStart, presentStart), perfMs(presentStart, presentEnd), drawCalls, presentEnd);
+    if (list->inputTime != 0) {
+        recordLatency(&context->inputLatency, perfMs(list->inputTime, perfNow()));
+    }
+
+    // Startup ends with the first presented frame
+    if (SDL_AtomicAdd(&context->framesPresented, 1) == 0) {
+        startupMark("first frame", NULL);
+        startupReport();
+    }
+}
+
+// Render thread: wait for submitted lists and replay them in order
+int renderThreadMain(void* data) {
+    RenderContext* context = (RenderContext*)data;
+    traceThreadName("render");
+    context->status = initRenderResources(context);
+    SDL_SemPost(context->initDone);
+    if (context->status != 0) {
+        destroyRenderResources(context);
+        return 1;
+    }
+
+    while (1) {
+        SDL_SemWait(context->submitted);
+        int consumed = SDL_AtomicGet(&context->consumed);
+        if (consumed == SDL_AtomicGet(&context->written)) {
+            // Woken up without a list, only happens on quit
+            if (SDL_AtomicGet(&context->quit)) {
+                break;
+            }
+            continue;
+        }
+        SDL_MemoryBarrierAcquire();
+        executeRenderList(context, &context->lists[consumed % RENDER_LIST_COUNT]);
+        SDL_MemoryBarrierRelease();
+        SDL_AtomicSet(&context->consumed, consumed + 1);
+    }
+
+    destroyRenderResources(context);
+    return 0;
+}
+
+// Start rendering, with threaded = 0 everything runs on the calling thread
+int startRenderContext(RenderContext* context, SDL_Window* window, int software, int threaded) {
+    context->window = window;
+    context->software = software;
+    context->threaded = threaded;
+    context->thread = NULL;
+    context->renderer = NULL;
+    for (int i = 0; i < TEX_COUNT; ++i) {
+        context->textures[i] = NULL;
+    }
+    for (int i = 0; i < FONT_COUNT; ++i) {
+        context->fonts[i] = NULL;
+        context->glyphs[i].atlas = NULL;
+    }
+    for (int i = 0; i < TEXT_COUNT; ++i) {
+        initCachedText(&context->texts[i], 0, 0);
+    }
+    initPerfHud(&context->hud);
+    SDL_AtomicSet(&context->written, 0);
+    SDL_AtomicSet(&context->consumed, 0);
+    SDL_AtomicSet(&context->quit, 0);
+    SDL_AtomicSet(&context->framesPresented, 0);
+    resetLatency(&context->inputLatency);
+
+    context->lists = (RenderList*)SDL_malloc(sizeof(RenderList) * RENDER_LIST_COUNT);
+    if (context->lists == NULL) {
+        printf("Function:startRenderContext, command buffer allocation failed\n");
+        return 1;
+    }
+    resetRenderList(&context->lists[0]);
+
+    if (!threaded) {
+        context->status = initRenderResources(context);
+        return context->status;
+    }
+
+    context->submitted = SDL_CreateSemaphore(0);
+    context->initDone = SDL_CreateSemaphore(0);
+    context->thread = SDL_CreateThread(renderThreadMain, "render", context);
+    if (context->thread == NULL) {
+        printf("Function:startRenderContext, render thread creation failed, Error: %s\n", SDL_GetError());
+        return 1;
+    }
+    // Assets are loaded on the render thread, the game can't record anything meaningful before that
+    SDL_SemWait(context->initDone);
+    return context->status;
+}
+
+// Let the render thread finish the submitted lists, then free everything
+void stopRenderContext(RenderContext* context) {
+    if (context->thread != NULL) {
+        SDL_AtomicSet(&context->quit, 1);
+        SDL_SemPost(context->submitted);
+        SDL_WaitThread(context->thread, NULL);
+        SDL_DestroySemaphore(context->submitted);
+        SDL_DestroySemaphore(context->initDone);
+        context->thread = NULL;
+    } else {
+        destroyRenderResources(context);
+    }
+    SDL_free(context->lists);
+    context->lists = NULL;
+}
+
+// The list the game loop is currently recording into
+RenderList* currentRenderList(RenderContext* context) {
+    return &context->lists[SDL_AtomicGet(&context->written) % RENDER_LIST_COUNT];
+}
+
+// Hand the current list to the render thread. When two lists are already waiting the render thread is
+// behind, the list then stays open and the next frame keeps recording into it instead of blocking the game
+void submitRenderList(RenderContext* context) {
+    int written = SDL_AtomicGet(&context->written);
+    RenderList* list = &context->lists[written % RENDER_LIST_COUNT];
+
+    if (!context->threaded) {
+        executeRenderList(context, list);
+        resetRenderList(list);
+        return;
+    }
+
+    // Only block if the open list is nearly full
+    int needFreeSlot = list->count > RENDER_MAX_COMMANDS / 2 || list->textUsed > RENDER_TEXT_POOL / 2;
+    while (written + 1 - SDL_AtomicGet(&context->consumed) >= RENDER_LIST_COUNT) {
+        if (!needFreeSlot) {
+            return;
+        }
+        SDL_Delay(1);
+    }
+
+    SDL_MemoryBarrierRelease();
+    SDL_AtomicSet(&context->written, written + 1);
+    SDL_SemPost(context->submitted);
+    resetRenderList(&context->lists[(written + 1) % RENDER_LIST_COUNT]);
+}
+
+// Wait until the render thread has executed every submitted list
+void finishRenderLists(RenderContext* context) {
+    if (!context->threaded) {
+        return;
+    }
+    while (SDL_AtomicGet(&context->consumed) != SDL_AtomicGet(&context->written)) {
+        SDL_Delay(1);
+    }
+}
+
+int renderFramesPresented(RenderContext* context) {
+    return SDL_AtomicGet(&context->framesPresented);
+}
+
+// Append a command, full lists drop it (submitRenderList keeps lists far from full)
+RenderCommand* pushCommand(RenderList* list, int type) {
+    if (list->count == RENDER_MAX_COMMANDS) {
+        return NULL;
+    }
+    RenderCommand* command = &list->commands[list->count++];
+    command->type = (Uint8)type;
+    command->id = 0;
+    command->font = 0;
+    command->hasSrc = 0;
+    command->mod.r = 255;
+    command->mod.g = 255;
+    command->mod.b = 255;
+    command->mod.a = 255;
+    command->dst.x = 0;
+    command->dst.y = 0;
+    command->dst.w = 0;
+    command->dst.h = 0;
+    return command;
+}
+
+void pushClear(RenderList* list) {
+    pushCommand(list, RC_CLEAR);
+}
+
+void pushCopy(RenderList* list, int texture, const SDL_Rect* src, const SDL_Rect* dst) {
+    RenderCommand* command = pushCommand(list, RC_COPY);
+    if (command == NULL) {
+        return;
+    }
+    command->id = (Uint8)texture;
+    if (src != NULL) {
+        command->hasSrc = 1;
+        command->src = *src;
+    }
+    if (dst != NULL) {
+        command->dst = *dst;
+    }
+}
+
+void pushCopyMod(RenderList* list, int texture, const SDL_Rect* dst, SDL_Color mod) {
+    RenderCommand* command = pushCommand(list, RC_COPY);
+    if (command == NULL) {
+        return;
+    }
+    command->id = (Uint8)texture;
+    command->mod = mod;
+    if (dst != NULL) {
+        command->dst = *dst;
+    }
+}
+
+// Append a command with a copy of the text in the list's pool
+RenderCommand* pushTextCommand(RenderList* list, int type, const char* text) {
+    int length = (int)strlen(text) + 1;
+    if (list->textUsed + length > RENDER_TEXT_POOL) {
+        return NULL;
+    }
+    RenderCommand* command = pushCommand(list, type);
+    if (command == NULL) {
+        return NULL;
+    }
+    memcpy(&list->textPool[list->textUsed], text, length);
+    command->text = (Uint16)list->textUsed;
+    list->textUsed += length;
+    return command;
+}
+
+void pushText(RenderList* list, int slot, int font, const char* text, SDL_Color color, int x, int y, SDL_Color mod) {
+    RenderCommand* command = pushTextCommand(list, RC_TEXT, text);
+    if (command == NULL) {
+        return;
+    }
+    command->id = (Uint8)slot;
+    command->font = (Uint8)font;
+    command->color = color;
+    command->mod = mod;
+    command->dst.x = x;
+    command->dst.y = y;
+}
+
+void pushGlyphText(RenderList* list, int font, const char* text, SDL_Color color, int x, int y) {
+    RenderCommand* command = pushTextCommand(list, RC_GLYPHS, text);
+    if (command == NULL) {
+        return;
+    }
+    command->font = (Uint8)font;
+    command->color = color;
+    command->dst.x = x;
+    command->dst.y = y;
+}
+
+void pushClip(RenderList* list, const SDL_Rect* clip) {
+    RenderCommand* command = pushCommand(list, RC_CLIP);
+    if (command != NULL && clip != NULL) {
+        command->dst = *clip;
+    }
+}
+
+void pushTarget(RenderList* list, int texture) {
+    RenderCommand* command = pushCommand(list, RC_TARGET);
+    if (command != NULL) {
+        command->id = (Uint8)texture;
+    }
+}
+
+// Remember that this list shows the result of a key press, for the input latency stats
+void markInputTime(RenderList* list, Uint64 time) {
+    if (list->inputTime == 0 || time < list->inputTime) {
+        list->inputTime = time;
+    }
+}
@@ -0,0 +1,141 @@
+// Render command buffer and render thread
+// The game loop only records compact draw commands into a RenderList, the render thread owns the
+// SDL_Renderer with every texture and font and replays the lists, so a slow present never stalls a tick
+
+#ifndef RENDER_H
+#define RENDER_H
+
+#include <SDL2/SDL.h>
+#include <SDL2/SDL_ttf.h>
+#include "damage.h"
+#include "texture.h"
+#include "perf.h"
+#include "hud.h"
+
+// Textures owned by the render thread
+enum {
+    TEX_MENU_BG,
+    TEX_SNAKE_BIG,
+    TEX_SNAKE_TREE,
+    TEX_HELP,
+    TEX_GAME_OVER,
+    TEX_HIGHSCORE_BG,
+    TEX_FOOD,
+    TEX_BONUS_FOOD,
+    TEX_GAME_BG,
+    TEX_SPRITES,                    // First snake sprite, see SPRITE_* in playfield.h
+    TEX_LAYER = TEX_SPRITES + 14,   // Playfield render target
+    TEX_COUNT
+};
+
+// Target for RC_TARGET that means the screen
+const int TEX_SCREEN = TEX_COUNT;
+
+// Fonts owned by the render thread
+enum {
+    FONT_TITLE,        // SuperMario 80
+    FONT_GOTHIC,       // gothic 22
+    FONT_GOTHIC_LARGE, // gothic 40
+    FONT_MENU,         // grobold 40
+    FONT_COUNT
+};
+
+// Text slots, the render thread keeps one texture per slot and re-renders it when the text changes
+enum {
+    TEXT_TITLE,
+    TEXT_START,
+    TEXT_AUTOPILOT,
+    TEXT_INSTRUCTIONS,
+    TEXT_HIGHSCORE,
+    TEXT_EXIT,
+    TEXT_HIGHSCORE_SCREEN,
+    TEXT_GAME_OVER_SCORE,
+    TEXT_COUNT
+};
+
+// Command types
+enum {
+    RC_CLEAR,   // Clear the current target
+    RC_COPY,    // Copy texture id (src rect optional, dst w = 0 means the whole target)
+    RC_TEXT,    // Draw text slot id at dst.x/dst.y
+    RC_CLIP,    // Set the clip rect to dst, or none when dst.w = 0
+    RC_TARGET,  // Render into texture id (TEX_LAYER) or TEX_SCREEN
+    RC_GLYPHS   // Draw text from the font's glyph atlas at dst.x/dst.y, for text that changes often
+};
+
+typedef struct {
+    Uint8 type;
+    Uint8 id;         // Texture, text slot or target
+    Uint8 font;       // RC_TEXT font
+    Uint8 hasSrc;     // RC_COPY uses src
+    SDL_Color color;  // RC_TEXT text color
+    SDL_Color mod;    // Color and alpha mod
+    SDL_Rect src;
+    SDL_Rect dst;
+    Uint16 text;      // RC_TEXT and RC_GLYPHS offset into the list's text pool
+} RenderCommand;
+
+const int RENDER_MAX_COMMANDS = 16384;
+const int RENDER_TEXT_POOL = 4096;
+const int RENDER_LIST_COUNT = 3;
+
+// One frame (or several, if the render thread fell behind) of commands
+typedef struct {
+    RenderCommand commands[RENDER_MAX_COMMANDS];
+    int count;
+    char textPool[RENDER_TEXT_POOL];
+    int textUsed;
+    DamageTracker damage;   // Present only these rects on the software path
+    Uint64 inputTime;       // Earliest key press applied in this list, 0 if none
+    int showHud;            // Draw the performance overlay on top
+    double tickMs;          // Game loop time spent on the last frame of this list
+} RenderList;
+
+typedef struct {
+    // Set up by the render thread
+    SDL_Window* window;
+    SDL_Renderer* renderer;
+    int softwarePresent;    // Rendering into the window surface, presented rect by rect
+    int layerSupported;     // TEX_LAYER exists
+    SDL_Texture* textures[TEX_COUNT];
+    TTF_Font* fonts[FONT_COUNT];
+    CachedText texts[TEXT_COUNT];
+    GlyphCache glyphs[FONT_COUNT];  // Built on first use
+    PerfHud hud;
+
+    // Lock-free single producer / single consumer ring of lists
+    RenderList* lists;
+    SDL_atomic_t written;   // Lists submitted by the game loop
+    SDL_atomic_t consumed;  // Lists finished by the render thread
+    SDL_sem* submitted;
+    SDL_atomic_t quit;
+    SDL_atomic_t framesPresented;
+    LatencyStats inputLatency;  // Key press -> present of the frame showing the turn
+
+    SDL_Thread* thread;
+    int threaded;           // 0: lists are executed right away on the calling thread
+    int software;           // Software rendering requested
+    int status;             // Init result, 0 on success
+    SDL_sem* initDone;
+} RenderContext;
+
+// Render context functions
+int startRenderContext(RenderContext* context, SDL_Window* window, int software, int threaded);
+void stopRenderContext(RenderContext* context);
+RenderList* currentRenderList(RenderContext* context);
+void submitRenderList(RenderContext* context);
+void finishRenderLists(RenderContext* context);
+int renderFramesPresented(RenderContext* context);
+
+// Command recording
+void resetRenderList(RenderList* list);
+void pushClear(RenderList* list);
+void pushCopy(RenderList* list, int texture, const SDL_Rect* src, const SDL_Rect* dst);
+void pushCopyMod(RenderList* list, int texture, const SDL_Rect* dst, SDL_Color mod);
+void pushText(RenderList* list, int slot, int font, const char* text, SDL_Color color, int x, int y, SDL_Color mod);
+void pushGlyphText(RenderList* list, int font, const char* text, SDL_Color color, int x, int y);
+void pushClip(RenderList* list, const SDL_Rect* clip);
+void pushTarget(RenderList* list, int texture);
+void markInputTime(RenderList* list, Uint64 time);
+
+#endif
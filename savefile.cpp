@@ -0,0 +1,165 @@
+#include "savefile.h"
+#include <stdio.h>
+#include <string.h>
+
+#ifdef _WIN32
+#include <windows.h>
+#include <io.h>
+#else
+#include <unistd.h>
+#endif
+
+// Write to path.tmp, flush to disk, then replace path. Returns 0 on success
+int writeFileAtomic(const char* path, const void* data, int size) {
+    char tempPath[264];
+    snprintf(tempPath, sizeof(tempPath), "%s.tmp", path);
+
+    FILE* file = fopen(tempPath, "wb");
+    if (file == NULL) {
+        printf("Function:writeFileAtomic, Unable to create %s\n", tempPath);
+        return 1;
+    }
+    int ok = fwrite(data, 1, size, file) == (size_t)size && fflush(file) == 0;
+#ifdef _WIN32
+    ok = ok && _commit(_fileno(file)) == 0;
+#else
+    ok = ok && fsync(fileno(file)) == 0;
+#endif
+    ok = fclose(file) == 0 && ok;
+    if (!ok) {
+        printf("Function:writeFileAtomic, Writing %s failed\n", tempPath);
+        remove(tempPath);
+        return 1;
+    }
+
+    // rename doesn't replace an existing file on Windows
+#ifdef _WIN32
+    ok = MoveFileExA(tempPath, path, MOVEFILE_REPLACE_EXISTING | MOVEFILE_WRITE_THROUGH) != 0;
+#else
+    ok = rename(tempPath, path) == 0;
+#endif
+    if (!ok) {
+        printf("Function:writeFileAtomic, Replacing %s failed\n", path);
+        remove(tempPath);
+        return 1;
+    }
+    return 0;
+}
+
+// Writer thread: take the pending request, write it without holding the lock
+int saveWriterMain(void* data) {
+    SaveWriter* writer = (SaveWriter*)data;
+    char path[256];
+    char* bytes = NULL;
+    int capacity = 0;
+
+    SDL_LockMutex(writer->lock);
+    while (1) {
+        while (!writer->pending && !writer->quit) {
+            SDL_CondWait(writer->changed, writer->lock);
+        }
+        if (!writer->pending) {
+            break;
+        }
+
+        // Copy out so the game can queue the next save while this one is on disk
+        // Without room for it the request counts as failed, the old buffer stays for the next one
+        if (capacity < writer->size) {
+            char* grown = (char*)SDL_malloc(writer->size);
+            if (grown == NULL) {
+                printf("Function:saveWriterMain, allocation failed\n");
+                writer->pending = 0;
+                writer->failed++;
+                continue;
+            }
+            SDL_free(bytes);
+            bytes = grown;
+            capacity = writer->size;
+        }
+        int size = writer->size;
+        memcpy(bytes, writer->data, size);
+        strcpy(path, writer->path);
+        writer->pending = 0;
+        SDL_UnlockMutex(writer->lock);
+
+        int result = writeFileAtomic(path, bytes, size);
+
+        SDL_LockMutex(writer->lock);
+        if (result == 0) {
+            writer->written++;
+        } else {
+            writer->failed++;
+        }
+    }
+    SDL_UnlockMutex(writer->lock);
+    SDL_free(bytes);
+    return 0;
+}
+
+// Returns 0 on success. Without the thread queueSave writes right away
+int startSaveWriter(SaveWriter* writer) {
+    writer->quit = 0;
+    writer->pending = 0;
+    writer->path[0] = '\0';
+    writer->data = NULL;
+    writer->size = 0;
+    writer->capacity = 0;
+    writer->written = 0;
+    writer->failed = 0;
+    writer->lock = SDL_CreateMutex();
+    writer->changed = SDL_CreateCond();
+    writer->thread = SDL_CreateThread(saveWriterMain, "save writer", writer);
+    if (writer->thread == NULL) {
+        printf("Function:startSaveWriter, thread creation failed, Error: %s\n", SDL_GetError());
+        return 1;
+    }
+    return 0;
+}
+
+// Copy the bytes and return, the writer thread saves them
+void queueSave(SaveWriter* writer, const char* path, const void* data, int size) {
+    if (writer->thread == NULL) {
+        writeFileAtomic(path, data, size);
+        return;
+    }
+    SDL_LockMutex(writer->lock);
+    // Without room for the copy this save fails, a request already pending is still written
+    if (writer->capacity < size) {
+        char* grown = (char*)SDL_malloc(size);
+        if (grown == NULL) {
+            printf("Function:queueSave, allocation failed\n");
+            writer->failed++;
+            SDL_UnlockMutex(writer->lock);
+            return;
+        }
+        SDL_free(writer->data);
+        writer->data = grown;
+        writer->capacity = size;
+    }
+    memcpy(writer->data, data, size);
+    writer->size = size;
+    snprintf(writer->path, sizeof(writer->path), "%s", path);
+    writer->pending = 1;
+    SDL_CondSignal(writer->changed);
+    SDL_UnlockMutex(writer->lock);
+}
+
+// Finish the pending save and stop the thread
+void stopSaveWriter(SaveWriter* writer) {
+    if (writer->thread != NULL) {
+        SDL_LockMutex(writer->lock);
+        writer->quit = 1;
+        SDL_CondSignal(writer->changed);
+        SDL_UnlockMutex(writer->lock);
+        SDL_WaitThread(writer->thread, NULL);
+        writer->thread = NULL;
+    }
+    if (writer->failed > 0) {
+        printf("Save writer: %d of %d saves failed\n", writer->failed, writer->written + writer->failed);
+    }
+    SDL_DestroyCond(writer->changed);
+    SDL_DestroyMutex(writer->lock);
+    SDL_free(writer->data);
+    writer->data = NULL;
+    writer->capacity = 0;
+}
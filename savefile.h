@@ -0,0 +1,32 @@
+// Background file saving: the game hands over the bytes and carries on, a writer thread puts them in a
+// temp file, flushes it to disk and renames it over the old one, so a crash mid-write keeps the previous file
+
+#ifndef SAVEFILE_H
+#define SAVEFILE_H
+
+#include <SDL2/SDL.h>
+
+typedef struct {
+    SDL_Thread* thread;
+    SDL_mutex* lock;
+    SDL_cond* changed;
+    int quit;
+
+    // Latest request, a newer save of the same file replaces one that wasn't written yet
+    int pending;
+    char path[256];
+    char* data;
+    int size;
+    int capacity;
+
+    int written;  // Files written, read under lock
+    int failed;
+} SaveWriter;
+
+// Save functions
+int startSaveWriter(SaveWriter* writer);
+void queueSave(SaveWriter* writer, const char* path, const void* data, int size);
+void stopSaveWriter(SaveWriter* writer);
+int writeFileAtomic(const char* path, const void* data, int size);
+
+#endif
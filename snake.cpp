@@ -0,0 +1,190 @@
+#include "snake.h"
+#include <stdlib.h>
+
+// Stamp for cells the snake has never visited, far enough in the past to never count as occupied
+const int CELL_NEVER_VISITED = -1000000000;
+
+// Record the tick at which a segment entered its cell
+void stampCell(Snake* snake, SDL_Rect* segment, int tick) {
+    int col = segment->x / CELL_SIZE;
+    int row = segment->y / CELL_SIZE;
+    if (col >= 0 && col < GRID_COLS && row >= 0 && row < GRID_ROWS) {
+        snake->cellStamp[row * GRID_COLS + col] = tick;
+    }
+}
+
+// Snake game state initialization
+void initSnake(Snake* snake) {
+    // Initialize snake starting position and direction
+    snake->x = SCREEN_WIDTH/2;
+    snake->y = SCREEN_HEIGHT/2;
+    snake->dx = 10;
+    snake->dy = 0;
+    snake->length = 10;
+    snake->score = 0;
+    snake->tick = 0;
+
+    for (int i = 0; i < GRID_CELLS; ++i) {
+        snake->cellStamp[i] = CELL_NEVER_VISITED;
+    }
+
+    // Initialize segments, one cell apart like after a move (segment i entered its cell i ticks ago)
+    for (int i = 0; i < snake->length; ++i) {
+        snake->segments[i].x = snake->x - i * CELL_SIZE;
+        snake->segments[i].y = snake->y;
+        snake->segments[i].w = SEGMENT_WIDTH;
+        snake->segments[i].h = SEGMENT_HEIGHT;
+        snake->directions[i] = 0; // Initialize all directions to 0
+        stampCell(snake, &snake->segments[i], -i);
+    }
+}
+
+// Snake game update logic
+void updateSnake(Snake* snake, Food* food) {
+    // Update the position of each segment
+    for (int i = snake->length - 1; i > 0; --i) {
+        snake->segments[i] = snake->segments[i - 1];
+        snake->directions[i] = snake->directions[i - 1]; // Update direction
+    }
+    // Update head position based on direction
+    snake->segments[0].x += snake->dx;
+    snake->segments[0].y += snake->dy;
+    snake->tick++;
+    stampCell(snake, &snake->segments[0], snake->tick);
+
+    if (snake->dx > 0) {
+        snake->directions[0] = 1; // Moving right
+    } else if (snake->dx < 0) {
+        snake->directions[0] = 2; // Moving left
+    } else if (snake->dy > 0) {
+        snake->directions[0] = 3; // Moving down
+    } else if (snake->dy < 0) {
+        snake->directions[0] = 4; // Moving up
+    }
+
+    // Check if snake eats food
+    if (checkCollision(snake, food)) {
+        growSnake(snake, 1);  // Increase snake's length
+        snake->score += 1;
+        generateFood(food);  // Generate new food
+    }
+}
+
+// Grow the snake, new segments start on the tail so it stays in place until the body catches up
+void growSnake(Snake* snake, int amount) {
+    int tailIdx = snake->length - 1;
+    for (int i = 0; i < amount && snake->length < SNAKE_MAX_LENGTH; ++i) {
+        snake->segments[snake->length] = snake->segments[tailIdx];
+        snake->directions[snake->length] = snake->directions[tailIdx];
+        snake->length++;
+    }
+}
+
+// Index of the segment occupying a grid cell, -1 if the cell is free
+int snakeSegmentAt(Snake* snake, int col, int row) {
+    if (col < 0 || col >= GRID_COLS || row < 0 || row >= GRID_ROWS) {
+        return -1;
+    }
+    int idx = snake->tick - snake->cellStamp[row * GRID_COLS + col];
+    if (idx < 0 || idx >= snake->length) {
+        return -1;
+    }
+    // The tail holds still for a few ticks after growing, make sure the stamp still matches
+    if (snake->segments[idx].x / CELL_SIZE != col || snake->segments[idx].y / CELL_SIZE != row) {
+        return -1;
+    }
+    return idx;
+}
+
+// Check if game over (e.g., snake hits boundary or itself)
+int isGameOver(Snake* snake) {
+    // Implement game over conditions
+    // Condition 1: hitting screen boundary
+    if (snake->segments[0].x < BOARD_LEFT || snake->segments[0].x >= BOARD_RIGHT || snake->segments[0].y < BOARD_TOP || snake->segments[0].y >= BOARD_BOTTOM) {
+        return 1;
+    }
+    // Condition 2: hitting itself (for loop through snake segments)
+    for (int i = 1; i < snake->length; ++i) {
+        if (snake->segments[0].x == snake->segments[i].x && snake->segments[0].y == snake->segments[i].y) {
+            return 1;
+        }
+    }
+    return 0;
+}
+
+// Random numbers with their own state, for games played side by side (rand() is shared by the whole process).
+// xorshift32, the state must not be 0
+Uint32 nextRandom(Uint32* state) {
+    Uint32 x = *state;
+    x ^= x << 13;
+    x ^= x >> 17;
+    x ^= x << 5;
+    *state = x;
+    return x;
+}
+
+// Give the food its own sequence: the same seed places the same food on every platform and thread
+void seedFood(Food* food, Uint32 seed) {
+    // Mix the seed so neighbouring seeds don't start neighbouring sequences
+    seed = (seed ^ 61) ^ (seed >> 16);
+    seed *= 9;
+    seed ^= seed >> 4;
+    seed *= 0x27d4eb2d;
+    seed ^= seed >> 15;
+    food->random = seed != 0 ? seed : 0x9e3779b9;
+}
+
+// Generate random positions for food within the game screen
+void generateFood(Food* food) {
+    int spanX = BOARD_RIGHT - BOARD_LEFT - 2 - food->rect.w;
+    int spanY = BOARD_BOTTOM - BOARD_TOP - 2 - food->rect.h;
+    if (food->random != 0) {
+        food->x = BOARD_LEFT + 1 + nextRandom(&food->random) % spanX;
+        food->y = BOARD_TOP + 1 + nextRandom(&food->random) % spanY;
+    } else {
+        food->x = BOARD_LEFT + 1 + rand() % spanX;  // Adjusted for x-axis within the specified range
+        food->y = BOARD_TOP + 1 + rand() % spanY;  // Adjusted for y-axis within the specified range
+    }
+    // Food generation grid
+    food->x -= food->x % 10;
+    food->y -= food->y % 10;
+}
+
+// Generate random positions for bonus food within the game screen
+void generateBonusFood(bonusFood* bonus) {
+    bonus->x = BOARD_LEFT + 1 + rand() % (BOARD_RIGHT - BOARD_LEFT - 2 - bonus->rect.w); // x-axis range
+    bonus->y = BOARD_TOP + 1 + rand() % (BOARD_BOTTOM - BOARD_TOP - 2 - bonus->rect.h); // y-axis range
+
+    // Bonus food generation grid
+    bonus->x -= bonus->x % 10;
+    bonus->y -= bonus->y % 10;
+
+    bonus->rect.w = 15; // Image width
+    bonus->rect.h = 15; // Image height
+
+    // Update the rect position based on the new coordinates
+    bonus->rect.x = bonus->x;
+    bonus->rect.y = bonus->y;
+}
+
+// Check if snake's head collides with food
+int checkCollision(Snake* snake, Food* food) {
+    if (snake->segments[0].x < food->x + food->rect.w &&
+        snake->segments[0].x + snake->segments[0].w > food->x &&
+        snake->segments[0].y < food->y + food->rect.h &&
+        snake->segments[0].y + snake->segments[0].h > food->y) {
+        return 1;
+    }
+    return 0;
+}
+
+int checkBonusFoodCollision(Snake* snake, bonusFood* bonus) {
+    // Check if the snake's head collides with the bonus food
+    if (snake->segments[0].x < bonus->x + bonus->rect.w &&
+        snake->segments[0].x + snake->segments[0].w > bonus->x &&
+        snake->segments[0].y < bonus->y + bonus->rect.h &&
+        snake->segments[0].y + snake->segments[0].h > bonus->y) {
+        return 1; // Collision detected
+    }
+    return 0; // No collision
+}
@@ -0,0 +1,86 @@
+// Snake game state and update logic (no rendering here)
+
+#ifndef SNAKE_H
+#define SNAKE_H
+
+#include <SDL2/SDL.h>
+
+// Screen dimension constants, benchmarks build the simulation for other board sizes with -DSNAKE_SCREEN_WIDTH=...
+#ifndef SNAKE_SCREEN_WIDTH
+#define SNAKE_SCREEN_WIDTH 960
+#endif
+#ifndef SNAKE_SCREEN_HEIGHT
+#define SNAKE_SCREEN_HEIGHT 600
+#endif
+const int SCREEN_WIDTH = SNAKE_SCREEN_WIDTH;
+const int SCREEN_HEIGHT = SNAKE_SCREEN_HEIGHT;
+
+// Game loading speed FPS, the game advances one tick per frame
+const int SCREEN_FPS = 15;
+const int SCREEN_TICK_PER_FRAME = 1000 / SCREEN_FPS;
+
+// Area the head may move in, the border of the background and the HUD at the bottom are outside (15..929, 15..529 at 960x600)
+const int BOARD_LEFT = 15;
+const int BOARD_TOP = 15;
+const int BOARD_RIGHT = SCREEN_WIDTH - 31;
+const int BOARD_BOTTOM = SCREEN_HEIGHT - 71;
+
+// The snake moves one cell per tick, every segment sits on this grid
+const int CELL_SIZE = 10;
+const int GRID_COLS = SCREEN_WIDTH / CELL_SIZE;
+const int GRID_ROWS = SCREEN_HEIGHT / CELL_SIZE;
+const int GRID_CELLS = GRID_COLS * GRID_ROWS;
+
+// Grid cells the head may enter, the board area above on the grid (columns 2..92, rows 2..52 at 960x600)
+const int BOARD_FIRST_COL = (BOARD_LEFT + CELL_SIZE - 1) / CELL_SIZE;
+const int BOARD_LAST_COL = (BOARD_RIGHT - 1) / CELL_SIZE;
+const int BOARD_FIRST_ROW = (BOARD_TOP + CELL_SIZE - 1) / CELL_SIZE;
+const int BOARD_LAST_ROW = (BOARD_BOTTOM - 1) / CELL_SIZE;
+const int BOARD_COLS = BOARD_LAST_COL - BOARD_FIRST_COL + 1;
+const int BOARD_ROWS = BOARD_LAST_ROW - BOARD_FIRST_ROW + 1;
+
+// Segment sprite size, sprites overlap their neighbours because they are bigger than a cell
+const int SEGMENT_WIDTH = 15;
+const int SEGMENT_HEIGHT = 13;
+
+// The snake can never be longer than the number of cells on screen
+const int SNAKE_MAX_LENGTH = GRID_CELLS;
+
+// Snake game structures
+typedef struct {
+    int x, y;
+    SDL_Rect rect;
+    Uint32 random;  // Seeded food sequence (seedFood), 0 draws from rand()
+} Food;
+
+typedef struct {
+    int x, y;
+    SDL_Rect rect;
+} bonusFood;
+
+typedef struct {
+    int x, y;
+    int dx, dy;
+    SDL_Rect segments[SNAKE_MAX_LENGTH];
+    int directions[SNAKE_MAX_LENGTH];
+    int length;
+    int score;
+    // Tick at which the head last entered each grid cell, segment index of a cell = tick - cellStamp
+    int cellStamp[GRID_CELLS];
+    int tick;
+} Snake;
+
+// Function to initialize the snake game
+void initSnake(Snake* snake);
+void updateSnake(Snake* snake, Food* food);
+void growSnake(Snake* snake, int amount);
+int snakeSegmentAt(Snake* snake, int col, int row);
+int isGameOver(Snake* snake);
+void generateFood(Food* food);
+void generateBonusFood(bonusFood* bonus);
+void seedFood(Food* food, Uint32 seed);
+Uint32 nextRandom(Uint32* state);
+int checkCollision(Snake* snake, Food* food);
+int checkBonusFoodCollision(Snake* snake, bonusFood* bonus);
+
+#endif
@@ -0,0 +1,295 @@
+#include "snakeenv.h"
+#include "snake.h"
+#include <stdlib.h>
+#include <string.h>
+
+// Same as initSnake and the food sprite in main.cpp
+const int ENV_START_LENGTH = 10;
+const int ENV_FOOD_SIZE = 15;
+
+// Structure of arrays: field[i] belongs to game i, per-cell arrays hold cells entries per game
+struct SnakeEnv {
+    int count;
+    int cols, rows, cells;      // Cells the head may enter
+    int firstCol, firstRow;     // Board origin on the screen grid
+    int startCol, startRow;     // Head at the start of a game, board cells
+
+    // One entry per game, positions in board cells
+    int32_t* headCol;
+    int32_t* headRow;
+    int32_t* direction;         // 0 right, 1 left, 2 down, 3 up
+    int32_t* length;            // Cells the body covers
+    int32_t* grow;              // Ticks the tail still holds still after eating
+    int32_t* tail;              // Ring index of the tail in body
+    int32_t* foodCol;           // Food cell, the head eats it from the 3x3 cells around it like checkCollision
+    int32_t* foodRow;
+    int32_t* score;
+    int32_t* lastScore;         // Score of the last finished episode, -1 before the first one
+    int32_t* sinceFood;         // Steps since the last food, for truncation
+    uint32_t* random;           // Food sequence (seedFood)
+    uint32_t* seed;             // Seed of the current episode
+
+    // Scratch for a step
+    int32_t* nextCol;
+    int32_t* nextRow;
+    int32_t* eaten;
+
+    // cells entries per game
+    uint8_t* occupied;          // Body cells
+    int32_t* body;              // Ring of body cells from the tail to the head
+};
+
+void placeFood(SnakeEnv* env, int i) {
+    int x = BOARD_LEFT + 1 + nextRandom(&env->random[i]) % (BOARD_RIGHT - BOARD_LEFT - 2 - ENV_FOOD_SIZE);
+    int y = BOARD_TOP + 1 + nextRandom(&env->random[i]) % (BOARD_BOTTOM - BOARD_TOP - 2 - ENV_FOOD_SIZE);
+    env->foodCol[i] = x / CELL_SIZE - env->firstCol;
+    env->foodRow[i] = y / CELL_SIZE - env->firstRow;
+}
+
+// New episode for game i, laid out like initSnake
+void resetGame(SnakeEnv* env, int i, uint32_t seed) {
+    uint8_t* occupied = env->occupied + (size_t)i * env->cells;
+    int32_t* body = env->body + (size_t)i * env->cells;
+    memset(occupied, 0, env->cells);
+    for (int k = 0; k < ENV_START_LENGTH; ++k) {
+        int cell = env->startRow * env->cols + env->startCol - (ENV_START_LENGTH - 1 - k);
+        body[k] = cell;
+        occupied[cell] = 1;
+    }
+    env->headCol[i] = env->startCol;
+    env->headRow[i] = env->startRow;
+    env->direction[i] = 0;
+    env->length[i] = ENV_START_LENGTH;
+    env->grow[i] = 0;
+    env->tail[i] = 0;
+    env->score[i] = 0;
+    env->sinceFood[i] = 0;
+    env->seed[i] = seed;
+
+    Food food;
+    seedFood(&food, seed);
+    env->random[i] = food.random;
+    placeFood(env, i);
+}
+
+SnakeEnv* snakeEnvCreate(int count) {
+    if (count < 1) {
+        return NULL;
+    }
+    SnakeEnv* env = (SnakeEnv*)calloc(1, sizeof(SnakeEnv));
+    if (env == NULL) {
+        return NULL;
+    }
+    env->count = count;
+    env->firstCol = BOARD_FIRST_COL;
+    env->firstRow = BOARD_FIRST_ROW;
+    env->cols = BOARD_COLS;
+    env->rows = BOARD_ROWS;
+    env->cells = env->cols * env->rows;
+    env->startCol = SCREEN_WIDTH / 2 / CELL_SIZE - env->firstCol;
+    env->startRow = SCREEN_HEIGHT / 2 / CELL_SIZE - env->firstRow;
+
+    size_t games = count * sizeof(int32_t);
+    env->headCol = (int32_t*)malloc(games);
+    env->headRow = (int32_t*)malloc(games);
+    env->direction = (int32_t*)malloc(games);
+    env->length = (int32_t*)malloc(games);
+    env->grow = (int32_t*)malloc(games);
+    env->tail = (int32_t*)malloc(games);
+    env->foodCol = (int32_t*)malloc(games);
+    env->foodRow = (int32_t*)malloc(games);
+    env->score = (int32_t*)malloc(games);
+    env->lastScore = (int32_t*)malloc(games);
+    env->sinceFood = (int32_t*)malloc(games);
+    env->random = (uint32_t*)malloc(games);
+    env->seed = (uint32_t*)malloc(games);
+    env->nextCol = (int32_t*)malloc(games);
+    env->nextRow = (int32_t*)malloc(games);
+    env->eaten = (int32_t*)malloc(games);
+    env->occupied = (uint8_t*)malloc((size_t)count * env->cells);
+    env->body = (int32_t*)malloc((size_t)count * env->cells * sizeof(int32_t));
+    if (env->headCol == NULL || env->headRow == NULL || env->direction == NULL || env->length == NULL ||
+        env->grow == NULL || env->tail == NULL || env->foodCol == NULL || env->foodRow == NULL ||
+        env->score == NULL || env->lastScore == NULL || env->sinceFood == NULL || env->random == NULL ||
+        env->seed == NULL || env->nextCol == NULL || env->nextRow == NULL || env->eaten == NULL ||
+        env->occupied == NULL || env->body == NULL || env->startCol < ENV_START_LENGTH - 1) {
+        snakeEnvDestroy(env);
+        return NULL;
+    }
+
+    for (int i = 0; i < count; ++i) {
+        env->lastScore[i] = -1;
+        resetGame(env, i, i);
+    }
+    return env;
+}
+
+void snakeEnvDestroy(SnakeEnv* env) {
+    if (env == NULL) {
+        return;
+    }
+    free(env->headCol);
+    free(env->headRow);
+    free(env->direction);
+    free(env->length);
+    free(env->grow);
+    free(env->tail);
+    free(env->foodCol);
+    free(env->foodRow);
+    free(env->score);
+    free(env->lastScore);
+    free(env->sinceFood);
+    free(env->random);
+    free(env->seed);
+    free(env->nextCol);
+    free(env->nextRow);
+    free(env->eaten);
+    free(env->occupied);
+    free(env->body);
+    free(env);
+}
+
+void snakeEnvBoard(const SnakeEnv* env, int* cols, int* rows) {
+    *cols = env->cols;
+    *rows = env->rows;
+}
+
+void snakeEnvReset(SnakeEnv* env, const uint32_t* seeds, uint8_t* observations) {
+    for (int i = 0; i < env->count; ++i) {
+        env->lastScore[i] = -1;
+        resetGame(env, i, seeds != NULL ? seeds[i] : (uint32_t)i);
+    }
+    if (observations != NULL) {
+        snakeEnvObserve(env, observations);
+    }
+}
+
+// Eaten flags for the current heads, branch free so the loop vectorizes
+void markEaten(SnakeEnv* env, const int32_t* cols, const int32_t* rows) {
+    int count = env->count;
+    const int32_t* foodCol = env->foodCol;
+    const int32_t* foodRow = env->foodRow;
+    int32_t* eaten = env->eaten;
+    for (int i = 0; i < count; ++i) {
+        int dx = cols[i] - foodCol[i];
+        int dy = rows[i] - foodRow[i];
+        eaten[i] = (dx >= -1) & (dx <= 1) & (dy >= -1) & (dy <= 1);
+    }
+}
+
+void snakeEnvStep(SnakeEnv* env, const uint8_t* actions, float* rewards, uint8_t* dones, uint8_t* observations) {
+    int count = env->count;
+    int cells = env->cells;
+
+    // Food that appeared under the head is eaten before the move, like the check at the top of a game tick
+    markEaten(env, env->headCol, env->headRow);
+    for (int i = 0; i < count; ++i) {
+        rewards[i] = 0;
+        if (env->eaten[i]) {
+            env->grow[i] += 2;
+            env->score[i]++;
+            env->sinceFood[i] = 0;
+            rewards[i] = 1;
+            placeFood(env, i);
+        }
+    }
+
+    // Turn and move the heads, reversing keeps the direction
+    int32_t* direction = env->direction;
+    int32_t* nextCol = env->nextCol;
+    int32_t* nextRow = env->nextRow;
+    const int32_t* headCol = env->headCol;
+    const int32_t* headRow = env->headRow;
+    for (int i = 0; i < count; ++i) {
+        int action = actions[i];
+        int dir = direction[i];
+        int keep = (action > 3) | ((action ^ dir) == 1);
+        dir = keep ? dir : action;
+        direction[i] = dir;
+        nextCol[i] = headCol[i] + (dir == 0) - (dir == 1);
+        nextRow[i] = headRow[i] + (dir == 2) - (dir == 3);
+    }
+
+    // Move the bodies: the tail leaves its cell unless the snake is growing, then the head enters
+    for (int i = 0; i < count; ++i) {
+        int col = nextCol[i];
+        int row = nextRow[i];
+        int died = col < 0 || col >= env->cols || row < 0 || row >= env->rows;
+        if (!died) {
+            uint8_t* occupied = env->occupied + (size_t)i * cells;
+            int32_t* body = env->body + (size_t)i * cells;
+            if (env->grow[i] > 0) {
+                env->grow[i]--;
+                env->length[i]++;
+            } else {
+                occupied[body[env->tail[i]]] = 0;
+                env->tail[i] = env->tail[i] + 1 < cells ? env->tail[i] + 1 : 0;
+            }
+            int cell = row * env->cols + col;
+            died = occupied[cell];
+            if (!died) {
+                occupied[cell] = 1;
+                int head = env->tail[i] + env->length[i] - 1;
+                body[head < cells ? head : head - cells] = cell;
+            }
+        }
+        env->headCol[i] = col;
+        env->headRow[i] = row;
+        env->sinceFood[i]++;
+        dones[i] = died ? 1 : 0;
+    }
+
+    // Food eaten by the move, a fatal move still scores like updateSnake before isGameOver
+    markEaten(env, env->headCol, env->headRow);
+    for (int i = 0; i < count; ++i) {
+        if (env->eaten[i]) {
+            env->grow[i] += 1;
+            env->score[i]++;
+            env->sinceFood[i] = 0;
+            rewards[i] += 1;
+            placeFood(env, i);
+        }
+        if (dones[i] == 0 && env->length[i] + env->grow[i] >= cells) {
+            dones[i] = 2;
+        } else if (dones[i] == 0 && env->sinceFood[i] > 2 * cells) {
+            dones[i] = 3;
+        }
+        if (dones[i] != 0) {
+            if (dones[i] == 1) {
+                rewards[i] = -1;
+            }
+            env->lastScore[i] = env->score[i];
+            resetGame(env, i, env->seed[i] + count);
+        }
+    }
+
+    if (observations != NULL) {
+        snakeEnvObserve(env, observations);
+    }
+}
+
+void snakeEnvObserve(const SnakeEnv* env, uint8_t* observations) {
+    int cells = env->cells;
+    for (int i = 0; i < env->count; ++i) {
+        uint8_t* out = observations + (size_t)i * cells;
+        memcpy(out, env->occupied + (size_t)i * cells, cells);
+        int foodCol = env->foodCol[i];
+        int foodRow = env->foodRow[i];
+        if (foodCol >= 0 && foodCol < env->cols && foodRow >= 0 && foodRow < env->rows) {
+            out[foodRow * env->cols + foodCol] = 3;
+        }
+        out[env->headRow[i] * env->cols + env->headCol[i]] = 2;
+    }
+}
+
+// Current episode scores and the score of the episode each game finished last, either may be NULL
+void snakeEnvScores(const SnakeEnv* env, int32_t* scores, int32_t* lastScores) {
+    for (int i = 0; i < env->count; ++i) {
+        if (scores != NULL) {
+            scores[i] = env->score[i];
+        }
+        if (lastScores != NULL) {
+            lastScores[i] = env->lastScore[i];
+        }
+    }
+}
@@ -0,0 +1,44 @@
+/* Batch environment for training: many snake games stepped in lockstep behind a plain C interface, built as
+ * a shared library (make snakeenv). The games follow the same rules and food sequence as the real game for
+ * the same seed (seedFood), on the cell grid of the board instead of pixels.
+ * State is kept as one array per field across all games, so each pass of a step runs down flat arrays.
+ * An env has no globals, use one env per thread to step on several cores.
+ *
+ * Actions, one byte per game: 0 right, 1 left, 2 down, 3 up. Reversing into the neck keeps the direction.
+ * Rewards: +1 for each food, -1 on death.
+ * Dones: 0 running, 1 died, 2 filled the board, 3 truncated (no food for 2 * cells steps).
+ * A finished game starts its next episode in the same step with seed + count, so game i plays seeds
+ * s, s + count, s + 2 * count ... and the observation returned for it is the new episode's first one.
+ * Observations: cols * rows bytes per game, row major over the board: 0 empty, 1 body, 2 head, 3 food */
+
+#ifndef SNAKEENV_H
+#define SNAKEENV_H
+
+#include <stdint.h>
+
+#ifdef _WIN32
+#define SNAKEENV_API __declspec(dllexport)
+#else
+#define SNAKEENV_API __attribute__((visibility("default")))
+#endif
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+typedef struct SnakeEnv SnakeEnv;
+
+/* Env functions, observations may be NULL to skip writing them */
+SNAKEENV_API SnakeEnv* snakeEnvCreate(int count);
+SNAKEENV_API void snakeEnvDestroy(SnakeEnv* env);
+SNAKEENV_API void snakeEnvBoard(const SnakeEnv* env, int* cols, int* rows);
+SNAKEENV_API void snakeEnvReset(SnakeEnv* env, const uint32_t* seeds, uint8_t* observations);
+SNAKEENV_API void snakeEnvStep(SnakeEnv* env, const uint8_t* actions, float* rewards, uint8_t* dones, uint8_t* observations);
+SNAKEENV_API void snakeEnvObserve(const SnakeEnv* env, uint8_t* observations);
+SNAKEENV_API void snakeEnvScores(const SnakeEnv* env, int32_t* scores, int32_t* lastScores);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
@@ -0,0 +1,142 @@
+// Startup benchmark: launches the game headlessly N times and reports cold and warm startup percentiles
+// Usage: startup_bench [-n warmRuns] [-c coldRuns] [--drop-cmd "command"] [--windowed] [--game path]
+//   cold runs execute --drop-cmd first (e.g. a file cache flush), without it only the first launch counts as cold
+//   the game runs with SDL_VIDEODRIVER=dummy unless --windowed is given
+
+#include <SDL2/SDL.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#ifdef _WIN32
+#define popen _popen
+#define pclose _pclose
+const char* DEFAULT_GAME = "main.exe";
+#else
+const char* DEFAULT_GAME = "./main";
+#endif
+
+const int MAX_RUNS = 1000;
+
+typedef struct {
+    double startupMs[MAX_RUNS];  // In-process time, process start -> first presented menu frame
+    double wallMs[MAX_RUNS];     // Launch -> exit as seen by this benchmark
+    int count;
+} StartupSamples;
+
+// Launch the game once, returns 0 on success
+int runGameOnce(const char* command, StartupSamples* samples) {
+    Uint64 start = SDL_GetPerformanceCounter();
+    FILE* pipe = popen(command, "r");
+    if (pipe == NULL) {
+        printf("Function:runGameOnce, failed to launch: %s\n", command);
+        return 1;
+    }
+
+    double startupMs = -1;
+    char line[256];
+    while (fgets(line, sizeof(line), pipe) != NULL) {
+        sscanf(line, "Startup total: %lf ms", &startupMs);
+    }
+    pclose(pipe);
+    Uint64 end = SDL_GetPerformanceCounter();
+
+    if (startupMs < 0) {
+        printf("Function:runGameOnce, no startup report from: %s\n", command);
+        return 1;
+    }
+    if (samples->count < MAX_RUNS) {
+        samples->startupMs[samples->count] = startupMs;
+        samples->wallMs[samples->count] = (double)(end - start) * 1000.0 / (double)SDL_GetPerformanceFrequency();
+        samples->count++;
+    }
+    return 0;
+}
+
+int compareDouble(const void* a, const void* b) {
+    double x = *(const double*)a;
+    double y = *(const double*)b;
+    return (x > y) - (x < y);
+}
+
+// Nearest-rank percentile of a sorted array
+double percentile(double* sorted, int count, double p) {
+    int rank = (int)(p / 100.0 * count + 0.5);
+    if (rank < 1) {
+        rank = 1;
+    }
+    if (rank > count) {
+        rank = count;
+    }
+    return sorted[rank - 1];
+}
+
+void printPercentiles(const char* label, double* values, int count) {
+    if (count == 0) {
+        return;
+    }
+    qsort(values, count, sizeof(double), compareDouble);
+    printf("%-14s n=%-4d min=%8.2f p50=%8.2f p90=%8.2f p99=%8.2f max=%8.2f ms\n", label, count,
+           values[0], percentile(values, count, 50), percentile(values, count, 90), percentile(values, count, 99), values[count - 1]);
+}
+
+int main(int argc, char* args[]) {
+    int warmRuns = 20;
+    int coldRuns = 1;
+    int windowed = 0;
+    const char* dropCommand = NULL;
+    const char* game = DEFAULT_GAME;
+
+    for (int i = 1; i < argc; ++i) {
+        if (strcmp(args[i], "-n") == 0 && i + 1 < argc) {
+            warmRuns = atoi(args[++i]);
+        } else if (strcmp(args[i], "-c") == 0 && i + 1 < argc) {
+            coldRuns = atoi(args[++i]);
+        } else if (strcmp(args[i], "--drop-cmd") == 0 && i + 1 < argc) {
+            dropCommand = args[++i];
+        } else if (strcmp(args[i], "--game") == 0 && i + 1 < argc) {
+            game = args[++i];
+        } else if (strcmp(args[i], "--windowed") == 0) {
+            windowed = 1;
+        }
+    }
+    if (dropCommand == NULL) {
+        coldRuns = 1;  // Without a cache flush only the very first launch is cold
+    }
+    if (warmRuns + coldRuns > MAX_RUNS) {
+        warmRuns = MAX_RUNS - coldRuns;
+    }
+
+    // Headless: SDL's dummy video driver, the game falls back to the software renderer
+    if (!windowed) {
+        SDL_setenv("SDL_VIDEODRIVER", "dummy", 1);
+    }
+
+    char command[512];
+    snprintf(command, sizeof(command), "%s --startup-exit", game);
+
+    StartupSamples cold;
+    StartupSamples warm;
+    cold.count = 0;
+    warm.count = 0;
+
+    for (int i = 0; i < coldRuns; ++i) {
+        if (dropCommand != NULL && system(dropCommand) != 0) {
+            printf("Cache drop command failed: %s\n", dropCommand);
+        }
+        if (runGameOnce(command, &cold) != 0) {
+            return 1;
+        }
+    }
+    for (int i = 0; i < warmRuns; ++i) {
+        if (runGameOnce(command, &warm) != 0) {
+            return 1;
+        }
+    }
+
+    printPercentiles("cold startup", cold.startupMs, cold.count);
+    printPercentiles("cold wall", cold.wallMs, cold.count);
+    printPercentiles("warm startup", warm.startupMs, warm.count);
+    printPercentiles("warm wall", warm.wallMs, warm.count);
+    return 0;
+}
@@ -0,0 +1,140 @@
+#include "taskpool.h"
+#include <stdio.h>
+
+typedef struct {
+    TaskPool* pool;
+    int index;
+    SDL_Thread* thread;
+} TaskWorker;
+
+// Tasks left in a range, under its lock
+int rangeLeft(TaskRange* range) {
+    SDL_LockMutex(range->lock);
+    int left = range->end - range->next;
+    SDL_UnlockMutex(range->lock);
+    return left;
+}
+
+// Next task for a worker, -1 when every range is empty
+int takeTask(TaskPool* pool, int worker) {
+    TaskRange* own = &pool->ranges[worker];
+    SDL_LockMutex(own->lock);
+    if (own->next < own->end) {
+        int task = own->next++;
+        SDL_UnlockMutex(own->lock);
+        return task;
+    }
+    SDL_UnlockMutex(own->lock);
+
+    // Steal the back half of the fullest range, only one lock is held at a time
+    while (1) {
+        int victim = -1;
+        int most = 0;
+        for (int i = 0; i < pool->workers; ++i) {
+            int left = i != worker ? rangeLeft(&pool->ranges[i]) : 0;
+            if (left > most) {
+                most = left;
+                victim = i;
+            }
+        }
+        if (victim < 0) {
+            return -1;
+        }
+
+        TaskRange* range = &pool->ranges[victim];
+        SDL_LockMutex(range->lock);
+        int left = range->end - range->next;
+        if (left <= 0) {
+            // Emptied since we looked, look again
+            SDL_UnlockMutex(range->lock);
+            continue;
+        }
+        int count = (left + 1) / 2;
+        range->end -= count;
+        int first = range->end;
+        SDL_UnlockMutex(range->lock);
+
+        SDL_LockMutex(own->lock);
+        own->next = first + 1;
+        own->end = first + count;
+        own->stolen += count;
+        SDL_UnlockMutex(own->lock);
+        return first;
+    }
+}
+
+int taskWorkerMain(void* data) {
+    TaskWorker* worker = (TaskWorker*)data;
+    TaskPool* pool = worker->pool;
+    int task;
+    while ((task = takeTask(pool, worker->index)) >= 0) {
+        pool->function(task, worker->index, pool->data);
+        pool->ranges[worker->index].ran++;
+    }
+    return 0;
+}
+
+// Worker count for a request, 0 or less means one per CPU core
+int taskPoolWorkers(int requested) {
+    int workers = requested > 0 ? requested : SDL_GetCPUCount();
+    if (workers < 1) {
+        workers = 1;
+    }
+    if (workers > TASKPOOL_MAX_WORKERS) {
+        workers = TASKPOOL_MAX_WORKERS;
+    }
+    return workers;
+}
+
+// Run tasks 0..count-1 on this many workers, the calling thread is worker 0. Returns once every task ran.
+// stolen (optional) gets the number of tasks that moved between workers
+int runTasks(int count, int workers, TaskFunction function, void* data, int* stolen) {
+    TaskPool pool;
+    TaskWorker threads[TASKPOOL_MAX_WORKERS];
+    pool.workers = taskPoolWorkers(workers);
+    pool.function = function;
+    pool.data = data;
+
+    // Even split to start with, stealing evens out the rest
+    for (int i = 0; i < pool.workers; ++i) {
+        TaskRange* range = &pool.ranges[i];
+        range->next = (int)((long long)count * i / pool.workers);
+        range->end = (int)((long long)count * (i + 1) / pool.workers);
+        range->ran = 0;
+        range->stolen = 0;
+        range->lock = SDL_CreateMutex();
+        if (range->lock == NULL) {
+            printf("Function:runTasks, SDL_CreateMutex failed,Error: %s\n", SDL_GetError());
+            for (int j = 0; j < i; ++j) {
+                SDL_DestroyMutex(pool.ranges[j].lock);
+            }
+            return 1;
+        }
+    }
+
+    // A worker that can't start leaves its range to be stolen
+    for (int i = 1; i < pool.workers; ++i) {
+        threads[i].pool = &pool;
+        threads[i].index = i;
+        threads[i].thread = SDL_CreateThread(taskWorkerMain, "task worker", &threads[i]);
+        if (threads[i].thread == NULL) {
+            printf("Function:runTasks, SDL_CreateThread failed,Error: %s\n", SDL_GetError());
+        }
+    }
+    threads[0].pool = &pool;
+    threads[0].index = 0;
+    taskWorkerMain(&threads[0]);
+
+    int totalStolen = 0;
+    for (int i = 0; i < pool.workers; ++i) {
+        if (i > 0 && threads[i].thread != NULL) {
+            SDL_WaitThread(threads[i].thread, NULL);
+        }
+        totalStolen += pool.ranges[i].stolen;
+        SDL_DestroyMutex(pool.ranges[i].lock);
+    }
+    if (stolen != NULL) {
+        *stolen = totalStolen;
+    }
+    return 0;
+}
@@ -0,0 +1,35 @@
+// Work-stealing task pool for headless batch runs (bot tournaments).
+// Tasks are numbered 0..count-1 and handed out to the workers as contiguous ranges. A worker takes tasks
+// from the front of its own range, and when that runs out it steals the back half of the fullest range
+// left, so long games on one worker don't leave the others idle at the end of a run
+
+#ifndef TASKPOOL_H
+#define TASKPOOL_H
+
+#include <SDL2/SDL.h>
+
+const int TASKPOOL_MAX_WORKERS = 64;
+
+// Runs one task, worker is the index of the calling worker (0..workers-1) for per-worker scratch
+typedef void (*TaskFunction)(int task, int worker, void* data);
+
+typedef struct {
+    SDL_mutex* lock;
+    int next;  // Next task to run, the range is empty when next == end
+    int end;
+    int ran;
+    int stolen;  // Tasks this worker took from others
+} TaskRange;
+
+typedef struct {
+    TaskRange ranges[TASKPOOL_MAX_WORKERS];
+    int workers;
+    TaskFunction function;
+    void* data;
+} TaskPool;
+
+// Task pool functions
+int taskPoolWorkers(int requested);
+int runTasks(int count, int workers, TaskFunction function, void* data, int* stolen);
+
+#endif
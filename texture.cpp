@@ -0,0 +1,177 @@
+#include "texture.h"
+#include "trace.h"
+#include "memstats.h"
+#include <SDL2/SDL_image.h>
+#include <stdio.h>
+#include <string.h>
+
+SDL_Texture* countTexture(SDL_Texture* texture) {
+    if (texture != NULL) {
+        countTextureCreated();
+    }
+    return texture;
+}
+
+void destroyTexture(SDL_Texture* texture) {
+    if (texture != NULL) {
+        countTextureDestroyed();
+        SDL_DestroyTexture(texture);
+    }
+}
+
+int liveTextureCount(void) {
+    MemStats stats;
+    memStatsSnapshot(&stats);
+    return stats.texturesCreated - stats.texturesDestroyed;
+}
+
+// Function to load texture from file
+SDL_Texture* loadTexture(SDL_Renderer *renderer, const char *filePath) {
+    // Load image
+    SDL_Surface* surface = IMG_Load(filePath);
+    if (surface == NULL) {
+        printf("Function:loadTexture, Surface image loading failed %s! Error: %s\n", filePath, IMG_GetError());
+        return NULL;
+    }
+
+    // Create texture from surface pixels
+    SDL_Texture* texture = countTexture(SDL_CreateTextureFromSurface(renderer, surface));
+    if (texture == NULL) {
+        printf("Function:loadTexture, Texture creation failed %s! Error: %s\n", filePath, SDL_GetError());
+    }
+
+    // Free loaded surface
+    SDL_FreeSurface(surface);
+
+    return texture;
+}
+
+// Function to render text using SDL_ttf
+SDL_Texture* renderText(SDL_Renderer *renderer, TTF_Font *font, const char *text, SDL_Color color, SDL_Rect *rect) {
+    TRACE_SCOPE("renderText");
+    // Render text surface
+    SDL_Surface* surface = TTF_RenderText_Solid(font, text, color);
+    countTextRender();
+    if (surface == NULL) {
+        printf("Function:renderText, Surface creation failed,Error: %s\n", TTF_GetError());
+        return NULL;
+    }
+
+    // Create texture from surface pixels
+    SDL_Texture* texture = countTexture(SDL_CreateTextureFromSurface(renderer, surface));
+    if (texture == NULL) {
+        printf("Function:renderText, texture creation failed, Error: %s\n", SDL_GetError());
+    }
+
+    // Get width and height of surface
+    rect->w = surface->w;
+    rect->h = surface->h;
+
+    // Free surface
+    SDL_FreeSurface(surface);
+
+    return texture;
+}
+
+void initCachedText(CachedText* cached, int x, int y) {
+    cached->text[0] = '\0';
+    cached->texture = NULL;
+    cached->rect.x = x;
+    cached->rect.y = y;
+    cached->rect.w = 0;
+    cached->rect.h = 0;
+}
+
+// Re-render the text texture only if the text changed, returns 1 when it did
+int updateCachedText(CachedText* cached, SDL_Renderer *renderer, TTF_Font *font, const char *text, SDL_Color color) {
+    if (cached->texture != NULL && strcmp(cached->text, text) == 0) {
+        return 0;
+    }
+    destroyTexture(cached->texture);
+    cached->texture = renderText(renderer, font, text, color, &cached->rect);
+    snprintf(cached->text, sizeof(cached->text), "%s", text);
+    return 1;
+}
+
+void destroyCachedText(CachedText* cached) {
+    destroyTexture(cached->texture);
+    cached->texture = NULL;
+    cached->text[0] = '\0';
+}
+
+// Render every printable ASCII glyph once in white into one atlas texture, returns 0 on success
+int initGlyphCache(GlyphCache* cache, SDL_Renderer *renderer, TTF_Font *font) {
+    SDL_Color white = {255, 255, 255, 255};
+    SDL_Surface* glyphs[GLYPH_COUNT];
+    int width = 0;
+    cache->height = TTF_FontHeight(font);
+    for (int i = 0; i < GLYPH_COUNT; ++i) {
+        glyphs[i] = TTF_RenderGlyph_Solid(font, (Uint16)(GLYPH_FIRST + i), white);
+        countTextRender();
+        if (glyphs[i] != NULL) {
+            width += glyphs[i]->w;
+            if (glyphs[i]->h > cache->height) {
+                cache->height = glyphs[i]->h;
+            }
+        }
+    }
+
+    // Glyphs side by side, transparent around them
+    SDL_Surface* atlas = SDL_CreateRGBSurfaceWithFormat(0, width > 0 ? width : 1, cache->height, 32, SDL_PIXELFORMAT_RGBA32);
+    if (atlas == NULL) {
+        printf("Function:initGlyphCache, atlas creation failed, Error: %s\n", SDL_GetError());
+    }
+    int x = 0;
+    for (int i = 0; i < GLYPH_COUNT; ++i) {
+        SDL_Rect* rect = &cache->glyphs[i];
+        rect->x = x;
+        rect->y = 0;
+        rect->w = 0;
+        rect->h = cache->height;
+        if (glyphs[i] == NULL) {
+            continue;
+        }
+        rect->w = glyphs[i]->w;
+        if (atlas != NULL) {
+            SDL_Rect dst = {x, 0, glyphs[i]->w, glyphs[i]->h};
+            SDL_BlitSurface(glyphs[i], NULL, atlas, &dst);
+        }
+        x += glyphs[i]->w;
+        SDL_FreeSurface(glyphs[i]);
+    }
+
+    cache->atlas = NULL;
+    if (atlas != NULL) {
+        cache->atlas = countTexture(SDL_CreateTextureFromSurface(renderer, atlas));
+        SDL_FreeSurface(atlas);
+    }
+    if (cache->atlas == NULL) {
+        printf("Function:initGlyphCache, texture creation failed, Error: %s\n", SDL_GetError());
+        return 1;
+    }
+    SDL_SetTextureBlendMode(cache->atlas, SDL_BLENDMODE_BLEND);
+    return 0;
+}
+
+// Draw text glyph by glyph (no kerning), returns the width drawn
+int drawGlyphText(GlyphCache* cache, SDL_Renderer *renderer, const char *text, int x, int y, SDL_Color color) {
+    SDL_SetTextureColorMod(cache->atlas, color.r, color.g, color.b);
+    SDL_SetTextureAlphaMod(cache->atlas, color.a);
+    int penX = x;
+    for (const char* c = text; *c != '\0'; ++c) {
+        int glyph = (unsigned char)*c - GLYPH_FIRST;
+        if (glyph < 0 || glyph >= GLYPH_COUNT) {
+            continue;
+        }
+        SDL_Rect* src = &cache->glyphs[glyph];
+        SDL_Rect dst = {penX, y, src->w, src->h};
+        SDL_RenderCopy(renderer, cache->atlas, src, &dst);
+        penX += src->w;
+    }
+    return penX - x;
+}
+
+void destroyGlyphCache(GlyphCache* cache) {
+    destroyTexture(cache->atlas);
+    cache->atlas = NULL;
+}
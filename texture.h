@@ -0,0 +1,43 @@
+// Texture and text loading helpers
+
+#ifndef TEXTURE_H
+#define TEXTURE_H
+
+#include <SDL2/SDL.h>
+#include <SDL2/SDL_ttf.h>
+
+SDL_Texture* loadTexture(SDL_Renderer *renderer, const char *filePath);
+SDL_Texture* renderText(SDL_Renderer *renderer, TTF_Font *font, const char *text, SDL_Color color, SDL_Rect *rect);
+
+// Live texture count, every texture is created through countTexture and freed with destroyTexture
+SDL_Texture* countTexture(SDL_Texture* texture);
+void destroyTexture(SDL_Texture* texture);
+int liveTextureCount(void);
+
+// Text that is only re-rendered when it changes (HUD score etc.), set rect.x/rect.y for the position
+typedef struct {
+    char text[64];
+    SDL_Texture* texture;
+    SDL_Rect rect;
+} CachedText;
+
+void initCachedText(CachedText* cached, int x, int y);
+int updateCachedText(CachedText* cached, SDL_Renderer *renderer, TTF_Font *font, const char *text, SDL_Color color);
+void destroyCachedText(CachedText* cached);
+
+// Printable ASCII glyphs in one white atlas, text that changes often (score, perf HUD) is drawn from it
+// with a color mod instead of rendering a new texture every time it changes
+const int GLYPH_FIRST = 32;
+const int GLYPH_COUNT = 95;
+
+typedef struct {
+    SDL_Texture* atlas;  // NULL until initGlyphCache
+    SDL_Rect glyphs[GLYPH_COUNT];
+    int height;
+} GlyphCache;
+
+int initGlyphCache(GlyphCache* cache, SDL_Renderer *renderer, TTF_Font *font);
+int drawGlyphText(GlyphCache* cache, SDL_Renderer *renderer, const char *text, int x, int y, SDL_Color color);
+void destroyGlyphCache(GlyphCache* cache);
+
+#endif
@@ -0,0 +1,293 @@
+// Bot tournament: every bot plays the same seeds, headless, one game per task on a work-stealing pool
+// Usage: tournament [--bots cycle,path,heuristic] [--seeds N] [--first-seed N] [--threads N] [--max-ticks N] [--scaling]
+//                   [--weights FILE]
+// Prints CSV on stdout: bot,board,games,deaths,filled,starved,mean_score,median_score,mean_ticks,median_ticks
+//   then one throughput line per run (games/s, ticks/s, tasks stolen between workers)
+//   a game ends when the snake dies, fills the board, goes 2 * GRID_CELLS ticks without food, or runs max-ticks
+//   the food sequence only depends on the seed, so results don't depend on the thread count or task order
+//   --scaling runs the whole tournament on 1, 2, 4 ... threads up to one per core and checks the results match
+//   the heuristic bot plays with the best weights of a trainer checkpoint (trainer.txt), or its defaults
+//   the board size is fixed at build time like microbench (-DSNAKE_SCREEN_WIDTH=...)
+
+#include <SDL2/SDL.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "perf.h"
+#include "snake.h"
+#include "input.h"
+#include "autopilot.h"
+#include "hamilton.h"
+#include "heuristic.h"
+#include "taskpool.h"
+
+const int BOT_PATH = 0;
+const int BOT_CYCLE = 1;
+const int BOT_HEURISTIC = 2;
+const int BOT_COUNT = 3;
+const char* BOT_NAMES[BOT_COUNT] = {"path", "cycle", "heuristic"};
+
+// How a game ended
+const int END_TICKS = 0;
+const int END_DIED = 1;
+const int END_FILLED = 2;
+const int END_STARVED = 3;
+
+// Everything one worker needs to play a game, allocated once per worker
+typedef struct {
+    Snake snake;
+    Food food;
+    InputQueue input;
+    Autopilot path;
+    HamiltonBot cycle;
+    HeuristicBot heuristic;
+} TournamentGame;
+
+typedef struct {
+    int score;
+    int ticks;
+    int end;
+} GameResult;
+
+typedef struct {
+    int bots[BOT_COUNT];  // Bots taking part, in order
+    int botCount;
+    int seeds;
+    int firstSeed;
+    int maxTicks;
+    int fullLength;
+    double weights[HEURISTIC_FEATURES];  // Heuristic bot
+    TournamentGame* games[TASKPOOL_MAX_WORKERS];
+    GameResult* results;  // seeds * botCount, task = seed index * botCount + bot index
+} Tournament;
+
+// One game with the same order of steps as the game loop in main.cpp, food comes from the seed
+void playTournamentGame(TournamentGame* game, int bot, Uint32 seed, int maxTicks, int fullLength, GameResult* result) {
+    Snake* snake = &game->snake;
+    initSnake(snake);
+    resetInputQueue(&game->input, snake);
+    game->food.rect.w = 15;
+    game->food.rect.h = 15;
+    seedFood(&game->food, seed);
+    generateFood(&game->food);
+    if (bot == BOT_CYCLE) {
+        resetHamiltonBot(&game->cycle, snake);
+    } else {
+        resetAutopilot(&game->path);
+    }
+
+    int lastScore = 0;
+    int lastFood = 0;
+    result->end = END_TICKS;
+    while (snake->tick < maxTicks) {
+        if (snake->length >= fullLength) {
+            result->end = END_FILLED;
+            break;
+        }
+        if (snake->tick - lastFood > 2 * GRID_CELLS) {
+            result->end = END_STARVED;
+            break;
+        }
+        if (checkCollision(snake, &game->food)) {
+            growSnake(snake, 2);
+            snake->score += 1;
+            generateFood(&game->food);
+        }
+        if (bot == BOT_CYCLE) {
+            hamiltonTurn(&game->cycle, snake, &game->food, &game->input);
+        } else if (bot == BOT_HEURISTIC) {
+            heuristicTurn(&game->heuristic, snake, &game->food, &game->input);
+        } else {
+            autopilotTurn(&game->path, snake, &game->food, &game->input);
+        }
+        Uint64 turnTime;
+        applyNextTurn(&game->input, snake, &turnTime);
+        updateSnake(snake, &game->food);
+        if (isGameOver(snake)) {
+            result->end = END_DIED;
+            break;
+        }
+        if (snake->score != lastScore) {
+            lastScore = snake->score;
+            lastFood = snake->tick;
+        }
+    }
+    result->score = snake->score;
+    result->ticks = snake->tick;
+}
+
+void tournamentTask(int task, int worker, void* data) {
+    Tournament* tournament = (Tournament*)data;
+    int seed = tournament->firstSeed + task / tournament->botCount;
+    int bot = tournament->bots[task % tournament->botCount];
+    playTournamentGame(tournament->games[worker], bot, (Uint32)seed, tournament->maxTicks, tournament->fullLength,
+                       &tournament->results[task]);
+}
+
+int compareInts(const void* a, const void* b) {
+    int x = *(const int*)a;
+    int y = *(const int*)b;
+    return (x > y) - (x < y);
+}
+
+double medianOf(int* values, int count) {
+    qsort(values, count, sizeof(int), compareInts);
+    if (count % 2 == 1) {
+        return values[count / 2];
+    }
+    return (values[count / 2 - 1] + values[count / 2]) / 2.0;
+}
+
+void reportTournament(Tournament* tournament) {
+    int* scores = (int*)malloc(tournament->seeds * sizeof(int));
+    int* ticks = (int*)malloc(tournament->seeds * sizeof(int));
+    if (scores == NULL || ticks == NULL) {
+        printf("Function:reportTournament, allocation failed\n");
+        free(scores);
+        free(ticks);
+        return;
+    }
+    printf("bot,board,games,deaths,filled,starved,mean_score,median_score,mean_ticks,median_ticks\n");
+    for (int b = 0; b < tournament->botCount; ++b) {
+        int ends[4] = {0, 0, 0, 0};
+        double scoreSum = 0;
+        double tickSum = 0;
+        for (int s = 0; s < tournament->seeds; ++s) {
+            GameResult* result = &tournament->results[s * tournament->botCount + b];
+            scores[s] = result->score;
+            ticks[s] = result->ticks;
+            scoreSum += result->score;
+            tickSum += result->ticks;
+            ends[result->end]++;
+        }
+        printf("%s,%dx%d,%d,%d,%d,%d,%.1f,%.1f,%.0f,%.0f\n", BOT_NAMES[tournament->bots[b]], BOARD_COLS, BOARD_ROWS,
+               tournament->seeds, ends[END_DIED], ends[END_FILLED], ends[END_STARVED], scoreSum / tournament->seeds,
+               medianOf(scores, tournament->seeds), tickSum / tournament->seeds, medianOf(ticks, tournament->seeds));
+    }
+    free(scores);
+    free(ticks);
+}
+
+// Play every game on this many workers, prints the throughput. Returns 0 on success
+int runTournament(Tournament* tournament, int workers) {
+    int games = tournament->seeds * tournament->botCount;
+    for (int i = 0; i < workers; ++i) {
+        if (tournament->games[i] == NULL) {
+            tournament->games[i] = (TournamentGame*)malloc(sizeof(TournamentGame));
+            if (tournament->games[i] == NULL) {
+                printf("Function:runTournament, allocation failed\n");
+                return 1;
+            }
+            initAutopilot(&tournament->games[i]->path);
+            initHamiltonBot(&tournament->games[i]->cycle);
+            initHeuristicBot(&tournament->games[i]->heuristic, tournament->weights);
+        }
+    }
+
+    int stolen = 0;
+    Uint64 start = perfNow();
+    if (runTasks(games, workers, tournamentTask, tournament, &stolen) != 0) {
+        return 1;
+    }
+    double seconds = perfMs(start, perfNow()) / 1000.0;
+
+    long long ticks = 0;
+    for (int i = 0; i < games; ++i) {
+        ticks += tournament->results[i].ticks;
+    }
+    printf("Tournament: %d games on %d threads in %.2f s, %.1f games/s, %.0f ticks/s, %d tasks stolen\n", games,
+           workers, seconds, games / seconds, ticks / seconds, stolen);
+    return 0;
+}
+
+int main(int argc, char* args[]) {
+    Tournament tournament;
+    memset(&tournament, 0, sizeof(tournament));
+    tournament.bots[0] = BOT_CYCLE;
+    tournament.bots[1] = BOT_PATH;
+    tournament.botCount = 2;
+    tournament.seeds = 1000;
+    tournament.firstSeed = 1;
+    tournament.maxTicks = 20000;  // Same cap as the autopilot demo games
+    int threads = 0;
+    int scaling = 0;
+    const char* weightsFile = TRAINER_CHECKPOINT;
+    for (int i = 1; i < argc; ++i) {
+        if (strcmp(args[i], "--bots") == 0 && i + 1 < argc) {
+            const char* list = args[++i];
+            tournament.botCount = 0;
+            for (int b = 0; b < BOT_COUNT; ++b) {
+                if (strstr(list, BOT_NAMES[b]) != NULL) {
+                    tournament.bots[tournament.botCount++] = b;
+                }
+            }
+        } else if (strcmp(args[i], "--seeds") == 0 && i + 1 < argc) {
+            tournament.seeds = atoi(args[++i]);
+        } else if (strcmp(args[i], "--first-seed") == 0 && i + 1 < argc) {
+            tournament.firstSeed = atoi(args[++i]);
+        } else if (strcmp(args[i], "--threads") == 0 && i + 1 < argc) {
+            threads = atoi(args[++i]);
+        } else if (strcmp(args[i], "--max-ticks") == 0 && i + 1 < argc) {
+            tournament.maxTicks = atoi(args[++i]);
+        } else if (strcmp(args[i], "--scaling") == 0) {
+            scaling = 1;
+        } else if (strcmp(args[i], "--weights") == 0 && i + 1 < argc) {
+            weightsFile = args[++i];
+        } else {
+            printf("Usage: tournament [--bots cycle,path,heuristic] [--seeds N] [--first-seed N] [--threads N] [--max-ticks N] [--scaling] [--weights FILE]\n");
+            return 1;
+        }
+    }
+    if (tournament.botCount == 0 || tournament.seeds < 1) {
+        printf("Function:main, no bots or no seeds to play\n");
+        return 1;
+    }
+
+    memcpy(tournament.weights, HEURISTIC_DEFAULT_WEIGHTS, sizeof(tournament.weights));
+    loadHeuristicWeights(weightsFile, tournament.weights);
+
+    // Build the shared cycle before any worker reads it
+    const HamiltonCycle* cycle = boardCycle();
+    tournament.fullLength = cycle->length;
+    if (tournament.fullLength > SNAKE_MAX_LENGTH) {
+        tournament.fullLength = SNAKE_MAX_LENGTH;
+    }
+
+    int games = tournament.seeds * tournament.botCount;
+    tournament.results = (GameResult*)malloc(games * sizeof(GameResult));
+    GameResult* firstResults = (GameResult*)malloc(games * sizeof(GameResult));
+    if (tournament.results == NULL || firstResults == NULL) {
+        printf("Function:main, allocation failed\n");
+        return 1;
+    }
+
+    int failed = 0;
+    int workers = taskPoolWorkers(threads);
+    int runWorkers = scaling ? 1 : workers;
+    while (!failed) {
+        failed = runTournament(&tournament, runWorkers);
+        if (failed) {
+            break;
+        }
+        if (runWorkers == 1 || !scaling) {
+            memcpy(firstResults, tournament.results, games * sizeof(GameResult));
+        } else if (memcmp(firstResults, tournament.results, games * sizeof(GameResult)) != 0) {
+            printf("Function:main, results on %d threads differ from 1 thread\n", runWorkers);
+            failed = 1;
+        }
+        if (runWorkers >= workers) {
+            break;
+        }
+        runWorkers = runWorkers * 2 < workers ? runWorkers * 2 : workers;
+    }
+    if (!failed) {
+        reportTournament(&tournament);
+    }
+
+    for (int i = 0; i < TASKPOOL_MAX_WORKERS; ++i) {
+        free(tournament.games[i]);
+    }
+    free(tournament.results);
+    free(firstResults);
+    return failed;
+}
@@ -0,0 +1,114 @@
+#include "trace.h"
+#include <stdio.h>
+
+// Events of one thread, only that thread writes, traceDump reads up to written
+typedef struct {
+    TraceEvent* events;
+    SDL_atomic_t written;
+    const char* threadName;
+} TraceRing;
+
+int traceActive = 0;
+TraceRing traceRings[TRACE_MAX_THREADS];
+SDL_atomic_t traceThreads;
+Uint64 traceStart = 0;
+const char* traceFile = "trace.json";
+
+// Ring of the calling thread, -1 until its first event
+thread_local int traceSlot = -1;
+thread_local const char* traceThreadLabel = NULL;
+
+// Start recording, the rings are allocated here so recording never allocates
+void traceEnable(const char* filePath) {
+    if (traceActive) {
+        return;
+    }
+    if (filePath != NULL) {
+        traceFile = filePath;
+    }
+    for (int i = 0; i < TRACE_MAX_THREADS; ++i) {
+        traceRings[i].events = (TraceEvent*)SDL_malloc(sizeof(TraceEvent) * TRACE_RING_SIZE);
+        if (traceRings[i].events == NULL) {
+            printf("Function:traceEnable, trace buffer allocation failed\n");
+            return;
+        }
+        SDL_AtomicSet(&traceRings[i].written, 0);
+        traceRings[i].threadName = NULL;
+    }
+    SDL_AtomicSet(&traceThreads, 0);
+    traceStart = SDL_GetPerformanceCounter();
+    SDL_MemoryBarrierRelease();
+    traceActive = 1;
+    printf("Tracing to %s\n", traceFile);
+}
+
+// Name the calling thread in the trace, can be called before tracing starts
+void traceThreadName(const char* name) {
+    traceThreadLabel = name;
+    if (traceSlot >= 0) {
+        traceRings[traceSlot].threadName = name;
+    }
+}
+
+void traceRecord(const char* name, Uint64 start, Uint64 end) {
+    if (traceSlot < 0) {
+        int slot = SDL_AtomicAdd(&traceThreads, 1);
+        if (slot >= TRACE_MAX_THREADS) {
+            return;
+        }
+        traceSlot = slot;
+        traceRings[slot].threadName = traceThreadLabel;
+    }
+    TraceRing* ring = &traceRings[traceSlot];
+    int written = SDL_AtomicGet(&ring->written);
+    TraceEvent* event = &ring->events[written & (TRACE_RING_SIZE - 1)];
+    event->name = name;
+    event->start = start;
+    event->end = end;
+    SDL_MemoryBarrierRelease();
+    SDL_AtomicSet(&ring->written, written + 1);
+}
+
+// Write everything recorded so far, returns 0 on success. Safe while other threads keep recording,
+// their newest events may be missing and the oldest ones overwritten
+int traceDump(void) {
+    if (!traceActive) {
+        return 1;
+    }
+    FILE* file = fopen(traceFile, "w");
+    if (file == NULL) {
+        printf("Function:traceDump, Unable to open file %s for writing\n", traceFile);
+        return 1;
+    }
+
+    double usPerCount = 1000000.0 / (double)SDL_GetPerformanceFrequency();
+    int threads = SDL_AtomicGet(&traceThreads);
+    if (threads > TRACE_MAX_THREADS) {
+        threads = TRACE_MAX_THREADS;
+    }
+    int events = 0;
+    fprintf(file, "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[\n");
+    for (int t = 0; t < threads; ++t) {
+        TraceRing* ring = &traceRings[t];
+        const char* threadName = ring->threadName != NULL ? ring->threadName : "thread";
+        fprintf(file, "%s{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":%d,\"args\":{\"name\":\"%s\"}}", t == 0 ? "" : ",\n", t, threadName);
+
+        // Leave a margin for events the owner thread overwrites while we read
+        int written = SDL_AtomicGet(&ring->written);
+        SDL_MemoryBarrierAcquire();
+        int first = written - (TRACE_RING_SIZE - TRACE_RING_SIZE / 16);
+        if (first < 0) {
+            first = 0;
+        }
+        for (int i = first; i < written; ++i) {
+            TraceEvent* event = &ring->events[i & (TRACE_RING_SIZE - 1)];
+            fprintf(file, ",\n{\"name\":\"%s\",\"ph\":\"X\",\"pid\":1,\"tid\":%d,\"ts\":%.3f,\"dur\":%.3f}",
+                    event->name, t, (double)(event->start - traceStart) * usPerCount, (double)(event->end - event->start) * usPerCount);
+        }
+        events += written - first;
+    }
+    fprintf(file, "\n]}\n");
+    fclose(file);
+    printf("Trace: %d events written to %s\n", events, traceFile);
+    return 0;
+}
@@ -0,0 +1,66 @@
+// Scoped trace markers written as Chrome Trace Event JSON (open the file in Perfetto or chrome://tracing)
+// Each thread records into its own ring buffer without locks, while tracing is off a marker is one flag check
+//
+//     void updateSomething() {
+//         TRACE_SCOPE("updateSomething");
+//         ...
+//     }
+
+#ifndef TRACE_H
+#define TRACE_H
+
+#include <SDL2/SDL.h>
+
+// Threads that can record (main, render and a couple spare), and events kept per thread
+const int TRACE_MAX_THREADS = 4;
+const int TRACE_RING_SIZE = 1 << 16;
+
+typedef struct {
+    const char* name;  // Must be a string literal, only the pointer is stored
+    Uint64 start;
+    Uint64 end;
+} TraceEvent;
+
+// Set by traceEnable, read by every marker
+extern int traceActive;
+
+inline int traceEnabled(void) {
+    return traceActive;
+}
+
+// Trace functions
+void traceEnable(const char* filePath);
+void traceThreadName(const char* name);
+void traceRecord(const char* name, Uint64 start, Uint64 end);
+int traceDump(void);
+
+// For spans that aren't a scope of their own, traceBegin returns 0 while tracing is off
+inline Uint64 traceBegin(void) {
+    return traceActive ? SDL_GetPerformanceCounter() : 0;
+}
+
+inline void traceEnd(const char* name, Uint64 start) {
+    if (start != 0) {
+        traceRecord(name, start, SDL_GetPerformanceCounter());
+    }
+}
+
+// Records the time between construction and the end of the enclosing scope
+struct TraceScope {
+    const char* name;
+    Uint64 start;
+
+    TraceScope(const char* scopeName) {
+        name = scopeName;
+        start = traceBegin();
+    }
+    ~TraceScope() {
+        traceEnd(name, start);
+    }
+};
+
+#define TRACE_CONCAT2(a, b) a##b
+#define TRACE_CONCAT(a, b) TRACE_CONCAT2(a, b)
+#define TRACE_SCOPE(name) TraceScope TRACE_CONCAT(traceScope, __LINE__)(name)
+
+#endif
@@ -0,0 +1,414 @@
+// Genetic algorithm trainer for the heuristic bot's weights, headless, one game per task on a work-stealing pool
+// Usage: trainer [--seed N] [--population N] [--generations N] [--games N] [--threads N] [--max-ticks N]
+//                [--checkpoint FILE] [--resume]
+// Prints CSV on stdout, one line per generation:
+//   generation,evaluations,best_fitness,mean_fitness,best_deaths,evals_per_s,games_per_s,ticks_per_s,w_food,w_space,w_tail,w_wall
+//   fitness is the mean score of a candidate over its games, every candidate of a generation plays the same seeds
+//   a game ends like in the tournament: death, full board, 2 * GRID_CELLS ticks without food, or max-ticks
+//   the master seed decides everything (first population, game seeds, selection, mutation), and the evolution
+//   runs on one thread after all games are in, so a run gives the same weights on any number of threads
+//   the checkpoint (trainer.txt by default) is rewritten after every generation with the next population and
+//   the best weights so far, --resume carries on from it. The game loads its best weights with --bot heuristic
+//   the board size is fixed at build time like microbench (-DSNAKE_SCREEN_WIDTH=...)
+
+#include <SDL2/SDL.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "perf.h"
+#include "snake.h"
+#include "input.h"
+#include "heuristic.h"
+#include "hamilton.h"
+#include "taskpool.h"
+#include "savefile.h"
+
+const int TRAINER_MAX_POPULATION = 256;
+const int TRAINER_ELITES = 2;            // Best candidates copied into the next generation unchanged
+const int TRAINER_TOURNAMENT = 3;        // Candidates drawn per parent, the fittest of them wins
+const double TRAINER_MUTATION_RATE = 0.25;  // Chance for each weight of a child to be mutated
+const double TRAINER_MUTATION_SIZE = 0.3;   // Spread of a mutation
+const double TRAINER_WEIGHT_LIMIT = 4.0;    // Weights are kept in [-limit, limit]
+
+// Everything one worker needs to play a game, allocated once per worker
+typedef struct {
+    Snake snake;
+    Food food;
+    InputQueue input;
+    HeuristicBot bot;
+} TrainerGame;
+
+typedef struct {
+    int score;
+    int ticks;
+    int died;
+} TrainerResult;
+
+typedef struct {
+    Uint32 seed;
+    int population;
+    int games;
+    int maxTicks;
+    int fullLength;
+    int generation;  // Next generation to evaluate
+    Uint32 random;   // Selection and mutation, carried over in the checkpoint
+
+    double weights[TRAINER_MAX_POPULATION][HEURISTIC_FEATURES];
+    double fitness[TRAINER_MAX_POPULATION];
+    int deaths[TRAINER_MAX_POPULATION];
+    double bestFitness;  // Best of all generations so far, -1 before the first
+    double bestWeights[HEURISTIC_FEATURES];
+
+    TrainerGame* workerGames[TASKPOOL_MAX_WORKERS];
+    TrainerResult* results;  // population * games, task = candidate * games + game
+} Trainer;
+
+// Uniform in [0, 1)
+double trainerUniform(Trainer* trainer) {
+    return nextRandom(&trainer->random) / 4294967296.0;
+}
+
+// Roughly normal with standard deviation 1, sum of four uniforms
+double trainerNormal(Trainer* trainer) {
+    double sum = 0;
+    for (int i = 0; i < 4; ++i) {
+        sum += trainerUniform(trainer);
+    }
+    return (sum - 2.0) * 1.7320508;
+}
+
+// Food seed of one game, the same for every candidate of a generation
+Uint32 trainerGameSeed(Trainer* trainer, int game) {
+    return trainer->seed * 1000003u + (Uint32)trainer->generation * 65537u + (Uint32)game;
+}
+
+// One game with the same order of steps as the game loop in main.cpp
+void playTrainerGame(Trainer* trainer, TrainerGame* game, int candidate, Uint32 seed, TrainerResult* result) {
+    Snake* snake = &game->snake;
+    initSnake(snake);
+    resetInputQueue(&game->input, snake);
+    game->food.rect.w = 15;
+    game->food.rect.h = 15;
+    seedFood(&game->food, seed);
+    generateFood(&game->food);
+    initHeuristicBot(&game->bot, trainer->weights[candidate]);
+
+    int lastScore = 0;
+    int lastFood = 0;
+    result->died = 0;
+    while (snake->tick < trainer->maxTicks && snake->length < trainer->fullLength &&
+           snake->tick - lastFood <= 2 * GRID_CELLS) {
+        if (checkCollision(snake, &game->food)) {
+            growSnake(snake, 2);
+            snake->score += 1;
+            generateFood(&game->food);
+        }
+        heuristicTurn(&game->bot, snake, &game->food, &game->input);
+        Uint64 turnTime;
+        applyNextTurn(&game->input, snake, &turnTime);
+        updateSnake(snake, &game->food);
+        if (isGameOver(snake)) {
+            result->died = 1;
+            break;
+        }
+        if (snake->score != lastScore) {
+            lastScore = snake->score;
+            lastFood = snake->tick;
+        }
+    }
+    result->score = snake->score;
+    result->ticks = snake->tick;
+}
+
+void trainerTask(int task, int worker, void* data) {
+    Trainer* trainer = (Trainer*)data;
+    int candidate = task / trainer->games;
+    int game = task % trainer->games;
+    playTrainerGame(trainer, trainer->workerGames[worker], candidate, trainerGameSeed(trainer, game),
+                    &trainer->results[task]);
+}
+
+void randomPopulation(Trainer* trainer) {
+    for (int f = 0; f < HEURISTIC_FEATURES; ++f) {
+        trainer->weights[0][f] = HEURISTIC_DEFAULT_WEIGHTS[f];
+    }
+    for (int i = 1; i < trainer->population; ++i) {
+        for (int f = 0; f < HEURISTIC_FEATURES; ++f) {
+            trainer->weights[i][f] = trainerUniform(trainer) * 2.0 - 1.0;
+        }
+    }
+}
+
+// Fittest of a few random candidates, ties go to the lower index so the result doesn't depend on anything else
+int selectParent(Trainer* trainer) {
+    int best = nextRandom(&trainer->random) % trainer->population;
+    for (int i = 1; i < TRAINER_TOURNAMENT; ++i) {
+        int other = nextRandom(&trainer->random) % trainer->population;
+        if (trainer->fitness[other] > trainer->fitness[best] ||
+            (trainer->fitness[other] == trainer->fitness[best] && other < best)) {
+            best = other;
+        }
+    }
+    return best;
+}
+
+// Next population, built here and copied back
+double nextWeights[TRAINER_MAX_POPULATION][HEURISTIC_FEATURES];
+
+// Next population: the elites unchanged, then children of two parents with uniform crossover and mutation
+void evolve(Trainer* trainer) {
+    int order[TRAINER_MAX_POPULATION];
+    for (int i = 0; i < trainer->population; ++i) {
+        order[i] = i;
+    }
+    // Insertion sort by fitness, stable so ties keep their order
+    for (int i = 1; i < trainer->population; ++i) {
+        int candidate = order[i];
+        int j = i;
+        while (j > 0 && trainer->fitness[order[j - 1]] < trainer->fitness[candidate]) {
+            order[j] = order[j - 1];
+            --j;
+        }
+        order[j] = candidate;
+    }
+
+    int elites = TRAINER_ELITES < trainer->population ? TRAINER_ELITES : trainer->population;
+    for (int i = 0; i < elites; ++i) {
+        memcpy(nextWeights[i], trainer->weights[order[i]], sizeof(nextWeights[i]));
+    }
+    for (int i = elites; i < trainer->population; ++i) {
+        int a = selectParent(trainer);
+        int b = selectParent(trainer);
+        for (int f = 0; f < HEURISTIC_FEATURES; ++f) {
+            double weight = nextRandom(&trainer->random) & 1 ? trainer->weights[a][f] : trainer->weights[b][f];
+            if (trainerUniform(trainer) < TRAINER_MUTATION_RATE) {
+                weight += trainerNormal(trainer) * TRAINER_MUTATION_SIZE;
+            }
+            if (weight > TRAINER_WEIGHT_LIMIT) {
+                weight = TRAINER_WEIGHT_LIMIT;
+            } else if (weight < -TRAINER_WEIGHT_LIMIT) {
+                weight = -TRAINER_WEIGHT_LIMIT;
+            }
+            nextWeights[i][f] = weight;
+        }
+    }
+    memcpy(trainer->weights, nextWeights, trainer->population * sizeof(nextWeights[0]));
+}
+
+// Doubles are written as the hex of their bits, so a resumed run continues with exactly the same numbers
+int appendDouble(char* text, int size, int used, double value) {
+    unsigned long long bits;
+    memcpy(&bits, &value, sizeof(bits));
+    return used + snprintf(text + used, size - used, " %016llx", bits);
+}
+
+int appendWeights(char* text, int size, int used, const char* name, double* weights) {
+    used += snprintf(text + used, size - used, "%s", name);
+    for (int f = 0; f < HEURISTIC_FEATURES; ++f) {
+        used = appendDouble(text, size, used, weights[f]);
+    }
+    // Readable copy after the exact values, the reader ignores it
+    used += snprintf(text + used, size - used, "  #");
+    for (int f = 0; f < HEURISTIC_FEATURES; ++f) {
+        used += snprintf(text + used, size - used, " %.4f", weights[f]);
+    }
+    return used + snprintf(text + used, size - used, "\n");
+}
+
+int writeCheckpoint(Trainer* trainer, const char* path) {
+    int size = 512 + (trainer->population + 1) * 160;
+    char* text = (char*)malloc(size);
+    if (text == NULL) {
+        printf("Function:writeCheckpoint, allocation failed\n");
+        return 1;
+    }
+    int used = snprintf(text, size, "trainer 1\nseed %u\ngeneration %d\nrandom %u\npopulation %d\ngames %d\nmax_ticks %d\n",
+                        trainer->seed, trainer->generation, trainer->random, trainer->population, trainer->games,
+                        trainer->maxTicks);
+    used += snprintf(text + used, size - used, "best");
+    used = appendDouble(text, size, used, trainer->bestFitness);
+    used = appendWeights(text, size, used, "", trainer->bestWeights);
+    for (int i = 0; i < trainer->population; ++i) {
+        used = appendWeights(text, size, used, "weights", trainer->weights[i]);
+    }
+    int result = writeFileAtomic(path, text, used);
+    free(text);
+    return result;
+}
+
+int readCheckpoint(Trainer* trainer, const char* path) {
+    FILE* file = fopen(path, "r");
+    if (file == NULL) {
+        printf("Function:readCheckpoint, Unable to open %s\n", path);
+        return 1;
+    }
+    int version = 0;
+    int ok = fscanf(file, "trainer %d seed %u generation %d random %u population %d games %d max_ticks %d", &version,
+                    &trainer->seed, &trainer->generation, &trainer->random, &trainer->population, &trainer->games,
+                    &trainer->maxTicks) == 7 &&
+             version == 1 && trainer->population >= 1 && trainer->population <= TRAINER_MAX_POPULATION &&
+             trainer->games >= 1 && trainer->random != 0;
+    char line[512];
+    fgets(line, sizeof(line), file);
+    for (int i = -1; ok && i < trainer->population; ++i) {
+        // The best line first, one fitness value ahead of its weights
+        unsigned long long bits[HEURISTIC_FEATURES + 1];
+        const char* name = i < 0 ? "best " : "weights ";
+        int count = i < 0 ? HEURISTIC_FEATURES + 1 : HEURISTIC_FEATURES;
+        ok = fgets(line, sizeof(line), file) != NULL && strncmp(line, name, strlen(name)) == 0;
+        char* cursor = line + strlen(name);
+        for (int f = 0; ok && f < count; ++f) {
+            char* end;
+            bits[f] = strtoull(cursor, &end, 16);
+            ok = end != cursor;
+            cursor = end;
+        }
+        if (ok && i < 0) {
+            memcpy(&trainer->bestFitness, &bits[0], sizeof(double));
+            memcpy(trainer->bestWeights, &bits[1], sizeof(trainer->bestWeights));
+        } else if (ok) {
+            memcpy(trainer->weights[i], bits, sizeof(trainer->weights[i]));
+        }
+    }
+    fclose(file);
+    if (!ok) {
+        printf("Function:readCheckpoint, %s is not a trainer checkpoint\n", path);
+        return 1;
+    }
+    return 0;
+}
+
+// Play every candidate's games, then score them and breed the next generation. Returns 0 on success
+int runGeneration(Trainer* trainer, int workers) {
+    int games = trainer->population * trainer->games;
+    int stolen = 0;
+    Uint64 start = perfNow();
+    if (runTasks(games, workers, trainerTask, trainer, &stolen) != 0) {
+        return 1;
+    }
+    double seconds = perfMs(start, perfNow()) / 1000.0;
+
+    long long ticks = 0;
+    double fitnessSum = 0;
+    int best = 0;
+    for (int i = 0; i < trainer->population; ++i) {
+        int scoreSum = 0;
+        trainer->deaths[i] = 0;
+        for (int g = 0; g < trainer->games; ++g) {
+            TrainerResult* result = &trainer->results[i * trainer->games + g];
+            scoreSum += result->score;
+            trainer->deaths[i] += result->died;
+            ticks += result->ticks;
+        }
+        trainer->fitness[i] = (double)scoreSum / trainer->games;
+        fitnessSum += trainer->fitness[i];
+        if (trainer->fitness[i] > trainer->fitness[best]) {
+            best = i;
+        }
+    }
+    if (trainer->fitness[best] > trainer->bestFitness) {
+        trainer->bestFitness = trainer->fitness[best];
+        memcpy(trainer->bestWeights, trainer->weights[best], sizeof(trainer->bestWeights));
+    }
+
+    double* weights = trainer->weights[best];
+    printf("%d,%d,%.2f,%.2f,%d,%.1f,%.1f,%.0f,%.4f,%.4f,%.4f,%.4f\n", trainer->generation, trainer->population,
+           trainer->fitness[best], fitnessSum / trainer->population, trainer->deaths[best],
+           trainer->population / seconds, games / seconds, ticks / seconds, weights[FEATURE_FOOD],
+           weights[FEATURE_SPACE], weights[FEATURE_TAIL], weights[FEATURE_WALL]);
+    fflush(stdout);
+
+    evolve(trainer);
+    trainer->generation++;
+    return 0;
+}
+
+int main(int argc, char* args[]) {
+    Trainer trainer;
+    memset(&trainer, 0, sizeof(trainer));
+    trainer.seed = 1;
+    trainer.population = 32;
+    trainer.games = 16;
+    trainer.maxTicks = 5000;
+    trainer.bestFitness = -1;
+    int generations = 50;
+    int threads = 0;
+    int resume = 0;
+    const char* checkpoint = TRAINER_CHECKPOINT;
+    for (int i = 1; i < argc; ++i) {
+        if (strcmp(args[i], "--seed") == 0 && i + 1 < argc) {
+            trainer.seed = (Uint32)strtoul(args[++i], NULL, 10);
+        } else if (strcmp(args[i], "--population") == 0 && i + 1 < argc) {
+            trainer.population = atoi(args[++i]);
+        } else if (strcmp(args[i], "--generations") == 0 && i + 1 < argc) {
+            generations = atoi(args[++i]);
+        } else if (strcmp(args[i], "--games") == 0 && i + 1 < argc) {
+            trainer.games = atoi(args[++i]);
+        } else if (strcmp(args[i], "--threads") == 0 && i + 1 < argc) {
+            threads = atoi(args[++i]);
+        } else if (strcmp(args[i], "--max-ticks") == 0 && i + 1 < argc) {
+            trainer.maxTicks = atoi(args[++i]);
+        } else if (strcmp(args[i], "--checkpoint") == 0 && i + 1 < argc) {
+            checkpoint = args[++i];
+        } else if (strcmp(args[i], "--resume") == 0) {
+            resume = 1;
+        } else {
+            printf("Usage: trainer [--seed N] [--population N] [--generations N] [--games N] [--threads N] [--max-ticks N] [--checkpoint FILE] [--resume]\n");
+            return 1;
+        }
+    }
+    if (trainer.population < 1 || trainer.population > TRAINER_MAX_POPULATION || trainer.games < 1) {
+        printf("Function:main, population must be 1..%d and games at least 1\n", TRAINER_MAX_POPULATION);
+        return 1;
+    }
+
+    // The checkpoint's settings win over the command line, a resumed run must play the same games
+    if (resume) {
+        if (readCheckpoint(&trainer, checkpoint) != 0) {
+            return 1;
+        }
+    } else {
+        // Same mixing as the food seeds
+        Food mix;
+        seedFood(&mix, trainer.seed);
+        trainer.random = mix.random;
+        randomPopulation(&trainer);
+    }
+
+    const HamiltonCycle* cycle = boardCycle();
+    trainer.fullLength = cycle->length < SNAKE_MAX_LENGTH ? cycle->length : SNAKE_MAX_LENGTH;
+    trainer.results = (TrainerResult*)malloc(trainer.population * trainer.games * sizeof(TrainerResult));
+    if (trainer.results == NULL) {
+        printf("Function:main, allocation failed\n");
+        return 1;
+    }
+    int workers = taskPoolWorkers(threads);
+    int failed = 0;
+    for (int i = 0; i < workers && !failed; ++i) {
+        trainer.workerGames[i] = (TrainerGame*)malloc(sizeof(TrainerGame));
+        failed = trainer.workerGames[i] == NULL;
+    }
+    if (failed) {
+        printf("Function:main, allocation failed\n");
+    }
+
+    printf("generation,evaluations,best_fitness,mean_fitness,best_deaths,evals_per_s,games_per_s,ticks_per_s,w_food,w_space,w_tail,w_wall\n");
+    Uint64 start = perfNow();
+    int ran = 0;
+    for (; ran < generations && !failed; ++ran) {
+        failed = runGeneration(&trainer, workers) != 0 || writeCheckpoint(&trainer, checkpoint) != 0;
+    }
+    if (!failed && ran > 0) {
+        double seconds = perfMs(start, perfNow()) / 1000.0;
+        printf("Trainer: %d generations on %d threads in %.1f s, %.1f evaluations/s, best fitness %.2f with %.4f %.4f %.4f %.4f\n",
+               ran, workers, seconds, ran * trainer.population / seconds, trainer.bestFitness,
+               trainer.bestWeights[FEATURE_FOOD], trainer.bestWeights[FEATURE_SPACE], trainer.bestWeights[FEATURE_TAIL],
+               trainer.bestWeights[FEATURE_WALL]);
+    }
+
+    for (int i = 0; i < TASKPOOL_MAX_WORKERS; ++i) {
+        free(trainer.workerGames[i]);
+    }
+    free(trainer.results);
+    return failed;
+}
@@ -0,0 +1,192 @@
+#include "zobrist.h"
+#include <stdio.h>
+
+// Keys for every feature, built on the first call. Big on large boards, so kept out of the structs that use it
+ZobristKeys zobristKeyTable;
+int zobristKeysBuilt = 0;
+
+// splitmix64, a fixed seed keeps the keys the same in every run
+Uint64 nextZobristKey(Uint64* state) {
+    Uint64 z = (*state += 0x9e3779b97f4a7c15ULL);
+    z = (z ^ (z >> 30)) * 0xbf58476d1ce4e5b9ULL;
+    z = (z ^ (z >> 27)) * 0x94d049bb133111ebULL;
+    return z ^ (z >> 31);
+}
+
+void fillZobristKeys(Uint64* keys, int count, Uint64* state) {
+    for (int i = 0; i < count; ++i) {
+        keys[i] = nextZobristKey(state);
+    }
+}
+
+const ZobristKeys* zobristKeys(void) {
+    if (!zobristKeysBuilt) {
+        Uint64 state = 0x536e616b65ULL;
+        fillZobristKeys(zobristKeyTable.body, GRID_CELLS + 1, &state);
+        fillZobristKeys(zobristKeyTable.head, GRID_CELLS + 1, &state);
+        fillZobristKeys(zobristKeyTable.tail, GRID_CELLS + 1, &state);
+        fillZobristKeys(zobristKeyTable.food, GRID_CELLS + 1, &state);
+        fillZobristKeys(zobristKeyTable.length, SNAKE_MAX_LENGTH + 1, &state);
+        fillZobristKeys(zobristKeyTable.direction, 5, &state);
+        zobristKeysBuilt = 1;
+    }
+    return &zobristKeyTable;
+}
+
+// Grid cell of a screen position, negative positions turn into huge unsigned ones and land off the grid
+int zobristCell(int x, int y) {
+    unsigned int col = (unsigned int)x / CELL_SIZE;
+    unsigned int row = (unsigned int)y / CELL_SIZE;
+    if (x < 0 || y < 0 || col >= (unsigned int)GRID_COLS || row >= (unsigned int)GRID_ROWS) {
+        return ZOBRIST_OFF_GRID;
+    }
+    return row * GRID_COLS + col;
+}
+
+// Hash from scratch, O(length). Segments on the same cell as the one before them (a tail that holds still
+// after growing) count once, which is what the tracker's entered/left cells add up to
+Uint64 zobristHash(Snake* snake, Food* food) {
+    const ZobristKeys* keys = zobristKeys();
+    int head = zobristCell(snake->segments[0].x, snake->segments[0].y);
+    int tail = zobristCell(snake->segments[snake->length - 1].x, snake->segments[snake->length - 1].y);
+    Uint64 hash = keys->head[head] ^ keys->tail[tail] ^ keys->food[zobristCell(food->x, food->y)] ^
+                  keys->length[snake->length] ^ keys->direction[snake->directions[0]];
+    int previous = -1;
+    for (int i = 0; i < snake->length; ++i) {
+        int cell = zobristCell(snake->segments[i].x, snake->segments[i].y);
+        if (cell != previous) {
+            hash ^= keys->body[cell];
+        }
+        previous = cell;
+    }
+    return hash;
+}
+
+void zobristStart(ZobristTracker* tracker, Snake* snake, Food* food) {
+    tracker->hash = zobristHash(snake, food);
+    tracker->headCell = zobristCell(snake->segments[0].x, snake->segments[0].y);
+    tracker->tailCell = zobristCell(snake->segments[snake->length - 1].x, snake->segments[snake->length - 1].y);
+    tracker->foodCell = zobristCell(food->x, food->y);
+    tracker->direction = snake->directions[0];
+    tracker->length = snake->length;
+}
+
+// O(1): the head enters at most one cell and the tail leaves at most one per tick, so it must see every tick.
+// Calling it again without a move changes nothing
+Uint64 zobristUpdate(ZobristTracker* tracker, Snake* snake, Food* food) {
+    const ZobristKeys* keys = zobristKeys();
+    Uint64 hash = tracker->hash;
+
+    int head = zobristCell(snake->segments[0].x, snake->segments[0].y);
+    if (head != tracker->headCell) {
+        hash ^= keys->head[tracker->headCell] ^ keys->head[head] ^ keys->body[head];
+        tracker->headCell = head;
+    }
+    int tail = zobristCell(snake->segments[snake->length - 1].x, snake->segments[snake->length - 1].y);
+    if (tail != tracker->tailCell) {
+        hash ^= keys->tail[tracker->tailCell] ^ keys->tail[tail] ^ keys->body[tracker->tailCell];
+        tracker->tailCell = tail;
+    }
+    int foodCell = zobristCell(food->x, food->y);
+    if (foodCell != tracker->foodCell) {
+        hash ^= keys->food[tracker->foodCell] ^ keys->food[foodCell];
+        tracker->foodCell = foodCell;
+    }
+    if (snake->directions[0] != tracker->direction) {
+        hash ^= keys->direction[tracker->direction] ^ keys->direction[snake->directions[0]];
+        tracker->direction = snake->directions[0];
+    }
+    if (snake->length != tracker->length) {
+        hash ^= keys->length[tracker->length] ^ keys->length[snake->length];
+        tracker->length = snake->length;
+    }
+
+    tracker->hash = hash;
+    return hash;
+}
+
+// Entry data: value in the low 32 bits, then depth (16), move (8) and the age of the search that stored it (8)
+Uint64 packTransResult(TransResult* result, int age) {
+    return (Uint64)(Uint32)result->value | (Uint64)(result->depth & 0xffff) << 32 |
+           (Uint64)(result->move & 0xff) << 48 | (Uint64)(age & 0xff) << 56;
+}
+
+int transDepth(Uint64 data) {
+    return (int)(data >> 32) & 0xffff;
+}
+
+int transAge(Uint64 data) {
+    return (int)(data >> 56);
+}
+
+int initTransTable(TransTable* table, int sizeLog2) {
+    // At least one bucket
+    if (sizeLog2 < 2) {
+        sizeLog2 = 2;
+    }
+    Uint64 entries = (Uint64)1 << sizeLog2;
+    table->entries = (TransEntry*)SDL_calloc((size_t)entries, sizeof(TransEntry));
+    if (table->entries == NULL) {
+        printf("Function:initTransTable, %llu entries failed,Error: %s\n", (unsigned long long)entries, SDL_GetError());
+        return 1;
+    }
+    table->bucketMask = entries / TRANS_BUCKET_SIZE - 1;
+    table->age = 1;
+    return 0;
+}
+
+void freeTransTable(TransTable* table) {
+    SDL_free(table->entries);
+    table->entries = NULL;
+}
+
+// Call from one thread between searches, age 0 is left to empty entries
+void transNewSearch(TransTable* table) {
+    table->age = table->age % 255 + 1;
+}
+
+// No locks: data is read before check and written before it, and a pair that doesn't give back the key
+// (another thread's half finished store, a torn 64-bit access on 32-bit builds, another position) is a miss
+int transProbe(TransTable* table, Uint64 key, TransResult* result) {
+    TransEntry* bucket = table->entries + (key & table->bucketMask) * TRANS_BUCKET_SIZE;
+    for (int i = 0; i < TRANS_BUCKET_SIZE; ++i) {
+        Uint64 data = bucket[i].data;
+        Uint64 check = bucket[i].check;
+        if ((check ^ data) == key && data != 0) {
+            result->value = (Sint32)(Uint32)data;
+            result->depth = transDepth(data);
+            result->move = (int)(data >> 48) & 0xff;
+            return 1;
+        }
+    }
+    return 0;
+}
+
+// Same position: replaced unless this search already stored it deeper. Otherwise the weakest entry goes:
+// empty or from an older search first, then the shallowest. Two threads storing into one bucket at once
+// may lose one of the results, never mix them
+void transStore(TransTable* table, Uint64 key, TransResult* result) {
+    TransEntry* bucket = table->entries + (key & table->bucketMask) * TRANS_BUCKET_SIZE;
+    int victim = 0;
+    int victimDepth = 0x10000;
+    for (int i = 0; i < TRANS_BUCKET_SIZE; ++i) {
+        Uint64 data = bucket[i].data;
+        Uint64 check = bucket[i].check;
+        int current = transAge(data) == table->age;
+        if ((check ^ data) == key && data != 0) {
+            if (current && transDepth(data) > result->depth) {
+                return;
+            }
+            victim = i;
+            break;
+        }
+        int depth = current ? transDepth(data) : -1;
+        if (depth < victimDepth) {
+            victim = i;
+            victimDepth = depth;
+        }
+    }
+    Uint64 data = packTransResult(result, table->age);
+    bucket[victim].data = data;
+    bucket[victim].check = key ^ data;
+}
@@ -0,0 +1,72 @@
+// Zobrist hashing of game positions and a transposition table keyed on it.
+// A position hash is the XOR of one random 64-bit key per feature: every body cell, the head cell, the tail
+// cell, the food cell, the direction and the length. A tick changes at most the cell the head entered, the
+// cell the tail left, the food, the direction and the length, so a tracker updates the hash with a few XORs
+// instead of walking the body.
+// The keys come from a fixed seed, so hashes match between runs and files (replays, datasets).
+// The table is a fixed array of buckets shared by any number of threads without locks: an entry stores
+// key ^ data next to data, and a read only counts if they still agree, so a half written entry reads as a miss
+
+#ifndef ZOBRIST_H
+#define ZOBRIST_H
+
+#include <SDL2/SDL.h>
+#include "snake.h"
+
+// Cells are grid cells, ZOBRIST_OFF_GRID stands for a head that left the screen
+const int ZOBRIST_OFF_GRID = GRID_CELLS;
+
+typedef struct {
+    Uint64 body[GRID_CELLS + 1];
+    Uint64 head[GRID_CELLS + 1];
+    Uint64 tail[GRID_CELLS + 1];
+    Uint64 food[GRID_CELLS + 1];
+    Uint64 length[SNAKE_MAX_LENGTH + 1];
+    Uint64 direction[5];  // Indexed by the snake's direction code, 0 before the first move
+} ZobristKeys;
+
+// Hash of a running game, call zobristUpdate after every updateSnake or food change
+typedef struct {
+    Uint64 hash;
+    int headCell;
+    int tailCell;
+    int foodCell;
+    int direction;
+    int length;
+} ZobristTracker;
+
+// Entries per bucket, a store replaces the weakest entry of its bucket
+const int TRANS_BUCKET_SIZE = 4;
+
+typedef struct {
+    volatile Uint64 check;  // key ^ data
+    volatile Uint64 data;
+} TransEntry;
+
+typedef struct {
+    TransEntry* entries;
+    Uint64 bucketMask;  // Buckets - 1, a power of two
+    int age;            // Bumped by transNewSearch, entries from older searches are replaced first
+} TransTable;
+
+// What a search keeps per position
+typedef struct {
+    Sint32 value;
+    int depth;  // 0..65535, deeper results replace shallower ones
+    int move;   // 0..255
+} TransResult;
+
+// Zobrist functions
+const ZobristKeys* zobristKeys(void);
+Uint64 zobristHash(Snake* snake, Food* food);
+void zobristStart(ZobristTracker* tracker, Snake* snake, Food* food);
+Uint64 zobristUpdate(ZobristTracker* tracker, Snake* snake, Food* food);
+
+// Transposition table functions
+int initTransTable(TransTable* table, int sizeLog2);
+void freeTransTable(TransTable* table);
+void transNewSearch(TransTable* table);
+int transProbe(TransTable* table, Uint64 key, TransResult* result);
+void transStore(TransTable* table, Uint64 key, TransResult* result);
+
+#endif